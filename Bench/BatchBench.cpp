@@ -0,0 +1,121 @@
+#include "../Q8_Q9/BatchHull.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unistd.h>
+
+/**
+ * @brief Packed groups with sizes drawn from [minPoints, maxPoints] and coordinates from [0, span).
+ */
+template <class T>
+static void makeGroups(size_t groupCount, size_t minPoints, size_t maxPoints, int span, uint64_t seed,
+                       std::vector<BasicPoint<T>>& points, std::vector<size_t>& offsets) {
+    std::mt19937_64 rng(seed);
+    points.clear();
+    offsets.assign(1, 0);
+    for (size_t g = 0; g < groupCount; ++g) {
+        size_t count = minPoints + rng() % (maxPoints - minPoints + 1);
+        for (size_t i = 0; i < count; ++i) points.emplace_back((T)(int)(rng() % span), (T)(int)(rng() % span));
+        offsets.push_back(points.size());
+    }
+}
+
+/**
+ * @brief Every group's hull and area must equal what BasicConvexHull computes for it alone.
+ */
+template <class T>
+static bool checkAgainstSingleHulls() {
+    std::vector<BasicPoint<T>> points;
+    std::vector<size_t> offsets;
+    for (int span : {3, 10, 1000000}) {
+        makeGroups<T>(20000, 0, 80, span, span, points, offsets);
+        size_t groupCount = offsets.size() - 1;
+        std::vector<BasicPoint<T>> hulls(points.size());
+        std::vector<size_t> hullSizes(groupCount);
+        std::vector<typename BatchHull<T>::Area> areas(groupCount);
+        BatchHull<T>::compute(points.data(), offsets.data(), groupCount, hulls.data(), hullSizes.data(), areas.data());
+
+        for (size_t g = 0; g < groupCount; ++g) {
+            PointVector<T> group(points.begin() + offsets[g], points.begin() + offsets[g + 1]);
+            std::vector<BasicPoint<T>> expected = BasicConvexHull<T>::findConvexHull(group);
+            std::vector<BasicPoint<T>> actual(hulls.begin() + offsets[g], hulls.begin() + offsets[g] + hullSizes[g]);
+            if (expected.size() < 3) std::sort(expected.begin(), expected.end()); // Returned as given, unsorted
+            if (actual != expected || areas[g] != BasicConvexHull<T>::computeEnclosedArea(expected)) {
+                fprintf(stderr, "%s group %zu of %zu points: hull differs from BasicConvexHull\n",
+                        CoordinateTraits<T>::name, g, offsets[g + 1] - offsets[g]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <class Function>
+static double seconds(Function run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Groups per second through BatchHull versus one BasicConvexHull call (and vector) per group.
+ */
+template <class T>
+static void measure(size_t groupCount, size_t minPoints, size_t maxPoints) {
+    std::vector<BasicPoint<T>> points;
+    std::vector<size_t> offsets;
+    makeGroups<T>(groupCount, minPoints, maxPoints, 1 << 20, 17, points, offsets);
+
+    double sink = 0;
+    double single = seconds([&] {
+        for (size_t g = 0; g < groupCount; ++g) {
+            PointVector<T> group(points.begin() + offsets[g], points.begin() + offsets[g + 1]);
+            sink += BasicConvexHull<T>::computeHullArea(group);
+        }
+    });
+
+    std::vector<BasicPoint<T>> hulls(points.size());
+    std::vector<size_t> hullSizes(groupCount);
+    std::vector<typename BatchHull<T>::Area> areas(groupCount);
+    double oneThread = seconds([&] {
+        BatchHull<T>::compute(points.data(), offsets.data(), groupCount, hulls.data(), hullSizes.data(),
+                              areas.data(), 1);
+    });
+    double allThreads = seconds([&] {
+        BatchHull<T>::compute(points.data(), offsets.data(), groupCount, hulls.data(), hullSizes.data(),
+                              areas.data());
+    });
+    sink += areas[0];
+
+    printf("%-7s %9zu %4zu-%-4zu %14.0f %14.0f %14.0f %8.1fx\n", CoordinateTraits<T>::name, groupCount, minPoints,
+           maxPoints, groupCount / single, groupCount / oneThread, groupCount / allThreads, single / oneThread);
+    fflush(stdout);
+    if (sink == 1) printf("\n"); // Keeps the baseline from being optimized away
+}
+
+int main(int argc, char* argv[]) {
+    size_t groupCount = 200000;
+    int option;
+    while ((option = getopt(argc, argv, "g:")) != -1) {
+        if (option == 'g') {
+            groupCount = (size_t)strtod(optarg, nullptr);
+        } else {
+            fprintf(stderr, "Usage: %s [-g groups]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (!checkAgainstSingleHulls<int32_t>() || !checkAgainstSingleHulls<float>() ||
+        !checkAgainstSingleHulls<double>())
+        return 1;
+    printf("batch hulls match single hulls\n");
+
+    printf("%-7s %9s %9s %14s %14s %14s %9s\n", "type", "groups", "points", "single_grp/s", "batch1_grp/s",
+           "batch_grp/s", "speedup");
+    const size_t sizes[][2] = {{5, 8}, {9, 16}, {17, 32}, {5, 64}, {33, 64}};
+    for (const size_t* range : sizes) measure<int32_t>(groupCount, range[0], range[1]);
+    for (const size_t* range : sizes) measure<float>(groupCount, range[0], range[1]);
+    measure<double>(groupCount, 5, 64);
+    return 0;
+}
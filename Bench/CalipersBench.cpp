@@ -0,0 +1,159 @@
+#include "../Q8_Q9/Calipers.hpp"
+#include "../Q8_Q9/RandomPoints.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+template <class T>
+using Hull = std::vector<BasicPoint<T>>;
+
+// O(h^2) references: every edge against every vertex, every pair of vertices
+template <class T>
+static double diameterQuadratic(const Hull<T>& hull) {
+    double best = 0;
+    for (const BasicPoint<T>& a : hull)
+        for (const BasicPoint<T>& b : hull) best = std::max(best, a.computeDistance(b));
+    return best;
+}
+
+template <class T>
+static void edgeBoxQuadratic(const Hull<T>& hull, double& width, double& rectangle) {
+    width = rectangle = INFINITY;
+    for (size_t i = 0; i < hull.size(); ++i) {
+        const BasicPoint<T>& base = hull[i];
+        const BasicPoint<T>& next = hull[(i + 1) % hull.size()];
+        double edgeX = (double)next.getX() - base.getX(), edgeY = (double)next.getY() - base.getY();
+        double length = sqrt(edgeX * edgeX + edgeY * edgeY);
+        double up = 0, ahead = 0, behind = 0;
+        for (const BasicPoint<T>& vertex : hull) {
+            double along = (((double)vertex.getX() - base.getX()) * edgeX + ((double)vertex.getY() - base.getY()) * edgeY) / length;
+            up = std::max(up, (double)-base.cross(next, vertex) / length);
+            ahead = std::max(ahead, along);
+            behind = std::min(behind, along);
+        }
+        width = std::min(width, up);
+        rectangle = std::min(rectangle, up * (ahead - behind));
+    }
+}
+
+static bool close(double a, double b) { return fabs(a - b) <= 1e-9 * std::max(1.0, fabs(b)); }
+
+/**
+ * @brief Checks the calipers and the one-pass shape against the O(h^2) references.
+ */
+template <class T>
+static bool checkHull(const Hull<T>& hull) {
+    BasicPoint<T> from, to;
+    size_t edge;
+    double corners[4][2];
+    double diameter = RotatingCalipers<T>::diameter(hull, from, to);
+    double width = RotatingCalipers<T>::width(hull, edge);
+    double rectangle = RotatingCalipers<T>::minimumRectangle(hull, corners);
+    double expectedWidth, expectedRectangle;
+    edgeBoxQuadratic(hull, expectedWidth, expectedRectangle);
+
+    // The reported corners must span the reported area and enclose every vertex
+    double sideA = hypot(corners[1][0] - corners[0][0], corners[1][1] - corners[0][1]);
+    double sideB = hypot(corners[3][0] - corners[0][0], corners[3][1] - corners[0][1]);
+    bool enclosed = true;
+    for (const BasicPoint<T>& vertex : hull) {
+        for (int side = 0; side < 4; ++side) {
+            const double* a = corners[side];
+            const double* b = corners[(side + 1) % 4];
+            double outside = (b[1] - a[1]) * (vertex.getX() - a[0]) - (b[0] - a[0]) * (vertex.getY() - a[1]);
+            if (outside > 1e-6 * std::max(1.0, sideA * sideB)) enclosed = false;
+        }
+    }
+
+    typename BasicConvexHull<T>::Shape shape = BasicConvexHull<T>::computeShape(hull);
+    double perimeter = 0, momentX = 0, momentY = 0, fanArea = 0;
+    for (size_t i = 0; i < hull.size(); ++i) {
+        perimeter += hull[i].computeDistance(hull[(i + 1) % hull.size()]);
+        if (i == 0 || i + 1 == hull.size()) continue;
+        double triangle = -(double)hull[0].cross(hull[i], hull[i + 1]) / 2;
+        fanArea += triangle;
+        momentX += triangle * ((double)hull[0].getX() + hull[i].getX() + hull[i + 1].getX()) / 3;
+        momentY += triangle * ((double)hull[0].getY() + hull[i].getY() + hull[i + 1].getY()) / 3;
+    }
+
+    if (!close(diameter, diameterQuadratic(hull)) || !close(from.computeDistance(to), diameter) ||
+        !close(width, expectedWidth) || !close(rectangle, expectedRectangle) || !close(sideA * sideB, rectangle) ||
+        !enclosed || shape.area != BasicConvexHull<T>::computeEnclosedArea(hull) || !close(shape.perimeter, perimeter) ||
+        !close(shape.centroidX, momentX / fanArea) || !close(shape.centroidY, momentY / fanArea)) {
+        fprintf(stderr, "%s hull of %zu vertices: calipers or shape disagree with brute force\n",
+                CoordinateTraits<T>::name, hull.size());
+        return false;
+    }
+    return true;
+}
+
+static bool checkAgainstBruteForce() {
+    std::mt19937_64 rng(13);
+    for (int round = 0; round < 5000; ++round) {
+        int span = 3 + round % 40;
+        PointVector<int32_t> points;
+        for (int i = 0, n = 3 + rng() % 30; i < n; ++i) points.emplace_back(rng() % span, rng() % span);
+        Hull<int32_t> hull = IntConvexHull::findConvexHull(points);
+        if (hull.size() >= 3 && !checkHull(hull)) return false;
+    }
+
+    for (uint64_t seed = 1; seed <= 50; ++seed) {
+        PointVector<float> points;
+        RandomPointGenerator::generate(points, 1000, seed % 2 ? DISTRIBUTION_NORMAL : DISTRIBUTION_DISK, seed);
+        if (!checkHull(ConvexHullUtility::findConvexHull(points))) return false;
+    }
+    return true;
+}
+
+template <class Function>
+static double nsPerCall(int calls, Function call) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; ++i) call();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+}
+
+/**
+ * @brief Times each measure on the hull of points on an ellipse, where every point is a vertex.
+ */
+static void measure(size_t vertices) {
+    PointVector<int32_t> points;
+    for (size_t i = 0; i < vertices; ++i) {
+        double angle = 2 * M_PI * i / vertices;
+        points.emplace_back((int32_t)lround(3e8 * cos(angle)), (int32_t)lround(1e8 * sin(angle)));
+    }
+    Hull<int32_t> hull = IntConvexHull::findConvexHull(points);
+
+    int calls = (int)std::max<size_t>(1, 2000000 / hull.size());
+    double sink = 0;
+    IntPoint from, to;
+    size_t edge;
+    double corners[4][2];
+    double area = nsPerCall(calls, [&] { sink += IntConvexHull::computeEnclosedArea(hull); });
+    double shape = nsPerCall(calls, [&] { sink += IntConvexHull::computeShape(hull).perimeter; });
+    double diameter = nsPerCall(calls, [&] { sink += RotatingCalipers<int32_t>::diameter(hull, from, to); });
+    double width = nsPerCall(calls, [&] { sink += RotatingCalipers<int32_t>::width(hull, edge); });
+    double rectangle = nsPerCall(calls, [&] { sink += RotatingCalipers<int32_t>::minimumRectangle(hull, corners); });
+    double quadratic = hull.size() <= 4096 ? nsPerCall(1, [&] { sink += diameterQuadratic(hull); }) : NAN;
+
+    printf("%9zu %12.0f %12.0f %12.0f %12.0f %14.0f %16.0f\n", hull.size(), area, shape, diameter, width, rectangle,
+           quadratic);
+    fflush(stdout);
+    if (sink == 1) printf("\n"); // Keeps the calls from being optimized away
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        fprintf(stderr, "Usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    if (!checkAgainstBruteForce()) return 1;
+    printf("calipers and shape match brute force\n");
+
+    printf("%9s %12s %12s %12s %12s %14s %16s\n", "hull", "area_ns", "shape_ns", "diameter_ns", "width_ns",
+           "rectangle_ns", "diameter_h2_ns");
+    for (size_t vertices : {16, 256, 4096, 65536, 1048576}) measure(vertices);
+    return 0;
+}
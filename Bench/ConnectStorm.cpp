@@ -0,0 +1,176 @@
+#include "../Q8_Q9/Stats.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+#define MAX_EPOLL_EVENTS 256
+#define SLOW_CONNECT_NS 1000000000ULL // A connect this slow has waited for a dropped SYN to be resent
+
+/**
+ * @brief Connect-storm settings, filled from the command line.
+ */
+struct Options {
+    const char* host = "127.0.0.1";
+    const char* port = "9034";
+    size_t connections = 5000;
+    double rate = 0;             // New connections per second; 0 opens them all at once
+    double timeoutSeconds = 15;
+    bool greeting = true;        // The server greets with ">> "; otherwise a probe command is sent
+};
+
+enum StormState { CONNECTING, AWAITING_FIRST_BYTE, DONE, FAILED };
+
+struct StormConnection {
+    int fd = -1;
+    StormState state = CONNECTING;
+    uint64_t started = 0;
+};
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [-H host] [-p port] [-n connections] [-r connects_per_second] [-T timeout_seconds] [-q]\n"
+            "  Opens the connections as fast as possible (or at -r per second) and reports the time\n"
+            "  until each handshake completes and until the server first answers on it. Servers\n"
+            "  greet with \">> \"; -q is for the select server (Q4), which is sent \"CH\" instead.\n",
+            program);
+    exit(1);
+}
+
+static void printLatency(const char* name, const LatencyHistogram& histogram) {
+    if (histogram.count() == 0) return;
+    printf("%-10s count=%-7lu p50=%10.1fus p90=%10.1fus p99=%10.1fus p999=%10.1fus max=%10.1fus\n", name,
+           (unsigned long)histogram.count(), histogram.quantile(0.5) / 1e3, histogram.quantile(0.9) / 1e3,
+           histogram.quantile(0.99) / 1e3, histogram.quantile(0.999) / 1e3, histogram.max() / 1e3);
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    int option;
+    while ((option = getopt(argc, argv, "H:p:n:r:T:q")) != -1) {
+        switch (option) {
+        case 'H': options.host = optarg; break;
+        case 'p': options.port = optarg; break;
+        case 'n': options.connections = strtoul(optarg, nullptr, 10); break;
+        case 'r': options.rate = atof(optarg); break;
+        case 'T': options.timeoutSeconds = atof(optarg); break;
+        case 'q': options.greeting = false; break;
+        default: usage(argv[0]);
+        }
+    }
+    if (options.connections == 0) usage(argv[0]);
+
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < options.connections + 64) {
+        limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, options.connections + 64);
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    struct addrinfo hints, *address;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(options.host, options.port, &hints, &address) != 0) {
+        fprintf(stderr, "Cannot resolve %s:%s\n", options.host, options.port);
+        return 1;
+    }
+
+    int epollFd = epoll_create1(0);
+    std::vector<StormConnection> connections(options.connections);
+    LatencyHistogram connectLatency, firstByteLatency;
+    size_t opened = 0, finished = 0, failed = 0, slowConnects = 0;
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    char buffer[4096];
+
+    uint64_t start = ServerStats::now();
+    uint64_t deadline = start + (uint64_t)(options.timeoutSeconds * 1e9);
+    while (finished < options.connections && ServerStats::now() < deadline) {
+        // Open every connection that is due
+        uint64_t now = ServerStats::now();
+        size_t due = options.rate > 0 ? std::min(options.connections, (size_t)((now - start) / 1e9 * options.rate) + 1)
+                                      : options.connections;
+        for (; opened < due; ++opened) {
+            StormConnection& connection = connections[opened];
+            connection.started = ServerStats::now();
+            connection.fd = socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK, address->ai_protocol);
+            if (connection.fd < 0 ||
+                (connect(connection.fd, address->ai_addr, address->ai_addrlen) < 0 && errno != EINPROGRESS)) {
+                if (connection.fd >= 0) close(connection.fd);
+                connection.fd = -1;
+                connection.state = FAILED;
+                failed++;
+                finished++;
+                continue;
+            }
+            struct epoll_event event = {};
+            event.events = EPOLLOUT;
+            event.data.u64 = opened;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, connection.fd, &event);
+        }
+
+        int ready = epoll_wait(epollFd, events, MAX_EPOLL_EVENTS, 10);
+        for (int e = 0; e < ready; ++e) {
+            StormConnection& connection = connections[events[e].data.u64];
+            uint64_t done = ServerStats::now();
+            int error = 0;
+            socklen_t length = sizeof error;
+
+            if (connection.state == CONNECTING) {
+                getsockopt(connection.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+                if (error == 0 && !options.greeting && send(connection.fd, "CH\n", 3, MSG_NOSIGNAL) != 3) error = EPIPE;
+                if (error != 0) {
+                    connection.state = FAILED;
+                    failed++;
+                    finished++;
+                    epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+                    continue;
+                }
+                connectLatency.record(done - connection.started);
+                if (done - connection.started >= SLOW_CONNECT_NS) slowConnects++;
+
+                struct epoll_event event = {};
+                event.events = EPOLLIN;
+                event.data.u64 = events[e].data.u64;
+                epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+                connection.state = AWAITING_FIRST_BYTE;
+                continue;
+            }
+
+            ssize_t received = recv(connection.fd, buffer, sizeof buffer, 0);
+            if (received < 0 && errno == EAGAIN) continue;
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+            finished++;
+            if (received <= 0) {
+                connection.state = FAILED;
+                failed++;
+            } else {
+                connection.state = DONE;
+                firstByteLatency.record(done - connection.started);
+            }
+        }
+    }
+    double elapsed = (ServerStats::now() - start) / 1e9;
+
+    // Everything stays open until the end, so the server really holds every connection at once
+    size_t timedOut = options.connections - finished;
+    for (StormConnection& connection : connections)
+        if (connection.fd >= 0) close(connection.fd);
+    close(epollFd);
+    freeaddrinfo(address);
+
+    printf("Storm of %zu connections%s: %zu answered, %zu failed, %zu timed out in %.2f s\n", options.connections,
+           options.rate > 0 ? " (rate limited)" : "", (size_t)firstByteLatency.count(), failed, timedOut, elapsed);
+    printf("Handshakes slower than 1 s (dropped SYNs): %zu\n", slowConnects);
+    printLatency("connect", connectLatency);
+    printLatency("answered", firstByteLatency);
+    return failed + timedOut == 0 ? 0 : 2;
+}
@@ -0,0 +1,138 @@
+// Each question's source defines its own Point and main, so every one is
+// compiled inside its own namespace. The standard headers they use are
+// included first so their include guards keep them out of those namespaces.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "GrahamVariants.hpp"
+
+namespace q1 {
+#define main q1_main
+#include "../Q1/Q1.cpp"
+#undef main
+}
+
+namespace q2deque {
+#define main q2deque_main
+#include "../Q2/Q1_deque.cpp"
+#undef main
+}
+
+namespace q2list {
+#define main q2list_main
+#include "../Q2/Q1_link.cpp"
+#undef main
+}
+
+namespace q3 {
+#define main q3_main
+#include "../Q3/Q3.cpp"
+#undef main
+}
+
+namespace q4 {
+#include "../Q4/Graph.cpp"
+}
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsedNs(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// Hulls hold pointers to points (Q3) or the points themselves (Q4)
+template <class Point>
+static const Point* pointerTo(Point* point) {
+    return point;
+}
+
+template <class Point>
+static const Point* pointerTo(const Point& point) {
+    return &point;
+}
+
+// Shoelace over integer hulls, for the variants that have no area function
+template <class Hull>
+static double integerArea(const Hull& hull) {
+    double area = 0;
+    for (size_t i = 0; i < hull.size(); ++i) {
+        const auto* current = pointerTo(hull[i]);
+        const auto* next = pointerTo(hull[(i + 1) % hull.size()]);
+        area += (double)current->getX() * next->getY() - (double)next->getX() * current->getY();
+    }
+    return std::abs(area) / 2.0;
+}
+
+// Shared driver for the Q1/Q2 variants, which own their points and provide polygonArea
+template <class Container, class Point, class HullFn, class AreaFn>
+static HullTiming timeFloatVariant(const std::vector<RawPoint>& input, HullFn hullFn, AreaFn areaFn) {
+    Container points;
+    for (const RawPoint& p : input) points.push_back(new Point(p.x, p.y));
+
+    HullTiming timing;
+    Clock::time_point start = Clock::now();
+    Container hull = hullFn(points);
+    timing.hullNs = elapsedNs(start);
+
+    start = Clock::now();
+    timing.area = areaFn(hull);
+    timing.areaNs = elapsedNs(start);
+    timing.hullSize = hull.size();
+
+    for (Point* point : points) delete point;
+    return timing;
+}
+
+HullTiming GrahamVariants::q1Vector(const std::vector<RawPoint>& input) {
+    return timeFloatVariant<std::vector<q1::Point*>, q1::Point>(input, q1::convexHull, q1::polygonArea);
+}
+
+HullTiming GrahamVariants::q2Deque(const std::vector<RawPoint>& input) {
+    return timeFloatVariant<std::deque<q2deque::Point*>, q2deque::Point>(input, q2deque::convexHull, q2deque::polygonArea);
+}
+
+HullTiming GrahamVariants::q2List(const std::vector<RawPoint>& input) {
+    return timeFloatVariant<std::list<q2list::Point*>, q2list::Point>(input, q2list::convexHull, q2list::polygonArea);
+}
+
+HullTiming GrahamVariants::q3Vector(const std::vector<RawPoint>& input) {
+    q3::Graph graph;
+    for (const RawPoint& p : input) graph.add_point(p.x, p.y);
+
+    HullTiming timing;
+    Clock::time_point start = Clock::now();
+    std::vector<q3::Point*> hull = q3::convexHull(graph.points);
+    timing.hullNs = elapsedNs(start);
+
+    start = Clock::now();
+    timing.area = integerArea(hull);
+    timing.areaNs = elapsedNs(start);
+    timing.hullSize = hull.size();
+    return timing;
+}
+
+HullTiming GrahamVariants::q4Graph(const std::vector<RawPoint>& input) {
+    q4::Graph graph;
+    for (const RawPoint& p : input) graph.addPoint(p.x, p.y);
+
+    HullTiming timing;
+    Clock::time_point start = Clock::now();
+    const std::vector<q4::Point>& hull = graph.convexHull();
+    timing.hullNs = elapsedNs(start);
+
+    start = Clock::now();
+    timing.area = integerArea(hull);
+    timing.areaNs = elapsedNs(start);
+    timing.hullSize = hull.size();
+    return timing;
+}
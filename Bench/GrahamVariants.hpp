@@ -0,0 +1,39 @@
+#ifndef BENCH_GRAHAM_VARIANTS_HPP
+#define BENCH_GRAHAM_VARIANTS_HPP
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief A plain input point, converted into each implementation's own point type.
+ */
+struct RawPoint {
+    float x;
+    float y;
+};
+
+/**
+ * @brief Result of one timed hull + area run.
+ */
+struct HullTiming {
+    double hullNs;
+    double areaNs;
+    size_t hullSize;
+    double area;
+};
+
+/**
+ * @brief The atan2 Graham scans of Q1-Q4, each compiled from its original source.
+ *
+ * Building each implementation's container is not timed; only the hull and the
+ * area computation on the resulting hull are.
+ */
+namespace GrahamVariants {
+    HullTiming q1Vector(const std::vector<RawPoint>& input);   // Q1: vector<Point*>, heap-allocated coordinates
+    HullTiming q2Deque(const std::vector<RawPoint>& input);    // Q2: deque<Point*>
+    HullTiming q2List(const std::vector<RawPoint>& input);     // Q2: list<Point*>
+    HullTiming q3Vector(const std::vector<RawPoint>& input);   // Q3: vector<Point*>, int coordinates
+    HullTiming q4Graph(const std::vector<RawPoint>& input);    // Q4: Graph::convexHull, int coordinates
+}
+
+#endif // BENCH_GRAHAM_VARIANTS_HPP
@@ -0,0 +1,297 @@
+#include "../Q8_Q9/ConvexHull.hpp"
+#include "GrahamVariants.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#ifndef BENCH_COMMIT
+#define BENCH_COMMIT "unknown"
+#endif
+
+#define COORDINATE_SCALE 1e4f  // Inputs span [0, 1e4) so the int cross products of Q3/Q4 cannot overflow
+
+/**
+ * @brief A named input distribution.
+ */
+struct Distribution {
+    const char* name;
+    void (*generate)(std::vector<RawPoint>& points, size_t n, std::mt19937_64& rng);
+};
+
+static void generateUniform(std::vector<RawPoint>& points, size_t n, std::mt19937_64& rng) {
+    std::uniform_real_distribution<float> coordinate(0, COORDINATE_SCALE);
+    for (size_t i = 0; i < n; ++i) points.push_back({coordinate(rng), coordinate(rng)});
+}
+
+static void generateGaussian(std::vector<RawPoint>& points, size_t n, std::mt19937_64& rng) {
+    std::normal_distribution<float> coordinate(COORDINATE_SCALE / 2, COORDINATE_SCALE / 10);
+    for (size_t i = 0; i < n; ++i) points.push_back({coordinate(rng), coordinate(rng)});
+}
+
+// Every point is a hull vertex: the worst case for hull size and area
+static void generateOnCircle(std::vector<RawPoint>& points, size_t n, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+    double radius = COORDINATE_SCALE / 2;
+    for (size_t i = 0; i < n; ++i) {
+        double a = angle(rng);
+        points.push_back({(float)(radius + radius * cos(a)), (float)(radius + radius * sin(a))});
+    }
+}
+
+static void generateClustered(std::vector<RawPoint>& points, size_t n, std::mt19937_64& rng) {
+    std::uniform_real_distribution<float> center(COORDINATE_SCALE / 10, COORDINATE_SCALE * 9 / 10);
+    std::normal_distribution<float> offset(0, COORDINATE_SCALE / 100);
+    RawPoint centers[16];
+    for (RawPoint& c : centers) c = {center(rng), center(rng)};
+    for (size_t i = 0; i < n; ++i) {
+        const RawPoint& c = centers[rng() % 16];
+        points.push_back({c.x + offset(rng), c.y + offset(rng)});
+    }
+}
+
+// Only 64 distinct values per axis, so most points are exact duplicates
+static void generateDuplicateHeavy(std::vector<RawPoint>& points, size_t n, std::mt19937_64& rng) {
+    for (size_t i = 0; i < n; ++i)
+        points.push_back({(float)(rng() % 64) * (COORDINATE_SCALE / 64), (float)(rng() % 64) * (COORDINATE_SCALE / 64)});
+}
+
+static const Distribution DISTRIBUTIONS[] = {
+    {"uniform", generateUniform},
+    {"gaussian", generateGaussian},
+    {"circle", generateOnCircle},
+    {"clustered", generateClustered},
+    {"duplicates", generateDuplicateHeavy},
+};
+
+// Maps a benchmark coordinate onto the coordinate type; int mode keeps two decimal places
+template <class T>
+static T toCoordinate(float value) { return (T)value; }
+
+template <>
+int32_t toCoordinate<int32_t>(float value) { return (int32_t)lroundf(value * 100); }
+
+// Monotone chain from BasicConvexHull (Q5_Q6 onwards) on PointVector<T>
+template <class T, HullMemoryMode MODE = HULL_MEMORY_FAST>
+static HullTiming monotoneChain(const std::vector<RawPoint>& input) {
+    PointVector<T> points;
+    points.reserve(input.size());
+    for (const RawPoint& p : input) points.emplace_back(toCoordinate<T>(p.x), toCoordinate<T>(p.y));
+
+    HullTiming timing;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<BasicPoint<T>> hull = BasicConvexHull<T>::findConvexHull(points, MODE);
+    timing.hullNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    timing.area = BasicConvexHull<T>::computeEnclosedArea(hull);
+    timing.areaNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    timing.hullSize = hull.size();
+    return timing;
+}
+
+/**
+ * @brief A hull implementation under test.
+ */
+struct Implementation {
+    const char* name;
+    const char* storage;
+    HullTiming (*run)(const std::vector<RawPoint>& input);
+};
+
+static const Implementation IMPLEMENTATIONS[] = {
+    {"graham_q1", "vector", GrahamVariants::q1Vector},
+    {"graham_q2_deque", "deque", GrahamVariants::q2Deque},
+    {"graham_q2_list", "list", GrahamVariants::q2List},
+    {"graham_q3", "vector", GrahamVariants::q3Vector},
+    {"graham_q4", "vector", GrahamVariants::q4Graph},
+    {"monotone_chain", "vector", monotoneChain<float>},
+    {"monotone_chain_int", "vector", monotoneChain<int32_t>},
+    {"monotone_chain_double", "vector", monotoneChain<double>},
+    {"monotone_chain_lean", "vector", monotoneChain<float, HULL_MEMORY_LEAN>},
+    {"monotone_chain_int_lean", "vector", monotoneChain<int32_t, HULL_MEMORY_LEAN>},
+};
+
+// Reads a "Field:  <n> kB" line of /proc/self/status, in bytes
+static size_t statusBytes(const char* field) {
+    FILE* status = fopen("/proc/self/status", "r");
+    if (!status) return 0;
+    char line[256];
+    size_t kilobytes = 0, fieldLength = strlen(field);
+    while (fgets(line, sizeof(line), status)) {
+        if (strncmp(line, field, fieldLength) == 0) {
+            kilobytes = strtoul(line + fieldLength, nullptr, 10);
+            break;
+        }
+    }
+    fclose(status);
+    return kilobytes * 1024;
+}
+
+/**
+ * @brief Runs one repetition in a forked child so its peak memory can be measured on its own.
+ *
+ * The child starts with the parent's resident pages, so the peak RSS wait4 reports for it,
+ * minus the parent's current RSS, is what the run itself added, its copy of the input included.
+ */
+static HullTiming runIsolated(const Implementation& implementation, const std::vector<RawPoint>& input,
+                              size_t& peakBytes) {
+    HullTiming timing = {};
+    peakBytes = 0;
+    int channel[2];
+    if (pipe(channel) < 0) {
+        perror("pipe");
+        exit(1);
+    }
+
+    size_t baseline = statusBytes("VmRSS:");
+    pid_t child = fork();
+    if (child < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (child == 0) {
+        timing = implementation.run(input);
+        ssize_t written = write(channel[1], &timing, sizeof(timing));
+        _exit(written == (ssize_t)sizeof(timing) ? 0 : 1);
+    }
+
+    close(channel[1]);
+    if (read(channel[0], &timing, sizeof(timing)) != (ssize_t)sizeof(timing)) {
+        fprintf(stderr, "%s did not report a result\n", implementation.name);
+        exit(1);
+    }
+    close(channel[0]);
+
+    int status;
+    struct rusage usage;
+    wait4(child, &status, 0, &usage);
+    size_t peak = (size_t)usage.ru_maxrss * 1024;
+    if (peak > baseline) peakBytes = peak - baseline;
+    return timing;
+}
+
+// True if name appears in the comma separated filter (an empty filter selects everything)
+static bool selected(const char* name, const std::string& filter) {
+    if (filter.empty()) return true;
+    size_t start = 0;
+    while (start <= filter.size()) {
+        size_t end = filter.find(',', start);
+        if (end == std::string::npos) end = filter.size();
+        if (filter.compare(start, end - start, name) == 0) return true;
+        start = end + 1;
+    }
+    return false;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [-n sizes] [-d distributions] [-i implementations] [-r repetitions] [-s seed] [-o out.json]\n"
+            "  -n comma separated sizes, e.g. 1e3,1e4,1e8 (default 1e3,1e4,1e5,1e6)\n"
+            "  -d any of uniform,gaussian,circle,clustered,duplicates (default all)\n"
+            "  -i any of graham_q1,graham_q2_deque,graham_q2_list,graham_q3,graham_q4,monotone_chain,\n"
+            "     monotone_chain_int,monotone_chain_double,monotone_chain_lean,monotone_chain_int_lean\n",
+            program);
+    exit(1);
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<size_t> sizes = {1000, 10000, 100000, 1000000};
+    std::string distributionFilter, implementationFilter;
+    const char* outputPath = nullptr;
+    int repetitions = 3;
+    unsigned long seed = 42;
+
+    int option;
+    while ((option = getopt(argc, argv, "n:d:i:r:s:o:")) != -1) {
+        switch (option) {
+        case 'n': {
+            sizes.clear();
+            char* cursor = optarg;
+            while (*cursor) {
+                sizes.push_back((size_t)strtod(cursor, &cursor));
+                if (*cursor == ',') cursor++;
+                else if (*cursor) usage(argv[0]);
+            }
+            break;
+        }
+        case 'd': distributionFilter = optarg; break;
+        case 'i': implementationFilter = optarg; break;
+        case 'r': repetitions = std::max(1, atoi(optarg)); break;
+        case 's': seed = strtoul(optarg, nullptr, 10); break;
+        case 'o': outputPath = optarg; break;
+        default: usage(argv[0]);
+        }
+    }
+
+    FILE* json = outputPath ? fopen(outputPath, "w") : nullptr;
+    if (outputPath && !json) {
+        perror("fopen");
+        return 1;
+    }
+    if (json) fprintf(json, "{\n  \"commit\": \"%s\",\n  \"seed\": %lu,\n  \"results\": [", BENCH_COMMIT, seed);
+    bool firstResult = true;
+
+    printf("%-23s %-7s %-11s %11s %14s %14s %9s %16s %9s\n",
+           "implementation", "storage", "dist", "n", "hull_ns", "area_ns", "hull", "area", "peak_mb");
+
+    std::vector<RawPoint> input;
+    for (const Distribution& distribution : DISTRIBUTIONS) {
+        if (!selected(distribution.name, distributionFilter)) continue;
+
+        for (size_t n : sizes) {
+            std::mt19937_64 rng(seed);
+            input.clear();
+            input.shrink_to_fit();
+            input.reserve(n);
+            distribution.generate(input, n, rng);
+
+            for (const Implementation& implementation : IMPLEMENTATIONS) {
+                if (!selected(implementation.name, implementationFilter)) continue;
+
+                // Median of the repetitions; every run gets a fresh copy of the input
+                std::vector<HullTiming> runs;
+                size_t peakBytes = 0;
+                for (int r = 0; r < repetitions; ++r) {
+                    size_t runPeak;
+                    runs.push_back(runIsolated(implementation, input, runPeak));
+                    peakBytes = std::max(peakBytes, runPeak);
+                }
+                std::sort(runs.begin(), runs.end(),
+                          [](const HullTiming& a, const HullTiming& b) { return a.hullNs < b.hullNs; });
+                const HullTiming& median = runs[runs.size() / 2];
+                double minHullNs = runs.front().hullNs;
+
+                printf("%-23s %-7s %-11s %11zu %14.0f %14.0f %9zu %16.6g %9.1f\n", implementation.name,
+                       implementation.storage, distribution.name, n, median.hullNs, median.areaNs,
+                       median.hullSize, median.area, peakBytes / 1048576.0);
+                fflush(stdout);
+
+                if (json) {
+                    fprintf(json,
+                            "%s\n    {\"implementation\": \"%s\", \"storage\": \"%s\", \"distribution\": \"%s\", "
+                            "\"n\": %zu, \"repetitions\": %d, \"hull_ns_median\": %.0f, \"hull_ns_min\": %.0f, "
+                            "\"area_ns_median\": %.0f, \"hull_size\": %zu, \"area\": %.9g, \"peak_rss_bytes\": %zu}",
+                            firstResult ? "" : ",", implementation.name, implementation.storage,
+                            distribution.name, n, repetitions, median.hullNs, minHullNs, median.areaNs,
+                            median.hullSize, median.area, peakBytes);
+                    firstResult = false;
+                }
+            }
+        }
+    }
+
+    if (json) {
+        fprintf(json, "\n  ]\n}\n");
+        fclose(json);
+    }
+    return 0;
+}
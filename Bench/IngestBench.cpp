@@ -0,0 +1,252 @@
+#include "../Q8_Q9/PointIngest.hpp"
+#include "../Q8_Q9/Stats.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BENCH_PORT 9700          // TCP commands; UDP ingest on the port after it
+#define SEND_BATCH 32            // Datagrams a sender passes to one sendmmsg
+#define DRAIN_WAIT_US 300000     // After the senders stop, time for the server to empty its socket
+
+/**
+ * @brief Starts "server args..." with its output discarded.
+ */
+static pid_t spawnServer(const char* path, const std::vector<std::string>& args) {
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+
+    int devNull = open("/dev/null", O_WRONLY);
+    dup2(devNull, STDOUT_FILENO);
+    dup2(devNull, STDERR_FILENO);
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(path));
+    for (const std::string& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+    execv(path, argv.data());
+    _exit(127);
+}
+
+static struct sockaddr_in loopback(int port) {
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof address);
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+}
+
+// Retries until the server listens, and reads its greeting
+static int connectWhenReady(int port) {
+    struct sockaddr_in address = loopback(port);
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(fd, (struct sockaddr*)&address, sizeof address) == 0) {
+            int yes = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+            char greeting[3];
+            if (recv(fd, greeting, sizeof greeting, MSG_WAITALL) == sizeof greeting) return fd;
+        }
+        close(fd);
+        usleep(50000);
+    }
+    return -1;
+}
+
+// Sends a request and reads up to the ">> " prompt that ends the reply
+static bool roundTrip(int fd, const std::string& request, std::string& reply) {
+    if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size()) return false;
+    reply.clear();
+    char buffer[4096];
+    while (reply.size() < 3 || reply.compare(reply.size() - 3, 3, ">> ") != 0) {
+        ssize_t received = recv(fd, buffer, sizeof buffer, 0);
+        if (received <= 0) return false;
+        reply.append(buffer, received);
+    }
+    return true;
+}
+
+// Points the server has taken so far, from the first line of "Ingest"
+static uint64_t ingestedPoints(int fd) {
+    std::string reply;
+    if (!roundTrip(fd, "Ingest\n", reply)) return 0;
+    size_t comma = reply.find(", ");
+    return comma == std::string::npos ? 0 : strtoull(reply.c_str() + comma + 2, nullptr, 10);
+}
+
+// Sums a "N lost" style field over the per-sender lines of "Ingest"
+static uint64_t ingestField(int fd, const char* field) {
+    std::string reply;
+    if (!roundTrip(fd, "Ingest\n", reply)) return 0;
+    uint64_t total = 0;
+    for (size_t at = reply.find(field); at != std::string::npos; at = reply.find(field, at + 1)) {
+        size_t start = reply.rfind(", ", at);
+        if (start != std::string::npos) total += strtoull(reply.c_str() + start + 2, nullptr, 10);
+    }
+    return total;
+}
+
+static void printRow(const char* path, size_t senders, size_t perMessage, uint64_t sent, uint64_t taken,
+                     uint64_t sequenceLost, double seconds) {
+    printf("%-12s %8zu %10zu %14.0f %14.0f %8.2f %10llu\n", path, senders, perMessage, sent / seconds, taken / seconds,
+           sent > 0 ? 100.0 * (sent - taken) / sent : 0.0, (unsigned long long)sequenceLost);
+    fflush(stdout);
+}
+
+// Coordinates on a 1000 x 1000 grid, different for every sender
+static void fillPoints(std::vector<double>& coordinates, size_t count, uint64_t& rng) {
+    coordinates.resize(2 * count);
+    for (double& coordinate : coordinates) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        coordinate = (rng % 1000000) / 1000.0;
+    }
+}
+
+/**
+ * @brief @p senders threads each blast datagrams of @p perDatagram points at the server for
+ * @p seconds, in sendmmsg batches, together offering up to @p rate points a second (0: as fast
+ * as they can). Loss is what was sent but not taken; the server's own count from the
+ * sequence numbers misses datagrams lost after the last one to arrive.
+ */
+static bool measureUdp(size_t senders, size_t perDatagram, double rate, double seconds, int control) {
+    std::string reply;
+    // Datagrams only reach a graph that exists
+    if (!roundTrip(control, "DropGraph ingest\n", reply) || !roundTrip(control, "Use ingest\n", reply)) return false;
+    uint64_t before = ingestedPoints(control), lostBefore = ingestField(control, " lost");
+
+    std::vector<uint64_t> sent(senders, 0);
+    uint64_t deadline = ServerStats::now() + (uint64_t)(seconds * 1e9);
+    std::vector<std::thread> threads;
+    for (size_t s = 0; s < senders; ++s) {
+        threads.emplace_back([&, s] {
+            int fd = socket(AF_INET, SOCK_DGRAM, 0);
+            struct sockaddr_in address = loopback(BENCH_PORT + 1);
+            if (connect(fd, (struct sockaddr*)&address, sizeof address) != 0) return;
+
+            uint64_t rng = 0x9E3779B97F4A7C15ULL + s;
+            std::vector<double> coordinates;
+            fillPoints(coordinates, perDatagram, rng);
+            size_t capacity = sizeof(IngestHeader) + 16 + perDatagram * 2 * sizeof(double);
+            std::vector<char> buffers(SEND_BATCH * capacity);
+            struct mmsghdr messages[SEND_BATCH];
+            struct iovec vectors[SEND_BATCH];
+            uint64_t sequence = 0;
+            uint64_t interval = rate > 0 ? (uint64_t)(1e9 * SEND_BATCH * perDatagram * senders / rate) : 0;
+            for (uint64_t next = ServerStats::now(), now = next; now < deadline; next += interval) {
+                now = ServerStats::now();
+                if (next > now) usleep((next - now) / 1000);
+                for (int i = 0; i < SEND_BATCH; ++i) {
+                    char* buffer = buffers.data() + i * capacity;
+                    vectors[i].iov_base = buffer;
+                    vectors[i].iov_len = PointIngest::pack(buffer, capacity, "ingest", sequence++, coordinates.data(), perDatagram);
+                    memset(&messages[i].msg_hdr, 0, sizeof messages[i].msg_hdr);
+                    messages[i].msg_hdr.msg_iov = &vectors[i];
+                    messages[i].msg_hdr.msg_iovlen = 1;
+                }
+                int queued = sendmmsg(fd, messages, SEND_BATCH, 0);
+                if (queued < 0) break;
+                sent[s] += (uint64_t)queued * perDatagram;
+                sequence -= SEND_BATCH - queued; // Numbers not handed to the kernel are used again
+            }
+            close(fd);
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    usleep(DRAIN_WAIT_US);
+
+    uint64_t totalSent = 0;
+    for (uint64_t count : sent) totalSent += count;
+    uint64_t taken = ingestedPoints(control) - before;
+    uint64_t lostDatagrams = ingestField(control, " lost") - lostBefore;
+    printRow("udp", senders, perDatagram, totalSent, taken, lostDatagrams, seconds);
+    return true;
+}
+
+/**
+ * @brief @p clients connections each send AddPoint and wait for the reply, for @p seconds.
+ */
+static bool measureAddPoint(size_t clients, double seconds, int control) {
+    std::string reply;
+    if (!roundTrip(control, "DropGraph ingest\n", reply)) return false;
+
+    std::vector<uint64_t> added(clients, 0);
+    std::atomic<bool> failed(false);
+    uint64_t deadline = ServerStats::now() + (uint64_t)(seconds * 1e9);
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c] {
+            int fd = connectWhenReady(BENCH_PORT);
+            std::string answer;
+            if (fd < 0 || !roundTrip(fd, "Use ingest\n", answer)) {
+                failed = true;
+                return;
+            }
+            char request[64];
+            for (uint64_t i = 0; ServerStats::now() < deadline; ++i) {
+                snprintf(request, sizeof request, "AddPoint %u,%u\n", (unsigned int)(i % 1000), (unsigned int)((i / 1000 + c) % 1000));
+                if (!roundTrip(fd, request, answer)) {
+                    failed = true;
+                    break;
+                }
+                added[c]++;
+            }
+            close(fd);
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    uint64_t total = 0;
+    for (uint64_t count : added) total += count;
+    printRow("tcp AddPoint", clients, 1, total, total, 0, seconds);
+    return !failed;
+}
+
+int main(int argc, char* argv[]) {
+    const char* server = "../Q8_Q9/server";
+    double seconds = 2, rate = 0;
+    int option;
+    while ((option = getopt(argc, argv, "S:t:R:")) != -1) {
+        if (option == 'S') {
+            server = optarg;
+        } else if (option == 't') {
+            seconds = strtod(optarg, nullptr);
+        } else if (option == 'R') {
+            rate = strtod(optarg, nullptr);
+        } else {
+            fprintf(stderr, "Usage: %s [-S server_binary] [-t seconds_per_run] [-R udp_points_per_second]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    pid_t pid = spawnServer(server, {"-c", "double", "-p", std::to_string(BENCH_PORT), "-u",
+                                     std::to_string(BENCH_PORT + 1)});
+    int control = connectWhenReady(BENCH_PORT);
+    bool ok = control >= 0;
+
+    printf("Sustained point ingest, %.1f s per run, UDP offered %s, %d CPUs\n", seconds,
+           rate > 0 ? (std::to_string((uint64_t)rate) + " points/s").c_str() : "as fast as possible",
+           (int)sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-12s %8s %10s %14s %14s %8s %10s\n", "path", "senders", "per_msg", "sent_pts/s", "taken_pts/s", "loss_%",
+           "seq_lost");
+    for (size_t clients : {1, 8}) ok = ok && measureAddPoint(clients, seconds, control);
+    for (size_t perDatagram : {1, 64, 1000})
+        for (size_t senders : {1, 4}) ok = ok && measureUdp(senders, perDatagram, rate, seconds, control);
+    if (!ok) fprintf(stderr, "Benchmark failed: is %s built, and are ports %d and %d free?\n", server, BENCH_PORT, BENCH_PORT + 1);
+
+    if (control >= 0) close(control);
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    return ok ? 0 : 1;
+}
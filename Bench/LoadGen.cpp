@@ -0,0 +1,444 @@
+#include "../Q8_Q9/Stats.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+
+#define REPLY_BUFFER 65536
+#define UPLOAD_CHUNK 65536  // Bytes of point lines per send; servers read them in pieces that may cut a line
+#define MAX_EPOLL_EVENTS 256
+
+/**
+ * @brief The command dialect of each server in the tree.
+ */
+struct Dialect {
+    const char* name;
+    const char* createGraph;   // printf format taking the point count, or nullptr
+    const char* addPoint;      // Prefix followed by "x,y"
+    const char* removePoint;
+    const char* convexHull;
+    bool prompt;               // Replies (and the greeting) end with ">> "
+};
+
+static const Dialect DIALECTS[] = {
+    {"q4", nullptr, "NewPoint ", "RemovePoint ", "CH\n", false},
+    {"q5", "Newgraph %zu\n", "Newpoint ", "Removepoint ", "CH\n", true},
+    {"q7", "CreateGraph %zu\n", "AddPoint ", "RemovePoint ", "ComputeCH\n", true},
+    {"q8", "CreateGraph %zu\n", "AddPoint ", "RemovePoint ", "CH\n", true},
+};
+
+enum Operation { OP_ADD = 0, OP_REMOVE, OP_CH, OP_COUNT };
+static const char* OPERATION_NAMES[OP_COUNT] = {"AddPoint", "RemovePoint", "CH"};
+
+/**
+ * @brief Load generator settings, filled from the command line.
+ */
+struct Options {
+    const char* host = "127.0.0.1";
+    const char* port = "9034";
+    const Dialect* dialect = &DIALECTS[3];
+    size_t connections = 100;
+    size_t threads = 1;
+    double durationSeconds = 10;
+    double rate = 0;               // Total requests per second; 0 runs closed-loop
+    size_t graphSize = 0;          // Points uploaded in bulk before the run
+    unsigned mix[OP_COUNT] = {45, 45, 10};
+};
+
+enum ConnectionState { CONNECTING, AWAITING_GREETING, IDLE, AWAITING_REPLY, CLOSED };
+
+/**
+ * @brief One client connection with at most one request in flight.
+ */
+struct Connection {
+    int fd = -1;
+    ConnectionState state = CONNECTING;
+    Operation operation = OP_ADD;
+    uint64_t intendedTime = 0;     // When the request was due (open loop) or sent (closed loop)
+    uint64_t nextDue = 0;
+    std::string replyTail;         // Bytes of a partial reply
+    float lastX = 0, lastY = 0;    // Point the next RemovePoint undoes
+    bool havePoint = false;
+};
+
+/**
+ * @brief Results of one worker thread.
+ */
+struct WorkerResult {
+    LatencyHistogram latency[OP_COUNT];
+    uint64_t completed = 0;
+    uint64_t errors = 0;
+};
+
+static uint64_t xorshift(uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static int connectTo(const Options& options, bool blocking) {
+    struct addrinfo hints, *result;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(options.host, options.port, &hints, &result) != 0) return -1;
+
+    int fd = socket(result->ai_family, result->ai_socktype | (blocking ? 0 : SOCK_NONBLOCK), result->ai_protocol);
+    if (fd >= 0) {
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+        if (connect(fd, result->ai_addr, result->ai_addrlen) < 0 && errno != EINPROGRESS) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(result);
+    return fd;
+}
+
+/**
+ * @brief Returns true once @p data holds a complete reply for the dialect.
+ *
+ * Prompting servers end every reply with ">> ". The select server (q4) has no
+ * terminator, but sends each reply with a single send(), so any data counts.
+ */
+static bool replyComplete(const Dialect& dialect, const std::string& data) {
+    if (!dialect.prompt) return !data.empty();
+    return data.size() >= 3 && data.compare(data.size() - 3, 3, ">> ") == 0;
+}
+
+// Blocking request/reply used for the bulk upload
+static bool roundTrip(int fd, const Dialect& dialect, const std::string& request) {
+    if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size()) return false;
+
+    std::string reply;
+    char buffer[REPLY_BUFFER];
+    while (!replyComplete(dialect, reply)) {
+        ssize_t received = recv(fd, buffer, sizeof buffer, 0);
+        if (received <= 0) return false;
+        reply.append(buffer, received);
+    }
+    return true;
+}
+
+static bool sendAll(int fd, const std::string& data) {
+    for (size_t sent = 0; sent < data.size();) {
+        ssize_t written = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0) return false;
+        sent += written;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads the replies to a bulk upload that have arrived, or waits for them all if @p wait.
+ *
+ * The server answers each piece it reads, so the number of replies is not known in
+ * advance; @p complete is set by the one that ends the graph.
+ * @return False on an error reply or a closed connection.
+ */
+static bool readUploadReplies(int fd, bool wait, std::string& replies, bool& complete) {
+    char buffer[REPLY_BUFFER];
+    while (!complete) {
+        ssize_t received = recv(fd, buffer, sizeof buffer, wait ? 0 : MSG_DONTWAIT);
+        if (received < 0 && !wait && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (received <= 0) return false;
+        replies.append(buffer, received);
+        if (replies.find("nvalid") != std::string::npos || replies.find("out of range") != std::string::npos) return false;
+        complete = replies.find("Graph creation complete") != std::string::npos;
+        // Keep enough for a reply split across reads
+        if (replies.size() > 64) replies.erase(0, replies.size() - 64);
+    }
+    return true;
+}
+
+/**
+ * @brief Creates the initial graph. Bulk dialects get the point lines as one stream in
+ * large sends; the others one command per message.
+ */
+static bool uploadGraph(const Options& options) {
+    const Dialect& dialect = *options.dialect;
+    int fd = connectTo(options, true);
+    if (fd < 0) return false;
+
+    if (dialect.prompt && !roundTrip(fd, dialect, "")) return false;
+
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    uint64_t start = ServerStats::now();
+    char line[64];
+    std::string chunk, replies;
+    bool complete = false;
+
+    if (dialect.createGraph) {
+        snprintf(line, sizeof line, dialect.createGraph, options.graphSize);
+        if (!roundTrip(fd, dialect, line)) return false;
+    }
+
+    for (size_t i = 0; i < options.graphSize; ++i) {
+        float x = (xorshift(rng) % 1000000) / 1000.0f, y = (xorshift(rng) % 1000000) / 1000.0f;
+        if (dialect.createGraph) {
+            snprintf(line, sizeof line, "%g,%g\n", x, y);
+        } else {
+            snprintf(line, sizeof line, "%s%g,%g\n", dialect.addPoint, x, y);
+        }
+
+        // Servers without bulk upload take one command per message
+        if (!dialect.createGraph) {
+            if (!roundTrip(fd, dialect, line)) return false;
+            continue;
+        }
+        chunk += line;
+        if (chunk.size() >= UPLOAD_CHUNK) {
+            if (!sendAll(fd, chunk) || !readUploadReplies(fd, false, replies, complete)) return false;
+            chunk.clear();
+        }
+    }
+    if (dialect.createGraph && (!sendAll(fd, chunk) || !readUploadReplies(fd, true, replies, complete))) return false;
+
+    double seconds = (ServerStats::now() - start) / 1e9;
+    printf("Uploaded %zu points in %.3f s (%.0f points/s)\n", options.graphSize, seconds, options.graphSize / seconds);
+    close(fd);
+    return true;
+}
+
+static Operation pickOperation(const Options& options, Connection& connection, uint64_t& rng) {
+    unsigned total = options.mix[OP_ADD] + options.mix[OP_REMOVE] + options.mix[OP_CH];
+    unsigned roll = xorshift(rng) % total;
+    Operation operation = roll < options.mix[OP_ADD] ? OP_ADD
+                        : roll < options.mix[OP_ADD] + options.mix[OP_REMOVE] ? OP_REMOVE : OP_CH;
+
+    // Churn: a RemovePoint always undoes this connection's last AddPoint
+    if (operation == OP_REMOVE && !connection.havePoint) operation = OP_ADD;
+    return operation;
+}
+
+static bool sendRequest(const Options& options, Connection& connection, uint64_t& rng) {
+    const Dialect& dialect = *options.dialect;
+    char request[96];
+    int length;
+
+    connection.operation = pickOperation(options, connection, rng);
+    switch (connection.operation) {
+    case OP_ADD:
+        connection.lastX = (xorshift(rng) % 1000000) / 1000.0f;
+        connection.lastY = (xorshift(rng) % 1000000) / 1000.0f;
+        connection.havePoint = true;
+        length = snprintf(request, sizeof request, "%s%g,%g\n", dialect.addPoint, connection.lastX, connection.lastY);
+        break;
+    case OP_REMOVE:
+        connection.havePoint = false;
+        length = snprintf(request, sizeof request, "%s%g,%g\n", dialect.removePoint, connection.lastX, connection.lastY);
+        break;
+    default:
+        length = snprintf(request, sizeof request, "%s", dialect.convexHull);
+        break;
+    }
+
+    connection.replyTail.clear();
+    connection.state = AWAITING_REPLY;
+    return send(connection.fd, request, length, MSG_NOSIGNAL) == length;
+}
+
+/**
+ * @brief Drives a slice of the connections with one epoll loop.
+ *
+ * In open-loop mode every connection owns a fixed schedule of send times.
+ * Latency is measured from the scheduled time rather than the actual send,
+ * so a stalled server is charged for the requests it delayed (coordinated
+ * omission correction).
+ */
+static void runWorker(const Options& options, size_t connectionCount, size_t workerIndex, WorkerResult& result) {
+    const Dialect& dialect = *options.dialect;
+    uint64_t rng = 0x2545F4914F6CDD1DULL + workerIndex * 0x9E3779B97F4A7C15ULL;
+    int epollFd = epoll_create1(0);
+    std::vector<Connection> connections(connectionCount);
+
+    double perConnectionRate = options.rate / options.connections;
+    uint64_t interval = options.rate > 0 ? (uint64_t)(1e9 / perConnectionRate) : 0;
+    uint64_t start = ServerStats::now();
+
+    for (size_t i = 0; i < connectionCount; ++i) {
+        Connection& connection = connections[i];
+        connection.fd = connectTo(options, false);
+        if (connection.fd < 0) {
+            result.errors++;
+            connection.state = CLOSED;
+            continue;
+        }
+        // Spread the first requests evenly over one interval
+        connection.nextDue = start + (interval ? xorshift(rng) % interval : 0);
+        struct epoll_event event = {};
+        event.events = EPOLLIN | EPOLLOUT;
+        event.data.u64 = i;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, connection.fd, &event);
+    }
+
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    char buffer[REPLY_BUFFER];
+
+    while (true) {
+        uint64_t now = ServerStats::now();
+
+        // Send every request that is due on an idle connection
+        int timeoutMs = 100;
+        for (Connection& connection : connections) {
+            if (connection.state != IDLE) continue;
+            if (interval && connection.nextDue > now) {
+                timeoutMs = std::min<int>(timeoutMs, (connection.nextDue - now) / 1000000);
+                continue;
+            }
+            connection.intendedTime = interval ? connection.nextDue : now;
+            connection.nextDue += interval;
+            if (!sendRequest(options, connection, rng)) {
+                result.errors++;
+                connection.state = CLOSED;
+                close(connection.fd);
+            }
+        }
+
+        int ready = epoll_wait(epollFd, events, MAX_EPOLL_EVENTS, timeoutMs);
+        for (int e = 0; e < ready; ++e) {
+            Connection& connection = connections[events[e].data.u64];
+            if (connection.state == CLOSED) continue;
+
+            if (connection.state == CONNECTING && (events[e].events & EPOLLOUT)) {
+                struct epoll_event event = {};
+                event.events = EPOLLIN;
+                event.data.u64 = events[e].data.u64;
+                epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+                connection.state = dialect.prompt ? AWAITING_GREETING : IDLE;
+            }
+            if (!(events[e].events & (EPOLLIN | EPOLLERR | EPOLLHUP))) continue;
+
+            ssize_t received = recv(connection.fd, buffer, sizeof buffer, 0);
+            if (received <= 0) {
+                if (received < 0 && errno == EAGAIN) continue;
+                result.errors++;
+                connection.state = CLOSED;
+                close(connection.fd);
+                continue;
+            }
+            connection.replyTail.append(buffer, received);
+            if (!replyComplete(dialect, connection.replyTail)) continue;
+
+            if (connection.state == AWAITING_REPLY) {
+                uint64_t done = ServerStats::now();
+                result.latency[connection.operation].record(done - connection.intendedTime);
+                result.completed++;
+            }
+            connection.replyTail.clear();
+            connection.state = IDLE;
+        }
+
+        if (ServerStats::now() - start >= options.durationSeconds * 1e9) break;
+    }
+
+    for (Connection& connection : connections)
+        if (connection.state != CLOSED) close(connection.fd);
+    close(epollFd);
+}
+
+static void printLatency(const char* name, const LatencyHistogram& histogram) {
+    if (histogram.count() == 0) return;
+    printf("%-12s count=%-9lu p50=%9.1fus p90=%9.1fus p99=%9.1fus p999=%9.1fus max=%9.1fus\n", name,
+           (unsigned long)histogram.count(), histogram.quantile(0.5) / 1e3, histogram.quantile(0.9) / 1e3,
+           histogram.quantile(0.99) / 1e3, histogram.quantile(0.999) / 1e3, histogram.max() / 1e3);
+}
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [-H host] [-p port] [-d q4|q5|q7|q8] [-c connections] [-t threads]\n"
+            "          [-s seconds] [-r total_rate] [-g bulk_graph_points] [-m add,remove,ch]\n"
+            "  -r 0 (default) runs closed-loop as fast as possible; -r N holds N requests/s\n"
+            "  -m sets the command mix weights, e.g. -m 45,45,10\n",
+            program);
+    exit(1);
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    int option;
+    while ((option = getopt(argc, argv, "H:p:d:c:t:s:r:g:m:")) != -1) {
+        switch (option) {
+        case 'H': options.host = optarg; break;
+        case 'p': options.port = optarg; break;
+        case 'd': {
+            const Dialect* match = nullptr;
+            for (const Dialect& dialect : DIALECTS)
+                if (strcmp(dialect.name, optarg) == 0) match = &dialect;
+            if (!match) usage(argv[0]);
+            options.dialect = match;
+            break;
+        }
+        case 'c': options.connections = strtoul(optarg, nullptr, 10); break;
+        case 't': options.threads = strtoul(optarg, nullptr, 10); break;
+        case 's': options.durationSeconds = atof(optarg); break;
+        case 'r': options.rate = atof(optarg); break;
+        case 'g': options.graphSize = strtoul(optarg, nullptr, 10); break;
+        case 'm':
+            if (sscanf(optarg, "%u,%u,%u", &options.mix[OP_ADD], &options.mix[OP_REMOVE], &options.mix[OP_CH]) != 3)
+                usage(argv[0]);
+            break;
+        default: usage(argv[0]);
+        }
+    }
+    if (options.connections == 0 || options.threads == 0 ||
+        options.mix[OP_ADD] + options.mix[OP_REMOVE] + options.mix[OP_CH] == 0)
+        usage(argv[0]);
+    options.threads = std::min(options.threads, options.connections);
+
+    // Thousands of sockets need a raised descriptor limit
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < options.connections + 64) {
+        limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, options.connections + 64);
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    if (options.graphSize > 0 && !uploadGraph(options)) {
+        perror("Bulk graph upload failed");
+        return 1;
+    }
+
+    std::vector<WorkerResult> results(options.threads);
+    std::vector<std::thread> workers;
+    uint64_t start = ServerStats::now();
+    for (size_t t = 0; t < options.threads; ++t) {
+        size_t share = options.connections / options.threads + (t < options.connections % options.threads);
+        workers.emplace_back(runWorker, std::cref(options), share, t, std::ref(results[t]));
+    }
+    for (std::thread& worker : workers) worker.join();
+    double elapsed = (ServerStats::now() - start) / 1e9;
+
+    LatencyHistogram total, perOperation[OP_COUNT];
+    uint64_t completed = 0, errors = 0;
+    for (WorkerResult& result : results) {
+        for (int op = 0; op < OP_COUNT; ++op) {
+            perOperation[op].merge(result.latency[op]);
+            total.merge(result.latency[op]);
+        }
+        completed += result.completed;
+        errors += result.errors;
+    }
+
+    printf("Dialect %s, %zu connections, %s", options.dialect->name, options.connections,
+           options.rate > 0 ? "open loop" : "closed loop");
+    if (options.rate > 0) printf(" at %.0f req/s", options.rate);
+    printf("\nCompleted %lu requests in %.2f s: %.0f req/s, %lu errors\n",
+           (unsigned long)completed, elapsed, completed / elapsed, (unsigned long)errors);
+    for (int op = 0; op < OP_COUNT; ++op) printLatency(OPERATION_NAMES[op], perOperation[op]);
+    printLatency("all", total);
+    return 0;
+}
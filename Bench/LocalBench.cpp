@@ -0,0 +1,268 @@
+#include "../Q8_Q9/LocalRing.hpp"
+#include "../Q8_Q9/Stats.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BENCH_PORT 9600
+#define BENCH_SOCKET "/tmp/local_bench.sock"
+#define SOCKET_CHUNK 900              // Bytes of point lines per message; the server reads up to 1023 at a time
+#define RING_TEXT_CHUNK (1 << 20)     // Bytes of point lines per ring message
+#define RING_POINTS_CHUNK (1 << 16)   // Points per binary ring message
+
+/**
+ * @brief Starts "server args..." with its output discarded.
+ */
+static pid_t spawnServer(const char* path, const std::vector<std::string>& args) {
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+
+    int devNull = open("/dev/null", O_WRONLY);
+    dup2(devNull, STDOUT_FILENO);
+    dup2(devNull, STDERR_FILENO);
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(path));
+    for (const std::string& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+    execv(path, argv.data());
+    _exit(127);
+}
+
+// Retries until the server listens, and reads its greeting
+static int connectWhenReady(const struct sockaddr* address, socklen_t length) {
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        int fd = socket(address->sa_family, SOCK_STREAM, 0);
+        if (connect(fd, address, length) == 0) {
+            int yes = 1;
+            if (address->sa_family == AF_INET) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+            char greeting[3];
+            if (recv(fd, greeting, sizeof greeting, MSG_WAITALL) == sizeof greeting) return fd;
+        }
+        close(fd);
+        usleep(50000);
+    }
+    return -1;
+}
+
+static int connectTcp() {
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof address);
+    address.sin_family = AF_INET;
+    address.sin_port = htons(BENCH_PORT);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return connectWhenReady((struct sockaddr*)&address, sizeof address);
+}
+
+static int connectUnix() {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof address);
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, BENCH_SOCKET);
+    return connectWhenReady((struct sockaddr*)&address, sizeof address);
+}
+
+// Sends a request and reads up to the ">> " prompt that ends the reply
+static bool roundTrip(int fd, const std::string& request, std::string& reply) {
+    if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size()) return false;
+    reply.clear();
+    char buffer[4096];
+    while (reply.size() < 3 || reply.compare(reply.size() - 3, 3, ">> ") != 0) {
+        ssize_t received = recv(fd, buffer, sizeof buffer, 0);
+        if (received <= 0) return false;
+        reply.append(buffer, received);
+    }
+    return true;
+}
+
+/**
+ * @brief One way of talking to the server: a socket with the text protocol, or a shared ring.
+ */
+struct Transport {
+    const char* name;
+    int fd = -1;
+    LocalRingClient* ring = nullptr;
+
+    bool call(const std::string& request, std::string& reply) {
+        if (ring != nullptr) return ring->call(request.c_str(), reply);
+        return roundTrip(fd, request + "\n", reply);
+    }
+};
+
+static void printLatency(const char* name, const LatencyHistogram& latency, size_t count, double seconds) {
+    printf("%-14s %10.1f %10.1f %10.1f %12.0f\n", name, latency.quantile(0.5) / 1e3, latency.quantile(0.99) / 1e3,
+           latency.quantile(0.999) / 1e3, count / seconds);
+    fflush(stdout);
+}
+
+/**
+ * @brief Times @p count round trips of a query the server answers from its cached hull.
+ */
+static bool measureRoundTrips(Transport& transport, size_t count) {
+    std::string reply;
+    LatencyHistogram latency;
+    latency.reset();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t sent = ServerStats::now();
+        if (!transport.call("Contains 500,500", reply)) return false;
+        latency.record(ServerStats::now() - sent);
+    }
+    printLatency(transport.name, latency, count, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    return true;
+}
+
+// The points of every ingest run, as "x,y\n" lines and as (x, y) doubles
+static std::string pointLines;
+static std::vector<size_t> lineEnds;
+static std::vector<double> pointCoordinates;
+
+static void makePoints(size_t n) {
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    char line[64];
+    for (size_t i = 0; i < n; ++i) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        double x = (rng % 1000000) / 1000.0, y = ((rng >> 20) % 1000000) / 1000.0;
+        snprintf(line, sizeof line, "%g,%g\n", x, y);
+        pointLines += line;
+        lineEnds.push_back(pointLines.size());
+        pointCoordinates.push_back(x);
+        pointCoordinates.push_back(y);
+    }
+}
+
+static void printIngest(const char* name, size_t points, size_t bytes, double seconds) {
+    printf("%-14s %12.2f %10.1f %10.3f\n", name, points / seconds / 1e6, bytes / seconds / 1e6, seconds);
+    fflush(stdout);
+}
+
+// Makes "bulk" the transport's current graph, empty
+static bool freshGraph(Transport& transport) {
+    std::string reply;
+    return transport.call("DropGraph bulk", reply) && transport.call("Use bulk", reply);
+}
+
+/**
+ * @brief CreateGraph N, then the point lines in chunks of at most @p chunkBytes, each waiting for its reply.
+ */
+static bool ingestLines(Transport& transport, size_t chunkBytes) {
+    std::string reply;
+    size_t n = lineEnds.size();
+    if (!freshGraph(transport)) return false;
+    auto start = std::chrono::steady_clock::now();
+    if (!transport.call("CreateGraph " + std::to_string(n), reply)) return false;
+
+    size_t begin = 0, line = 0;
+    while (line < n) {
+        size_t end = begin;
+        while (line < n && lineEnds[line] - begin <= chunkBytes) end = lineEnds[line++];
+        std::string chunk = pointLines.substr(begin, end - begin);
+        if (transport.ring != nullptr) {
+            if (!transport.ring->call(chunk.c_str(), reply)) return false;
+        } else if (!roundTrip(transport.fd, chunk, reply)) {
+            return false;
+        }
+        begin = end;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (reply.compare(0, 23, "Graph creation complete") != 0) {
+        fprintf(stderr, "%s: %s\n", transport.name, reply.c_str());
+        return false;
+    }
+    printIngest(transport.name, n, pointLines.size(), seconds);
+    return true;
+}
+
+/**
+ * @brief The points as binary ring messages, all sent before the replies are read.
+ */
+static bool ingestBinary(Transport& transport) {
+    std::string reply;
+    size_t n = pointCoordinates.size() / 2;
+    if (!freshGraph(transport)) return false;
+    auto start = std::chrono::steady_clock::now();
+    size_t messages = 0;
+    for (size_t sent = 0; sent < n; sent += RING_POINTS_CHUNK) {
+        size_t count = n - sent < RING_POINTS_CHUNK ? n - sent : RING_POINTS_CHUNK;
+        size_t queued = transport.ring->sendPoints(pointCoordinates.data() + 2 * sent, count);
+        if (queued == 0) return false;
+        messages += queued;
+    }
+    for (size_t i = 0; i < messages; ++i) {
+        if (!transport.ring->receive(reply) || reply.compare(0, 6, "Points") != 0) return false;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printIngest(transport.name, n, n * 2 * sizeof(double), seconds);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    const char* server = "../Q8_Q9/server";
+    size_t roundTrips = 20000, points = 1000000;
+    int option;
+    while ((option = getopt(argc, argv, "S:r:n:")) != -1) {
+        if (option == 'S') {
+            server = optarg;
+        } else if (option == 'r') {
+            roundTrips = (size_t)strtod(optarg, nullptr);
+        } else if (option == 'n') {
+            points = (size_t)strtod(optarg, nullptr);
+        } else {
+            fprintf(stderr, "Usage: %s [-S server_binary] [-r round_trips] [-n ingested_points]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    pid_t pid = spawnServer(server, {"-c", "double", "-p", std::to_string(BENCH_PORT), "-U", BENCH_SOCKET});
+    Transport tcp, unixSocket, ring, ringBinary;
+    tcp.name = "tcp loopback";
+    unixSocket.name = "unix socket";
+    ring.name = "shared ring";
+    ringBinary.name = "ring binary";
+    tcp.fd = connectTcp();
+    unixSocket.fd = connectUnix();
+    LocalRingClient client;
+    bool ok = tcp.fd >= 0 && unixSocket.fd >= 0 && client.connect(BENCH_SOCKET);
+    ring.ring = ringBinary.ring = &client;
+
+    // A small graph whose hull every Contains is answered from
+    std::string reply;
+    ok = ok && tcp.call("CreateGraph 4", reply) && tcp.call("0,0\n1000,0\n1000,1000\n0,1000", reply) &&
+         tcp.call("CH", reply);
+    std::vector<Transport*> textTransports = {&tcp, &unixSocket, &ring};
+
+    if (ok) {
+        printf("Contains round trips, %zu each, %d CPUs\n", roundTrips, (int)sysconf(_SC_NPROCESSORS_ONLN));
+        printf("%-14s %10s %10s %10s %12s\n", "transport", "p50_us", "p99_us", "p999_us", "calls/s");
+        for (Transport* transport : textTransports) ok = ok && measureRoundTrips(*transport, roundTrips);
+    }
+
+    if (ok) {
+        makePoints(points);
+        printf("\nIngest of %zu points (CreateGraph and point lines; binary doubles on the ring)\n", points);
+        printf("%-14s %12s %10s %10s\n", "transport", "Mpoints/s", "MB/s", "seconds");
+        ok = ingestLines(tcp, SOCKET_CHUNK) && ingestLines(unixSocket, SOCKET_CHUNK) &&
+             ingestLines(ring, RING_TEXT_CHUNK) && ingestBinary(ringBinary);
+    }
+    if (!ok) fprintf(stderr, "Benchmark failed: is %s built, and port %d free?\n", server, BENCH_PORT);
+
+    client.close();
+    if (tcp.fd >= 0) close(tcp.fd);
+    if (unixSocket.fd >= 0) close(unixSocket.fd);
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    unlink(BENCH_SOCKET);
+    return ok ? 0 : 1;
+}
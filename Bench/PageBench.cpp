@@ -0,0 +1,169 @@
+#include "../Q8_Q9/ConvexHull.hpp"
+#include "../Q8_Q9/LargePages.hpp"
+#include "../Q8_Q9/RandomPoints.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * @brief Counts data TLB misses of this process and the threads it starts, if perf allows it.
+ */
+class TlbMissCounter {
+private:
+    int fd;
+
+public:
+    TlbMissCounter() {
+        struct perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HW_CACHE;
+        attributes.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attributes.disabled = 1;
+        attributes.inherit = 1;        // Include the sort and generator worker threads
+        attributes.exclude_kernel = 1; // Allowed with perf_event_paranoid up to 2
+        attributes.exclude_hv = 1;
+        fd = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+    }
+    ~TlbMissCounter() {
+        if (fd >= 0) close(fd);
+    }
+
+    bool available() const { return fd >= 0; }
+
+    void start() {
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    // Misses since start(), or -1 if the counter is unavailable
+    long long stop() {
+        if (fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        long long count = 0;
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) return -1;
+        return count;
+    }
+};
+
+// AnonHugePages of the whole process, in bytes
+static size_t anonHugeBytes() {
+    FILE* rollup = fopen("/proc/self/smaps_rollup", "r");
+    if (!rollup) return 0;
+    char line[256];
+    size_t kilobytes = 0;
+    while (fgets(line, sizeof(line), rollup)) {
+        if (strncmp(line, "AnonHugePages:", 14) == 0) {
+            kilobytes = strtoul(line + 14, nullptr, 10);
+            break;
+        }
+    }
+    fclose(rollup);
+    return kilobytes * 1024;
+}
+
+/**
+ * @brief Times a phase and counts its TLB misses.
+ */
+struct Phase {
+    double ms;
+    long long tlbMisses;
+};
+
+template <class Function>
+static Phase measure(TlbMissCounter& counter, Function fn) {
+    counter.start();
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    Phase phase;
+    phase.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    phase.tlbMisses = counter.stop();
+    return phase;
+}
+
+static void printPhase(const char* pages, const char* numa, const char* name, size_t n, const Phase& phase,
+                       size_t hugeBytes) {
+    char misses[32];
+    if (phase.tlbMisses < 0) snprintf(misses, sizeof(misses), "n/a");
+    else snprintf(misses, sizeof(misses), "%lld", phase.tlbMisses);
+    printf("%-8s %-10s %-9s %11zu %11.1f %14s %10.1f\n", pages, numa, name, n, phase.ms, misses,
+           hugeBytes / 1048576.0);
+    fflush(stdout);
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s [-n points] [-H default,small,thp,explicit] [-N local,interleave,firsttouch]\n",
+            program);
+    exit(1);
+}
+
+// Splits a comma separated list
+static std::vector<std::string> split(const char* list) {
+    std::vector<std::string> items;
+    std::string item;
+    for (const char* c = list;; ++c) {
+        if (*c == ',' || *c == '\0') {
+            if (!item.empty()) items.push_back(item);
+            item.clear();
+            if (*c == '\0') break;
+        } else {
+            item.push_back(*c);
+        }
+    }
+    return items;
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = 50000000;
+    std::vector<std::string> pageNames = {"default", "small", "thp", "explicit"};
+    std::vector<std::string> numaNames = {"local", "interleave", "firsttouch"};
+
+    int option;
+    while ((option = getopt(argc, argv, "n:H:N:")) != -1) {
+        switch (option) {
+        case 'n': n = (size_t)strtod(optarg, nullptr); break;
+        case 'H': pageNames = split(optarg); break;
+        case 'N': numaNames = split(optarg); break;
+        default: usage(argv[0]);
+        }
+    }
+
+    TlbMissCounter counter;
+    printf("NUMA nodes: %u, dTLB counter: %s\n", LargePages::nodeCount(),
+           counter.available() ? "perf" : "unavailable (perf_event_open failed)");
+    printf("%-8s %-10s %-9s %11s %11s %14s %10s\n", "pages", "numa", "phase", "n", "ms", "dtlb_misses", "huge_mb");
+
+    for (const std::string& pageName : pageNames) {
+        PagePolicy pages;
+        if (!LargePages::parsePagePolicy(pageName.c_str(), pages)) usage(argv[0]);
+        for (const std::string& numaName : numaNames) {
+            NumaPolicy numa;
+            if (!LargePages::parseNumaPolicy(numaName.c_str(), numa)) usage(argv[0]);
+            LargePages::configure(pages, numa);
+
+            // generate covers allocation and first touch, hull the radix sort and chain
+            PointVector<float> points;
+            Phase generate = measure(counter, [&] {
+                RandomPointGenerator::generate(points, n, DISTRIBUTION_UNIFORM, 42);
+            });
+            printPhase(pageName.c_str(), numaName.c_str(), "generate", n, generate, anonHugeBytes());
+
+            size_t hullSize = 0;
+            Phase hull = measure(counter, [&] { hullSize = ConvexHullUtility::findConvexHull(points).size(); });
+            printPhase(pageName.c_str(), numaName.c_str(), "hull", n, hull, anonHugeBytes());
+            if (hullSize < 3) {
+                fprintf(stderr, "hull of %zu points is degenerate\n", n);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "../Q8_Q9/GraphEngine.hpp"
+#include "../Q8_Q9/Protocol.hpp"
+#include "../Q8_Q9/Point.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#define ROUND_TRIPS 1000000
+
+// Every heap allocation made by the process goes through these operators
+static size_t allocationCount = 0;
+
+void* operator new(size_t size) {
+    allocationCount++;
+    if (void* memory = malloc(size)) return memory;
+    throw std::bad_alloc();
+}
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+
+/**
+ * @brief One AddPoint round trip as the server performs it: its AddPoint handler, then the prompt.
+ */
+static void addPointRoundTrip(const char* command, CommandEngine& engine, ResponseBuffer& response) {
+    response.clear();
+    engine.addPointCommand(command, response);
+    response.append("\n>> ");
+}
+
+int main() {
+    const char* commands[] = {"AddPoint 1.25,-3.5\n", "AddPoint 100,200\n", "AddPoint 0.001, 7e3\n"};
+    std::unique_ptr<CommandEngine> engine(CommandEngine::create("float"));
+    engine->reservePoints(ROUND_TRIPS);
+    ResponseBuffer response;
+
+    // Single-command path
+    size_t before = allocationCount;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ROUND_TRIPS; ++i)
+        addPointRoundTrip(commands[i % 3], *engine, response);
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    size_t singleAllocations = allocationCount - before;
+
+    printf("AddPoint round trip: %.1f ns, %zu allocations over %d round trips\n",
+           elapsed / ROUND_TRIPS, singleAllocations, ROUND_TRIPS);
+
+    // Bulk path: a buffer of "x,y" lines as sent during graph creation
+    std::string block;
+    for (size_t i = 0; i < 1000; ++i)
+        block += std::to_string(i) + "," + std::to_string(i * 0.5) + "\n";
+    std::vector<Point> points;
+    points.reserve(1000);
+
+    before = allocationCount;
+    size_t parsed = 0, total = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ROUND_TRIPS / 1000; ++i) {
+        points.clear();
+        TextProtocol::parsePointLines(block.data(), block.data() + block.size(), points, 1000, parsed);
+        total += parsed;
+    }
+    elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    size_t bulkAllocations = allocationCount - before;
+
+    printf("Bulk point parse: %.1f ns/point, %zu allocations over %zu points\n",
+           elapsed / total, bulkAllocations, total);
+
+    if (singleAllocations != 0 || bulkAllocations != 0) {
+        fprintf(stderr, "FAIL: the protocol path allocated on the heap\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,193 @@
+#include "../Q8_Q9/HullQueries.hpp"
+#include "../Q8_Q9/RandomPoints.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unistd.h>
+
+#define QUERY_BATCH 4096 // Points per locateBatch call
+
+template <class T>
+using Hull = std::vector<BasicPoint<T>>;
+
+// O(h) references the indexed queries are checked against
+template <class T>
+static HullLocation locateLinear(const Hull<T>& hull, const BasicPoint<T>& point) {
+    typename BasicPoint<T>::Wide largest = hull[hull.size() - 1].cross(hull[0], point);
+    for (size_t i = 0; i + 1 < hull.size(); ++i) largest = std::max(largest, hull[i].cross(hull[i + 1], point));
+    return largest > 0 ? HULL_OUTSIDE : largest == 0 ? HULL_BOUNDARY : HULL_INSIDE;
+}
+
+template <class T>
+static typename BasicPoint<T>::Wide along(const BasicPoint<T>& point, T dx, T dy) {
+    return (typename BasicPoint<T>::Wide)point.getX() * dx + (typename BasicPoint<T>::Wide)point.getY() * dy;
+}
+
+// The ends of the run of edges the point is on or outside of
+template <class T>
+static void tangentsLinear(const Hull<T>& hull, const BasicPoint<T>& point, BasicPoint<T>& first,
+                           BasicPoint<T>& second) {
+    size_t count = hull.size();
+    auto facing = [&](size_t edge) { return hull[edge % count].cross(hull[(edge + 1) % count], point) >= 0; };
+    for (size_t edge = 0; edge < count; ++edge) {
+        if (facing(edge) && !facing(edge + count - 1)) first = hull[edge];
+        if (facing(edge) && !facing(edge + 1)) second = hull[(edge + 1) % count];
+    }
+}
+
+/**
+ * @brief Checks every query on @p hull for all integer points of a grid around it.
+ */
+template <class T>
+static bool checkHull(const Hull<T>& hull, T low, T high, T step) {
+    HullIndex<T> index;
+    index.assign(hull);
+
+    std::vector<T> xs, ys;
+    for (T x = low; x <= high; x += step)
+        for (T y = low; y <= high; y += step) {
+            xs.push_back(x);
+            ys.push_back(y);
+        }
+    std::vector<unsigned char> batch(xs.size());
+    index.locateBatch(xs.data(), ys.data(), xs.size(), batch.data());
+
+    for (size_t i = 0; i < xs.size(); ++i) {
+        BasicPoint<T> point(xs[i], ys[i]), first, second, expectedFirst, expectedSecond;
+        HullLocation expected = locateLinear(hull, point);
+        if (index.locate(point) != expected || batch[i] != expected) {
+            fprintf(stderr, "%s hull of %zu: wrong location for (%g,%g)\n", CoordinateTraits<T>::name, hull.size(),
+                    (double)xs[i], (double)ys[i]);
+            return false;
+        }
+
+        // Grid points double as directions for the extreme vertex
+        if ((xs[i] != 0 || ys[i] != 0) && index.extreme(xs[i], ys[i], first)) {
+            auto best = along(first, xs[i], ys[i]);
+            for (const BasicPoint<T>& vertex : hull) {
+                if (along(vertex, xs[i], ys[i]) > best) {
+                    fprintf(stderr, "%s hull of %zu: wrong extreme vertex for (%g,%g)\n", CoordinateTraits<T>::name,
+                            hull.size(), (double)xs[i], (double)ys[i]);
+                    return false;
+                }
+            }
+        }
+
+        bool found = index.tangents(point, first, second);
+        if (found != (expected == HULL_OUTSIDE)) {
+            fprintf(stderr, "%s hull of %zu: tangents %s for (%g,%g)\n", CoordinateTraits<T>::name, hull.size(),
+                    found ? "reported" : "missing", (double)xs[i], (double)ys[i]);
+            return false;
+        }
+        if (!found) continue;
+        tangentsLinear(hull, point, expectedFirst, expectedSecond);
+        if (first != expectedFirst || second != expectedSecond) {
+            fprintf(stderr, "%s hull of %zu: wrong tangents for (%g,%g)\n", CoordinateTraits<T>::name, hull.size(),
+                    (double)xs[i], (double)ys[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Small integer grids give hulls with vertical edges, many collinear and boundary queries
+static bool checkAgainstBruteForce() {
+    std::mt19937_64 rng(7);
+    for (int round = 0; round < 2000; ++round) {
+        int span = 2 + round % 12;
+        PointVector<int32_t> points;
+        for (int i = 0, n = 3 + rng() % 20; i < n; ++i) points.emplace_back(rng() % span, rng() % span);
+        Hull<int32_t> hull = IntConvexHull::findConvexHull(points);
+        if (hull.size() >= 3 && !checkHull<int32_t>(hull, -2, span + 2, 1)) return false;
+    }
+
+    PointVector<float> points;
+    RandomPointGenerator::generate(points, 200, DISTRIBUTION_NORMAL, 3);
+    for (BasicPoint<float>& point : points) point = BasicPoint<float>(point.getX() * 8, point.getY() * 8);
+    Hull<float> floatHull = ConvexHullUtility::findConvexHull(points);
+    return checkHull<float>(floatHull, -40, 40, 0.25f);
+}
+
+// Integer points on a circle, so every one of them is a hull vertex
+static Hull<int32_t> circleHull(size_t vertices) {
+    PointVector<int32_t> points;
+    for (size_t i = 0; i < vertices; ++i) {
+        double angle = 2 * M_PI * i / vertices;
+        points.emplace_back((int32_t)lround(1e8 * cos(angle)), (int32_t)lround(1e8 * sin(angle)));
+    }
+    return IntConvexHull::findConvexHull(points);
+}
+
+template <class Function>
+static double nsPerQuery(size_t queries, Function query) {
+    auto start = std::chrono::steady_clock::now();
+    query();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / queries;
+}
+
+/**
+ * @brief Times each query against the O(h) scan it replaces, on random points around the hull.
+ */
+static void measure(size_t vertices, size_t queries) {
+    Hull<int32_t> hull = circleHull(vertices);
+    HullIndex<int32_t> index;
+    index.assign(hull);
+
+    std::mt19937_64 rng(9);
+    std::uniform_int_distribution<int32_t> coordinate(-150000000, 150000000);
+    std::vector<int32_t> xs(queries), ys(queries);
+    for (size_t i = 0; i < queries; ++i) {
+        xs[i] = coordinate(rng);
+        ys[i] = coordinate(rng);
+    }
+
+    size_t sink = 0;
+    double scan = nsPerQuery(queries, [&] {
+        for (size_t i = 0; i < queries; ++i) sink += locateLinear(hull, IntPoint(xs[i], ys[i]));
+    });
+    double locate = nsPerQuery(queries, [&] {
+        for (size_t i = 0; i < queries; ++i) sink += index.locate(IntPoint(xs[i], ys[i]));
+    });
+    std::vector<unsigned char> locations(QUERY_BATCH);
+    double batch = nsPerQuery(queries, [&] {
+        for (size_t base = 0; base < queries; base += QUERY_BATCH) {
+            size_t count = std::min<size_t>(QUERY_BATCH, queries - base);
+            index.locateBatch(xs.data() + base, ys.data() + base, count, locations.data());
+            sink += locations[0];
+        }
+    });
+    IntPoint first, second;
+    double extreme = nsPerQuery(queries, [&] {
+        for (size_t i = 0; i < queries; ++i) sink += index.extreme(xs[i], ys[i], first) ? first.getX() : 0;
+    });
+    double tangents = nsPerQuery(queries, [&] {
+        for (size_t i = 0; i < queries; ++i) sink += index.tangents(IntPoint(xs[i], ys[i]), first, second);
+    });
+
+    printf("%9zu %12.1f %12.1f %12.1f %12.1f %12.1f\n", hull.size(), scan, locate, batch, extreme, tangents);
+    fflush(stdout);
+    if (sink == 1) printf("\n"); // Keeps the loops from being optimized away
+}
+
+int main(int argc, char* argv[]) {
+    size_t queries = 1000000;
+    int option;
+    while ((option = getopt(argc, argv, "q:")) != -1) {
+        if (option == 'q') {
+            queries = (size_t)strtod(optarg, nullptr);
+        } else {
+            fprintf(stderr, "Usage: %s [-q queries]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (!checkAgainstBruteForce()) return 1;
+    printf("hull queries match brute force\n");
+
+    printf("%9s %12s %12s %12s %12s %12s\n", "hull", "scan_ns", "locate_ns", "batch_ns", "extreme_ns",
+           "tangents_ns");
+    for (size_t vertices : {8, 16, 32, 256, 4096, 65536}) measure(vertices, queries);
+    return 0;
+}
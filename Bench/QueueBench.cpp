@@ -0,0 +1,115 @@
+#include "../Q8_Q9/CommandQueue.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+/**
+ * @brief Stand-in for the graph: every command appends a point and the sum is checked at the end.
+ */
+struct SharedState {
+    std::vector<long> points;
+    long sum = 0;
+
+    void apply(long value) {
+        points.push_back(value);
+        if (points.size() > 4096) points.clear();
+        sum += value;
+    }
+};
+
+template <class Function>
+static double seconds(Function run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static long expectedSum(size_t producers, size_t commands) {
+    return (long)producers * (long)(commands * (commands + 1) / 2);
+}
+
+// Every producer locks the mutex for each of its commands
+static double runMutex(size_t producers, size_t commands) {
+    SharedState state;
+    std::mutex mutex;
+    double elapsed = seconds([&] {
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; ++p)
+            threads.emplace_back([&] {
+                for (size_t i = 1; i <= commands; ++i) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    state.apply((long)i);
+                }
+            });
+        for (std::thread& thread : threads) thread.join();
+    });
+    if (state.sum != expectedSum(producers, commands)) fprintf(stderr, "mutex: wrong sum\n");
+    return elapsed;
+}
+
+// Every producer submits its commands to one owner thread, as the servers' -A mode does
+static double runQueue(size_t producers, size_t commands, double& averageBatch) {
+    SharedState state;
+    CommandQueue queue;
+    size_t batches = 0, executed = 0, total = producers * commands;
+
+    std::thread owner([&] {
+        QueuedCommand* batch[COMMAND_BATCH_SIZE];
+        while (executed < total) {
+            size_t count = queue.popBatch(batch, COMMAND_BATCH_SIZE);
+            for (size_t i = 0; i < count; ++i) {
+                state.apply((long)batch[i]->length);
+                batch[i]->done.complete();
+            }
+            executed += count;
+            batches++;
+        }
+    });
+
+    double elapsed = seconds([&] {
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; ++p)
+            threads.emplace_back([&] {
+                QueuedCommand command;
+                for (size_t i = 1; i <= commands; ++i) {
+                    command.length = i;
+                    queue.submit(command);
+                }
+            });
+        for (std::thread& thread : threads) thread.join();
+    });
+    owner.join();
+
+    if (state.sum != expectedSum(producers, commands)) fprintf(stderr, "queue: wrong sum\n");
+    averageBatch = (double)executed / batches;
+    return elapsed;
+}
+
+int main(int argc, char* argv[]) {
+    size_t commands = 20000;
+    int option;
+    while ((option = getopt(argc, argv, "n:")) != -1) {
+        if (option == 'n') {
+            commands = strtoul(optarg, nullptr, 10);
+        } else {
+            fprintf(stderr, "Usage: %s [-n commands_per_producer]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("%d hardware threads\n", (int)std::thread::hardware_concurrency());
+    printf("%9s %14s %14s %12s\n", "producers", "mutex_ns/cmd", "queue_ns/cmd", "avg_batch");
+    for (size_t producers : {1, 2, 4, 8, 16, 64}) {
+        double averageBatch;
+        double mutex = runMutex(producers, commands);
+        double queue = runQueue(producers, commands, averageBatch);
+        double total = (double)producers * commands;
+        printf("%9zu %14.1f %14.1f %12.1f\n", producers, mutex / total * 1e9, queue / total * 1e9, averageBatch);
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,256 @@
+#include "../Q8_Q9/Stats.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define LEADER_PORT 9500 // Followers listen on the ports after it
+#define UPLOAD_CHUNK 900 // Bytes of point lines per message; the server reads up to 1023 at a time
+
+/**
+ * @brief Starts "server args..." with its output discarded.
+ */
+static pid_t spawnServer(const char* path, const std::vector<std::string>& args) {
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+
+    int devNull = open("/dev/null", O_WRONLY);
+    dup2(devNull, STDOUT_FILENO);
+    dup2(devNull, STDERR_FILENO);
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(path));
+    for (const std::string& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+    execv(path, argv.data());
+    _exit(127);
+}
+
+static void stopServers(std::vector<pid_t>& pids) {
+    for (pid_t pid : pids) kill(pid, SIGKILL);
+    for (pid_t pid : pids) waitpid(pid, nullptr, 0);
+    pids.clear();
+}
+
+// Retries until the server listens, and reads its greeting
+static int connectWhenReady(int port) {
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof address);
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(fd, (struct sockaddr*)&address, sizeof address) == 0) {
+            int yes = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+            char greeting[3];
+            if (recv(fd, greeting, sizeof greeting, MSG_WAITALL) == sizeof greeting) return fd;
+        }
+        close(fd);
+        usleep(50000);
+    }
+    return -1;
+}
+
+// Sends a request and reads up to the ">> " prompt that ends the reply
+static bool roundTrip(int fd, const std::string& request, std::string& reply) {
+    if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size()) return false;
+    reply.clear();
+    char buffer[4096];
+    while (reply.size() < 3 || reply.compare(reply.size() - 3, 3, ">> ") != 0) {
+        ssize_t received = recv(fd, buffer, sizeof buffer, 0);
+        if (received <= 0) return false;
+        reply.append(buffer, received);
+    }
+    return true;
+}
+
+static bool upload(int fd, size_t n) {
+    std::string reply, chunk;
+    if (!roundTrip(fd, "CreateGraph " + std::to_string(n) + "\n", reply)) return false;
+
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    char line[64];
+    for (size_t i = 0; i < n; ++i) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        snprintf(line, sizeof line, "%g,%g\n", (rng % 1000000) / 1000.0, ((rng >> 20) % 1000000) / 1000.0);
+        if (chunk.size() + strlen(line) > UPLOAD_CHUNK) {
+            if (!roundTrip(fd, chunk, reply)) return false;
+            chunk.clear();
+        }
+        chunk += line;
+    }
+    return roundTrip(fd, chunk, reply) && reply.compare(0, 23, "Graph creation complete") == 0;
+}
+
+/**
+ * @brief Result of one run: reads spread over the read servers, writes to the leader.
+ */
+struct RunResult {
+    size_t reads = 0;
+    size_t writes = 0;
+    LatencyHistogram readLatency;
+    bool ok = true;
+};
+
+/**
+ * @brief @p readers clients send Contains queries round-robin over @p readPorts while one
+ * client adds a point to the leader @p writeRate times a second, each write making the
+ * hull stale everywhere once it is replicated.
+ */
+static RunResult measure(const std::vector<int>& readPorts, size_t readers, size_t writeRate, double seconds) {
+    RunResult result;
+    result.readLatency.reset();
+    std::vector<LatencyHistogram> latencies(readers);
+    std::vector<size_t> counts(readers, 0);
+    std::atomic<bool> failed(false);
+    uint64_t deadline = ServerStats::now() + (uint64_t)(seconds * 1e9);
+
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r] {
+            latencies[r].reset();
+            int fd = connectWhenReady(readPorts[r % readPorts.size()]);
+            if (fd < 0) {
+                failed = true;
+                return;
+            }
+            std::mt19937 random((unsigned int)r);
+            std::string reply;
+            char request[64];
+            while (ServerStats::now() < deadline) {
+                snprintf(request, sizeof request, "Contains %u,%u\n", (unsigned int)(random() % 1000), (unsigned int)(random() % 1000));
+                uint64_t start = ServerStats::now();
+                if (!roundTrip(fd, request, reply)) {
+                    failed = true;
+                    break;
+                }
+                latencies[r].record(ServerStats::now() - start);
+                counts[r]++;
+            }
+            close(fd);
+        });
+    }
+
+    int writer = connectWhenReady(LEADER_PORT);
+    std::string reply;
+    uint64_t interval = writeRate > 0 ? 1000000000 / writeRate : 0;
+    for (uint64_t next = ServerStats::now(); writer >= 0 && writeRate > 0 && next < deadline; next += interval) {
+        uint64_t now = ServerStats::now();
+        if (next > now) usleep((next - now) / 1000);
+        std::string request = "AddPoint " + std::to_string(result.writes % 1000) + ",500\n";
+        if (!roundTrip(writer, request, reply)) {
+            failed = true;
+            break;
+        }
+        result.writes++;
+    }
+    for (std::thread& thread : threads) thread.join();
+    if (writer >= 0) close(writer);
+
+    for (size_t r = 0; r < readers; ++r) {
+        result.readLatency.merge(latencies[r]);
+        result.reads += counts[r];
+    }
+    result.ok = writer >= 0 && !failed;
+    return result;
+}
+
+// Waits until every follower has applied what the leader holds
+static bool waitForFollowers(const std::vector<int>& followerPorts) {
+    int leader = connectWhenReady(LEADER_PORT);
+    std::string version, reply;
+    bool ok = leader >= 0 && roundTrip(leader, "Version\n", version);
+    if (leader >= 0) close(leader);
+    if (!ok) return false;
+    std::string target = version.substr(9, version.find('\n') - 9);
+    for (int port : followerPorts) {
+        int fd = connectWhenReady(port);
+        ok = ok && fd >= 0 && roundTrip(fd, "WaitVersion " + target + " 30000\n", reply) && reply.compare(0, 8, "Version:") == 0;
+        if (fd >= 0) close(fd);
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    const char* server = "../Q8_Q9/server";
+    size_t n = 10000, readers = 16, writeRate = 50, maxFollowers = 4;
+    double seconds = 3;
+    int option;
+    while ((option = getopt(argc, argv, "S:n:c:w:t:k:")) != -1) {
+        switch (option) {
+        case 'S': server = optarg; break;
+        case 'n': n = (size_t)strtod(optarg, nullptr); break;
+        case 'c': readers = (size_t)strtod(optarg, nullptr); break;
+        case 'w': writeRate = (size_t)strtod(optarg, nullptr); break;
+        case 't': seconds = strtod(optarg, nullptr); break;
+        case 'k': maxFollowers = (size_t)strtod(optarg, nullptr); break;
+        default:
+            fprintf(stderr, "Usage: %s [-S server_binary] [-n points] [-c readers] [-w writes_per_second] "
+                            "[-t seconds] [-k max_followers]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    char logDirectory[] = "/tmp/replica_bench.XXXXXX";
+    if (mkdtemp(logDirectory) == nullptr) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    printf("Contains reads from %zu clients, %zu AddPoint/s to the leader, %zu points, %d CPUs\n", readers,
+           writeRate, n, (int)sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-12s %12s %10s %10s %10s\n", "reads from", "reads/s", "p50_us", "p99_us", "writes/s");
+    std::vector<pid_t> pids;
+    pids.push_back(spawnServer(server, {"-p", std::to_string(LEADER_PORT), "-L", logDirectory}));
+    int leader = connectWhenReady(LEADER_PORT);
+    bool ok = leader >= 0 && upload(leader, n);
+    if (leader >= 0) close(leader);
+
+    for (size_t followers = 0; ok && followers <= maxFollowers; followers = followers == 0 ? 1 : followers * 2) {
+        std::vector<pid_t> followerPids;
+        std::vector<int> readPorts;
+        for (size_t f = 1; f <= followers; ++f) {
+            followerPids.push_back(spawnServer(server, {"-p", std::to_string(LEADER_PORT + f), "-F",
+                                                        std::to_string(LEADER_PORT)}));
+            readPorts.push_back(LEADER_PORT + (int)f);
+        }
+        if (followers == 0) readPorts.push_back(LEADER_PORT);
+        else ok = waitForFollowers(readPorts);
+
+        RunResult result;
+        if (ok) result = measure(readPorts, readers, writeRate, seconds);
+        stopServers(followerPids);
+        ok = ok && result.ok;
+        if (!ok) {
+            fprintf(stderr, "Run with %zu followers failed\n", followers);
+            break;
+        }
+
+        char setup[32];
+        if (followers == 0) snprintf(setup, sizeof setup, "leader");
+        else snprintf(setup, sizeof setup, "%zu follower%s", followers, followers == 1 ? "" : "s");
+        printf("%-12s %12.0f %10.1f %10.1f %10.0f\n", setup, result.reads / seconds,
+               result.readLatency.quantile(0.5) / 1e3, result.readLatency.quantile(0.99) / 1e3,
+               result.writes / seconds);
+        fflush(stdout);
+    }
+
+    stopServers(pids);
+    if (system((std::string("rm -rf ") + logDirectory).c_str()) != 0) return 1;
+    return ok ? 0 : 1;
+}
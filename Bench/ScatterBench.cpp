@@ -0,0 +1,183 @@
+#include "../Q8_Q9/Stats.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define COORDINATOR_PORT 9300 // Shards listen on the ports after it
+#define UPLOAD_CHUNK 900      // Bytes of point lines per message; the server reads up to 1023 at a time
+
+/**
+ * @brief Starts "server args..." with its output discarded.
+ */
+static pid_t spawnServer(const char* path, const std::vector<std::string>& args) {
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+
+    int devNull = open("/dev/null", O_WRONLY);
+    dup2(devNull, STDOUT_FILENO);
+    dup2(devNull, STDERR_FILENO);
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(path));
+    for (const std::string& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+    execv(path, argv.data());
+    _exit(127);
+}
+
+static void stopServers(std::vector<pid_t>& pids) {
+    for (pid_t pid : pids) kill(pid, SIGKILL);
+    for (pid_t pid : pids) waitpid(pid, nullptr, 0);
+    pids.clear();
+}
+
+// Retries until the server listens, and reads its greeting
+static int connectWhenReady(int port) {
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof address);
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(fd, (struct sockaddr*)&address, sizeof address) == 0) {
+            int yes = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+            char greeting[3];
+            if (recv(fd, greeting, sizeof greeting, MSG_WAITALL) == sizeof greeting) return fd;
+        }
+        close(fd);
+        usleep(50000);
+    }
+    return -1;
+}
+
+// Sends a request and reads up to the ">> " prompt that ends the reply
+static bool roundTrip(int fd, const std::string& request, std::string& reply) {
+    if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size()) return false;
+    reply.clear();
+    char buffer[4096];
+    while (reply.size() < 3 || reply.compare(reply.size() - 3, 3, ">> ") != 0) {
+        ssize_t received = recv(fd, buffer, sizeof buffer, 0);
+        if (received <= 0) return false;
+        reply.append(buffer, received);
+    }
+    return true;
+}
+
+static bool upload(int fd, size_t n) {
+    std::string reply, chunk;
+    if (!roundTrip(fd, "CreateGraph " + std::to_string(n) + "\n", reply)) return false;
+
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    char line[64];
+    for (size_t i = 0; i < n; ++i) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        snprintf(line, sizeof line, "%g,%g\n", (rng % 1000000) / 1000.0, ((rng >> 20) % 1000000) / 1000.0);
+        if (chunk.size() + strlen(line) > UPLOAD_CHUNK) {
+            if (!roundTrip(fd, chunk, reply)) return false;
+            chunk.clear();
+        }
+        chunk += line;
+    }
+    return roundTrip(fd, chunk, reply) && reply.compare(0, 23, "Graph creation complete") == 0;
+}
+
+/**
+ * @brief Uploads the points to @p port, then times CH round trips: back to back, when the
+ * servers can answer from the hull they cached, and each after an (untimed) AddPoint that
+ * makes them compute it again. The area is kept for comparison.
+ */
+static bool measure(int port, size_t n, size_t queries, LatencyHistogram& cached, LatencyHistogram& changed,
+                    std::string& area) {
+    int fd = connectWhenReady(port);
+    if (fd < 0 || !upload(fd, n)) return false;
+
+    std::string reply;
+    cached.reset();
+    changed.reset();
+    for (size_t q = 0; q < 2 * queries; ++q) {
+        bool afterWrite = q >= queries;
+        if (afterWrite && !roundTrip(fd, "AddPoint 500,500\n", reply)) return false;
+        uint64_t start = ServerStats::now();
+        if (!roundTrip(fd, "CH\n", reply)) return false;
+        (afterWrite ? changed : cached).record(ServerStats::now() - start);
+    }
+    area = reply.substr(0, reply.find('\n'));
+    close(fd);
+    return true;
+}
+
+static void printRow(const char* setup, const LatencyHistogram& cached, const LatencyHistogram& changed,
+                     const std::string& area) {
+    printf("%-14s %10.1f %10.1f %10.1f %10.1f  %s\n", setup, cached.quantile(0.5) / 1e3, cached.quantile(0.99) / 1e3,
+           changed.quantile(0.5) / 1e3, changed.quantile(0.99) / 1e3, area.c_str());
+    fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+    const char* server = "../Q8_Q9/server";
+    size_t n = 200000, queries = 200, maxShards = 8;
+    int option;
+    while ((option = getopt(argc, argv, "S:n:q:k:")) != -1) {
+        switch (option) {
+        case 'S': server = optarg; break;
+        case 'n': n = (size_t)strtod(optarg, nullptr); break;
+        case 'q': queries = (size_t)strtod(optarg, nullptr); break;
+        case 'k': maxShards = (size_t)strtod(optarg, nullptr); break;
+        default:
+            fprintf(stderr, "Usage: %s [-S server_binary] [-n points] [-q ch_requests] [-k max_shards]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("End-to-end CH latency in us, %zu points, %zu requests each, %d CPUs\n", n, queries,
+           (int)sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-14s %10s %10s %10s %10s\n", "", "cached_p50", "cached_p99", "write_p50", "write_p99");
+    std::vector<pid_t> pids;
+    LatencyHistogram cached, changed;
+    std::string area;
+
+    // One server holding every point, as the baseline
+    pids.push_back(spawnServer(server, {"-p", std::to_string(COORDINATOR_PORT)}));
+    bool ok = measure(COORDINATOR_PORT, n, queries, cached, changed, area);
+    stopServers(pids);
+    if (!ok) {
+        fprintf(stderr, "Cannot run %s\n", server);
+        return 1;
+    }
+    printRow("single server", cached, changed, area);
+
+    for (size_t shards = 1; shards <= maxShards; shards *= 2) {
+        std::string list;
+        for (size_t s = 1; s <= shards; ++s) {
+            std::string port = std::to_string(COORDINATOR_PORT + s);
+            pids.push_back(spawnServer(server, {"-p", port}));
+            list += (s > 1 ? "," : "") + port;
+        }
+        for (size_t s = 1; s <= shards; ++s) close(connectWhenReady(COORDINATOR_PORT + s));
+        pids.push_back(spawnServer(server, {"-p", std::to_string(COORDINATOR_PORT), "-S", list}));
+
+        ok = measure(COORDINATOR_PORT, n, queries, cached, changed, area);
+        stopServers(pids);
+        if (!ok) {
+            fprintf(stderr, "Coordinator with %zu shards failed\n", shards);
+            return 1;
+        }
+        char setup[32];
+        snprintf(setup, sizeof setup, "%zu shard%s", shards, shards == 1 ? "" : "s");
+        printRow(setup, cached, changed, area);
+    }
+    return 0;
+}
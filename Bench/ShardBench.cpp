@@ -0,0 +1,106 @@
+#include "../Q8_Q9/RandomPoints.hpp"
+#include "../Q8_Q9/ShardedHull.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <unistd.h>
+
+/**
+ * @brief One step of the workload: add a point, remove a point, or ask for the hull.
+ */
+struct Operation {
+    enum Kind { ADD, REMOVE, HULL } kind;
+    Point point;
+};
+
+/**
+ * @brief Writes with one hull request after every @p writesPerHull of them. A quarter of
+ * the writes remove a point that is in the graph, the rest add a new one.
+ */
+static std::vector<Operation> makeWorkload(const PointVector<float>& preload, size_t writes, size_t writesPerHull,
+                                           uint64_t seed) {
+    PointVector<float> added;
+    RandomPointGenerator::generate(added, writes, DISTRIBUTION_DISK, seed);
+    std::mt19937_64 random(seed);
+    std::vector<Operation> operations;
+    for (size_t i = 0; i < writes; ++i) {
+        if (random() % 4 == 0) operations.push_back({Operation::REMOVE, preload[random() % preload.size()]});
+        else operations.push_back({Operation::ADD, added[i]});
+        if ((i + 1) % writesPerHull == 0) operations.push_back({Operation::HULL, Point()});
+    }
+    return operations;
+}
+
+// The stored graph: a point vector, removal by scan and a full hull on every request
+static double runStored(const PointVector<float>& preload, const std::vector<Operation>& operations, double& area) {
+    PointVector<float> points(preload.begin(), preload.end());
+    auto start = std::chrono::steady_clock::now();
+    for (const Operation& operation : operations) {
+        if (operation.kind == Operation::ADD) {
+            points.push_back(operation.point);
+        } else if (operation.kind == Operation::REMOVE) {
+            for (size_t i = 0; i < points.size(); ++i) {
+                if (points[i].getX() == operation.point.getX() && points[i].getY() == operation.point.getY()) {
+                    points[i] = points.back();
+                    points.pop_back();
+                    break;
+                }
+            }
+        } else {
+            area = ConvexHullUtility::computeEnclosedArea(ConvexHullUtility::findConvexHull(points));
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double runSharded(size_t shards, const PointVector<float>& preload, const std::vector<Operation>& operations,
+                         double& area) {
+    ShardedHull<float> sharded(shards);
+    for (const Point& point : preload) sharded.insert(point);
+    sharded.hull();
+
+    auto start = std::chrono::steady_clock::now();
+    for (const Operation& operation : operations) {
+        if (operation.kind == Operation::ADD) sharded.insert(operation.point);
+        else if (operation.kind == Operation::REMOVE) sharded.remove(operation.point);
+        else area = ConvexHullUtility::computeEnclosedArea(sharded.hull());
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = 100000, writes = 20000;
+    int option;
+    while ((option = getopt(argc, argv, "n:w:")) != -1) {
+        if (option == 'n') {
+            n = (size_t)strtod(optarg, nullptr);
+        } else if (option == 'w') {
+            writes = (size_t)strtod(optarg, nullptr);
+        } else {
+            fprintf(stderr, "Usage: %s [-n preloaded_points] [-w writes]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    PointVector<float> preload;
+    RandomPointGenerator::generate(preload, n, DISTRIBUTION_DISK, 1);
+    printf("%d hardware threads, %zu points preloaded, %zu writes per run (1/4 removals)\n",
+           (int)std::thread::hardware_concurrency(), n, writes);
+    printf("%13s %8s %12s %12s\n", "writes/hull", "shards", "kops/s", "speedup");
+
+    for (size_t writesPerHull : {10, 100, 1000}) {
+        std::vector<Operation> operations = makeWorkload(preload, writes, writesPerHull, 2);
+        double expected = 0, area = 0;
+        double stored = runStored(preload, operations, expected);
+        printf("%13zu %8s %12.1f %12s\n", writesPerHull, "stored", operations.size() / stored / 1e3, "1.00");
+        for (size_t shards : {1, 2, 4, 8}) {
+            double seconds = runSharded(shards, preload, operations, area);
+            printf("%13zu %8zu %12.1f %12.2f%s\n", writesPerHull, shards, operations.size() / seconds / 1e3,
+                   stored / seconds, area == expected ? "" : "  AREA MISMATCH");
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "../Q8_Q9/PointSort.hpp"
+#include "../Q8_Q9/RandomPoints.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+/**
+ * @brief Milliseconds taken by one sort of a fresh copy of @p input.
+ */
+template <class T, class Sort>
+static double timeSort(const PointVector<T>& input, PointVector<T>& output, Sort sort) {
+    output = input;
+    auto start = std::chrono::steady_clock::now();
+    sort(output);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <class T>
+static bool compare(size_t n, PointDistribution distribution, const char* distributionName,
+                    unsigned int threads, int repetitions) {
+    PointVector<T> input, expected, sorted;
+    RandomPointGenerator::generate(input, n, distribution, 42);
+
+    double bestStd = 1e300, bestRadix = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        bestStd = std::min(bestStd, timeSort(input, expected, [](PointVector<T>& points) {
+            std::sort(points.begin(), points.end());
+        }));
+        bestRadix = std::min(bestRadix, timeSort(input, sorted, [threads](PointVector<T>& points) {
+            PointSorter::radixSort(points, threads);
+        }));
+    }
+
+    bool match = (expected == sorted);
+    printf("%-6s %-10s %11zu %7u %12.1f %12.1f %8.2fx %s\n", CoordinateTraits<T>::name, distributionName, n,
+           threads, bestStd, bestRadix, bestStd / bestRadix, match ? "ok" : "MISMATCH");
+    fflush(stdout);
+    return match;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s [-n sizes] [-t threads] [-r repetitions]\n"
+                    "  -n comma separated sizes (default 1e6,1e7,1e8)\n", program);
+    exit(1);
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<size_t> sizes = {1000000, 10000000, 100000000};
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    int repetitions = 3;
+
+    int option;
+    while ((option = getopt(argc, argv, "n:t:r:")) != -1) {
+        switch (option) {
+        case 'n': {
+            sizes.clear();
+            char* cursor = optarg;
+            while (*cursor) {
+                sizes.push_back((size_t)strtod(cursor, &cursor));
+                if (*cursor == ',') cursor++;
+                else if (*cursor) usage(argv[0]);
+            }
+            break;
+        }
+        case 't': threads = std::max(1, atoi(optarg)); break;
+        case 'r': repetitions = std::max(1, atoi(optarg)); break;
+        default: usage(argv[0]);
+        }
+    }
+
+    printf("%-6s %-10s %11s %7s %12s %12s %9s\n", "type", "dist", "n", "threads", "std_ms", "radix_ms", "speedup");
+    bool ok = true;
+    for (size_t n : sizes) {
+        ok &= compare<float>(n, DISTRIBUTION_UNIFORM, "uniform", threads, repetitions);
+        ok &= compare<float>(n, DISTRIBUTION_CLUSTERED, "clustered", threads, repetitions);
+        ok &= compare<int32_t>(n, DISTRIBUTION_UNIFORM, "uniform", threads, repetitions);
+    }
+    return ok ? 0 : 1;
+}
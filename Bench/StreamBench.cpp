@@ -0,0 +1,157 @@
+#include "../Q8_Q9/RandomPoints.hpp"
+#include "../Q8_Q9/StreamingHull.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#define WRITE_CHUNK_POINTS (1 << 22)
+
+// Reads a "Field:  <n> kB" line of /proc/self/status, in bytes
+static size_t statusBytes(const char* field) {
+    FILE* status = fopen("/proc/self/status", "r");
+    if (!status) return 0;
+    char line[256];
+    size_t kilobytes = 0, fieldLength = strlen(field);
+    while (fgets(line, sizeof(line), status)) {
+        if (strncmp(line, field, fieldLength) == 0) {
+            kilobytes = strtoul(line + fieldLength, nullptr, 10);
+            break;
+        }
+    }
+    fclose(status);
+    return kilobytes * 1024;
+}
+
+/**
+ * @brief Writes n uniform points in chunks, so the generator never holds more than one chunk.
+ */
+static bool writePointFile(const char* path, size_t n, uint64_t seed) {
+    FILE* out = fopen(path, "wb");
+    if (!out) return false;
+    PointVector<float> chunk;
+    for (size_t written = 0, index = 0; written < n; written += chunk.size(), ++index) {
+        RandomPointGenerator::generate(chunk, std::min<size_t>(WRITE_CHUNK_POINTS, n - written),
+                                       DISTRIBUTION_DISK, seed + index);
+        if (fwrite(chunk.data(), sizeof(Point), chunk.size(), out) != chunk.size()) {
+            fclose(out);
+            return false;
+        }
+    }
+    return fclose(out) == 0;
+}
+
+// Hull of the whole file loaded into memory, for checking the streamed result
+static bool inMemoryHull(const char* path, size_t n, std::vector<Point>& hull) {
+    FILE* in = fopen(path, "rb");
+    if (!in) return false;
+    PointVector<float> points(n);
+    bool complete = fread(points.data(), sizeof(Point), n, in) == n;
+    fclose(in);
+    if (complete) hull = ConvexHullUtility::findConvexHull(points);
+    return complete;
+}
+
+/**
+ * @brief Feeds the file through IncrementalHull::insert one point at a time, as a
+ * streaming graph receives AddPoint, and reports the cost and the most points held.
+ */
+static bool onlineHull(const char* path, std::vector<Point>& hull) {
+    FILE* in = fopen(path, "rb");
+    if (!in) return false;
+    IncrementalHull<float> running;
+    std::vector<Point> block(STREAM_BLOCK_POINTS);
+    size_t maxRetained = 0, read;
+    auto start = std::chrono::steady_clock::now();
+    while ((read = fread(block.data(), sizeof(Point), block.size(), in)) > 0) {
+        for (size_t i = 0; i < read; ++i) {
+            running.insert(block[i]);
+            maxRetained = std::max(maxRetained, running.retained());
+        }
+    }
+    fclose(in);
+    running.flush();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    hull = running.hull();
+    printf("online insert of %zu points: %.1f ns/point, at most %zu points held, hull %zu\n",
+           running.pointCount(), seconds * 1e9 / running.pointCount(), maxRetained, hull.size());
+    return true;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s [-n points] [-b block_points] [-f file] [-k] [-a] [-v]\n"
+                    "  -a also insert the points one at a time, as a streaming graph does\n"
+                    "  -k keep an existing file instead of rewriting it\n"
+                    "  -v also load the whole file and compare hulls (needs n * 16 bytes)\n", program);
+    exit(1);
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = 100000000, blockPoints = STREAM_BLOCK_POINTS;
+    const char* path = "/tmp/stream_bench.points";
+    bool keep = false, verify = false, online = false;
+
+    int option;
+    while ((option = getopt(argc, argv, "n:b:f:kav")) != -1) {
+        switch (option) {
+        case 'n': n = (size_t)strtod(optarg, nullptr); break;
+        case 'b': blockPoints = (size_t)strtod(optarg, nullptr); break;
+        case 'f': path = optarg; break;
+        case 'k': keep = true; break;
+        case 'a': online = true; break;
+        case 'v': verify = true; break;
+        default: usage(argv[0]);
+        }
+    }
+
+    if (!keep || access(path, R_OK) != 0) {
+        auto start = std::chrono::steady_clock::now();
+        if (!writePointFile(path, n, 7)) {
+            perror(path);
+            return 1;
+        }
+        printf("wrote %zu points (%.0f MB) in %.1f s\n", n, n * sizeof(Point) / 1e6,
+               std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    size_t rssBefore = statusBytes("VmRSS:");
+    std::vector<Point> hull;
+    size_t pointCount;
+    auto start = std::chrono::steady_clock::now();
+    if (!PointFileHull<float>::compute(path, hull, pointCount, blockPoints)) {
+        perror(path);
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t peak = statusBytes("VmHWM:");
+
+    printf("streamed %zu points, block %zu: %.2f s, %.0f MB/s, hull %zu, area %.9g\n", pointCount, blockPoints,
+           seconds, pointCount * sizeof(Point) / 1e6 / seconds, hull.size(),
+           ConvexHullUtility::computeEnclosedArea(hull));
+    printf("peak RSS %.1f MB (%.1f MB before streaming)\n", peak / 1048576.0, rssBefore / 1048576.0);
+
+    if (online) {
+        std::vector<Point> onlineResult;
+        if (!onlineHull(path, onlineResult)) {
+            perror(path);
+            return 1;
+        }
+        if (onlineResult != hull) {
+            printf("online hull: MISMATCH\n");
+            return 1;
+        }
+    }
+
+    if (verify) {
+        std::vector<Point> expected;
+        if (!inMemoryHull(path, pointCount, expected)) {
+            perror(path);
+            return 1;
+        }
+        bool match = (expected == hull);
+        printf("in-memory hull %zu vertices: %s\n", expected.size(), match ? "match" : "MISMATCH");
+        return match ? 0 : 1;
+    }
+    return 0;
+}
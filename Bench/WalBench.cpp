@@ -0,0 +1,154 @@
+#include "../Q8_Q9/GraphRegistry.hpp"
+#include "../Q8_Q9/Stats.hpp"
+#include "../Q8_Q9/WriteAheadLog.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#define BULK_RECORD_POINTS 50 // About what one GraphPoints message of the text protocol carries
+
+static std::string benchDirectory;
+
+// A fresh, empty log directory for each run
+static std::string runDirectory(const char* name) {
+    std::string path = benchDirectory + "/" + name;
+    if (system(("rm -rf '" + path + "'").c_str()) != 0) return path;
+    mkdir(path.c_str(), 0755);
+    return path;
+}
+
+// recover() reports what it found on stdout, which would break up the tables
+static bool quietRecover(WriteAheadLog& log, GraphRegistry& registry) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int devNull = open("/dev/null", O_WRONLY);
+    dup2(devNull, STDOUT_FILENO);
+    close(devNull);
+    bool recovered = log.recover(registry);
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    return recovered;
+}
+
+/**
+ * @brief @p writers threads, each on its own graph, add points one at a time the way
+ * AddPoint does: change the graph under its mutex, then wait for the log before replying.
+ */
+static void measureCommits(uint64_t budgetMicros, size_t writers, double seconds) {
+    std::string directory = runDirectory("commit");
+    GraphRegistry registry("double");
+    WriteAheadLog* log = new WriteAheadLog(directory.c_str(), budgetMicros, 0); // Its flusher never stops
+    if (!quietRecover(*log, registry)) exit(1);
+    registry.attachLog(log);
+    log->start(registry);
+
+    std::vector<LatencyHistogram> latencies(writers);
+    std::vector<size_t> commits(writers, 0);
+    uint64_t deadline = ServerStats::now() + (uint64_t)(seconds * 1e9);
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w] {
+            std::shared_ptr<NamedGraph> graph = registry.open("writer" + std::to_string(w));
+            latencies[w].reset();
+            for (double i = 0; ServerStats::now() < deadline; ++i) {
+                uint64_t start = ServerStats::now();
+                double point[2] = {i, (double)w};
+                {
+                    std::lock_guard<std::mutex> lock(graph->mutex);
+                    graph->engine->applyPoints(false, point, 1);
+                }
+                log->waitDurable();
+                latencies[w].record(ServerStats::now() - start);
+                commits[w]++;
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    LatencyHistogram all;
+    all.reset();
+    size_t total = 0;
+    for (size_t w = 0; w < writers; ++w) {
+        all.merge(latencies[w]);
+        total += commits[w];
+    }
+    printf("%10llu %8zu %12.0f %10.1f %10.1f\n", (unsigned long long)budgetMicros, writers, total / seconds,
+           all.quantile(0.5) / 1e3, all.quantile(0.99) / 1e3);
+    fflush(stdout);
+}
+
+/**
+ * @brief Writes @p points points in records of @p perRecord, then times recovery from that log.
+ */
+static void measureReplay(size_t points, size_t perRecord) {
+    std::string directory = runDirectory("replay");
+    {
+        GraphRegistry registry("double");
+        WriteAheadLog* log = new WriteAheadLog(directory.c_str(), 0, 0);
+        if (!quietRecover(*log, registry)) exit(1);
+        log->start(registry);
+        std::vector<double> coordinates(2 * perRecord);
+        uint64_t rng = 0x9E3779B97F4A7C15ULL;
+        for (size_t written = 0; written < points; written += perRecord) {
+            for (double& coordinate : coordinates) {
+                rng ^= rng << 13;
+                rng ^= rng >> 7;
+                rng ^= rng << 17;
+                coordinate = (rng % 1000000) / 1000.0;
+            }
+            log->appendPoints(false, "replayed", coordinates.data(), perRecord);
+        }
+        log->waitDurable();
+    }
+
+    GraphRegistry registry("double");
+    WriteAheadLog* log = new WriteAheadLog(directory.c_str(), 0, 0);
+    auto start = std::chrono::steady_clock::now();
+    if (!quietRecover(*log, registry)) exit(1);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t bytes = (points / perRecord) * (sizeof(WalRecordHeader) + 8 + 16 * perRecord); // "replayed" takes 8
+    printf("%12zu %12zu %10.3f %10.0f %10.1f\n", points, perRecord, elapsed, bytes / elapsed / 1e6,
+           points / elapsed / 1e6);
+    fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+    benchDirectory = ".";
+    double seconds = 1;
+    size_t replayPoints = 4000000;
+    int option;
+    while ((option = getopt(argc, argv, "d:t:n:")) != -1) {
+        if (option == 'd') {
+            benchDirectory = optarg;
+        } else if (option == 't') {
+            seconds = strtod(optarg, nullptr);
+        } else if (option == 'n') {
+            replayPoints = (size_t)strtod(optarg, nullptr);
+        } else {
+            fprintf(stderr, "Usage: %s [-d directory] [-t seconds_per_run] [-n replayed_points]\n", argv[0]);
+            return 1;
+        }
+    }
+    benchDirectory += "/wal_bench.tmp";
+    mkdir(benchDirectory.c_str(), 0755);
+
+    printf("Durable AddPoint, one graph per writer, %d CPUs\n", (int)sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%10s %8s %12s %10s %10s\n", "budget_us", "writers", "commits/s", "p50_us", "p99_us");
+    for (uint64_t budget : {0, 50, 200, 1000})
+        for (size_t writers : {1, 8, 32}) measureCommits(budget, writers, seconds);
+
+    printf("\nRecovery\n%12s %12s %10s %10s %10s\n", "points", "per_record", "seconds", "MB/s", "Mpoints/s");
+    measureReplay(replayPoints, 1);
+    measureReplay(replayPoints, BULK_RECORD_POINTS);
+
+    if (system(("rm -rf '" + benchDirectory + "'").c_str()) != 0) return 1;
+    return 0;
+}
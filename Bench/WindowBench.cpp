@@ -0,0 +1,92 @@
+#include "../Q8_Q9/RandomPoints.hpp"
+#include "../Q8_Q9/Stats.hpp"
+#include "../Q8_Q9/WindowHull.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+#define CHECK_INTERVAL 97 // Inserts between brute-force checks
+
+/**
+ * @brief Checks the window hull against the hull of the last points recomputed from scratch,
+ * for a count window and for an age window driven by synthetic timestamps.
+ */
+static bool checkAgainstBruteForce(size_t windowPoints, size_t totalPoints) {
+    PointVector<float> stream;
+    RandomPointGenerator::generate(stream, totalPoints, DISTRIBUTION_NORMAL, 11);
+
+    const uint64_t tick = 1000; // ns between synthetic inserts
+    WindowHull<float> byCount(windowPoints, 0), byAge(0, windowPoints * tick - 1);
+    for (size_t i = 0; i < totalPoints; ++i) {
+        byCount.insert(stream[i], i * tick);
+        byAge.insert(stream[i], (i + 1) * tick);
+        if (i % CHECK_INTERVAL != 0 && i + 1 != totalPoints) continue;
+
+        size_t first = i + 1 > windowPoints ? i + 1 - windowPoints : 0;
+        PointVector<float> recent(stream.begin() + first, stream.begin() + i + 1);
+        std::vector<Point> expected = ConvexHullUtility::findConvexHull(recent);
+        if (byCount.hull(i * tick) != expected || byAge.hull((i + 1) * tick) != expected) {
+            fprintf(stderr, "window %zu: hull mismatch after %zu inserts\n", windowPoints, i + 1);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Inserts as fast as possible, asking for the hull every @p queryEvery inserts.
+ */
+static void sustainedRate(size_t windowPoints, double windowSeconds, size_t totalPoints, size_t queryEvery) {
+    PointVector<float> stream;
+    RandomPointGenerator::generate(stream, totalPoints, DISTRIBUTION_UNIFORM, 5);
+
+    WindowHull<float> window(windowPoints, (uint64_t)(windowSeconds * 1e9));
+    LatencyHistogram queries;
+    size_t hullSize = 0;
+
+    uint64_t start = ServerStats::now();
+    for (size_t i = 0; i < totalPoints; ++i) {
+        uint64_t now = ServerStats::now();
+        window.insert(stream[i], now);
+        if ((i + 1) % queryEvery == 0) {
+            hullSize = window.hull(now).size();
+            queries.record(ServerStats::now() - now);
+        }
+    }
+    double seconds = (ServerStats::now() - start) / 1e9;
+
+    char limit[32];
+    if (windowPoints > 0) snprintf(limit, sizeof(limit), "%zu pts", windowPoints);
+    else snprintf(limit, sizeof(limit), "%.2f s", windowSeconds);
+    printf("%-10s %11zu %8zu %12.0f %10zu %10.1f %10.1f %8zu\n", limit, totalPoints, queryEvery,
+           totalPoints / seconds, window.size(), queries.quantile(0.5) / 1e3, queries.quantile(0.99) / 1e3,
+           hullSize);
+    fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+    size_t totalPoints = 3000000;
+    int option;
+    while ((option = getopt(argc, argv, "n:")) != -1) {
+        if (option == 'n') {
+            totalPoints = (size_t)strtod(optarg, nullptr);
+        } else {
+            fprintf(stderr, "Usage: %s [-n inserts]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    for (size_t windowPoints : {1, 5, 1000, 1024, 5000})
+        if (!checkAgainstBruteForce(windowPoints, 20000)) return 1;
+    printf("window hull matches brute force\n");
+
+    printf("%-10s %11s %8s %12s %10s %10s %10s %8s\n", "window", "inserts", "ch_every", "inserts/s", "live",
+           "ch_p50_us", "ch_p99_us", "hull");
+    for (size_t windowPoints : {10000, 100000, 1000000})
+        for (size_t queryEvery : {1, 100})
+            sustainedRate(windowPoints, 0, totalPoints, queryEvery);
+    for (size_t queryEvery : {1, 100})
+        sustainedRate(0, 0.25, totalPoints, queryEvery);
+    return 0;
+}
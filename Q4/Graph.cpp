@@ -1,73 +1,103 @@
+#include <algorithm>
 #include "Graph.hpp"
 
 using namespace std;
 
+// Twice the signed area of (origin, a, b): positive when b lies counter-clockwise of a
+static int64_t turn(const Point& origin, const Point& a, const Point& b) {
+    return ((int64_t)a.getX() - origin.getX()) * ((int64_t)b.getY() - origin.getY()) -
+           ((int64_t)a.getY() - origin.getY()) * ((int64_t)b.getX() - origin.getX());
+}
+
+static int64_t squaredDistance(const Point& a, const Point& b) {
+    int64_t dx = (int64_t)b.getX() - a.getX(), dy = (int64_t)b.getY() - a.getY();
+    return dx * dx + dy * dy;
+}
+
+// Adds a new point
+PointHandle Graph::addPoint(int x, int y) {
+    PointHandle handle;
+    if (freeHandles.empty()) {
+        handle = (PointHandle)slots.size();
+        slots.push_back(0);
+    } else {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
 
+    slots[handle] = (uint32_t)points.size();
+    points.emplace_back(x, y);
+    handles.push_back(handle);
+    return handle;
+}
+
+// Moves the last point into the freed place
+void Graph::removeAt(size_t place) {
+    freeHandles.push_back(handles[place]);
+
+    size_t last = points.size() - 1;
+    if (place != last) {
+        points[place] = points[last];
+        handles[place] = handles[last];
+        slots[handles[place]] = (uint32_t)place;
+    }
+    points.pop_back();
+    handles.pop_back();
+}
 
-// Remove a point from the graph
+// Remove every point at (x, y) from the graph
 void Graph::removePoint(int x, int y) {
-    auto it = std::remove_if(points.begin(), points.end(), [x, y](Point* point) {
-        if (point->getX() == x && point->getY() == y) {
-            delete point; // Free memory for the removed point
-            return true;  // Remove from vector
-        }
-        return false;
-    });
-    points.erase(it, points.end());
+    Point target(x, y);
+    for (size_t place = points.size(); place-- > 0;) {
+        if (points[place] == target) removeAt(place);
+    }
 }
 
-// Adds a new point
-void Graph::addPoint(int x, int y) {
-    points.push_back(new Point(x, y));
+// A freed handle's slot is past the end or holds another point's handle
+bool Graph::live(PointHandle handle) const {
+    return handle < slots.size() && slots[handle] < points.size() && handles[slots[handle]] == handle;
 }
 
+bool Graph::removePoint(PointHandle handle) {
+    if (!live(handle)) return false;
+    removeAt(slots[handle]);
+    return true;
+}
 
+void Graph::clear() {
+    points.clear();
+    handles.clear();
+    slots.clear();
+    freeHandles.clear();
+}
 
 // Function to find convex hull
-vector<Point*> Graph::convexHull() {
+const vector<Point>& Graph::convexHull() {
     if (points.size() < 3) {
         return points;
     }
 
     // Finding the lowest point
-    auto origin_iter = min_element(points.begin(), points.end(), [](Point* a, Point* b) {
-        return (a->getY() < b->getY()) || (a->getY() == b->getY() && a->getX() < b->getX());
+    Point origin = *min_element(points.begin(), points.end(), [](const Point& a, const Point& b) {
+        return (a.getY() < b.getY()) || (a.getY() == b.getY() && a.getX() < b.getX());
     });
 
-    Point origin = **origin_iter;
-
-    // Sort the points by angle
-    sort(points.begin(), points.end(), [&origin](Point* a, Point* b) {
-        return comparePolar(a, b, origin);
+    // Sort a copy by angle around it with exact cross products; nearer points first on a ray
+    sorted.assign(points.begin(), points.end());
+    sort(sorted.begin(), sorted.end(), [&origin](const Point& a, const Point& b) {
+        int64_t direction = turn(origin, a, b);
+        if (direction != 0) return direction > 0;
+        return squaredDistance(origin, a) < squaredDistance(origin, b);
     });
 
     // Building the convex hull
-    vector<Point*> hull;
-    for (auto point : points) {
-        while (hull.size() >= 2) {
-            Point* p2 = hull.back();
-            Point* p1 = hull[hull.size() - 2];
-
-            float det = (p2->getX() - p1->getX()) * (point->getY() - p1->getY()) - (p2->getY() - p1->getY()) * (point->getX() - p1->getX());
-
-            // Right turn
-            if (det <= 0) {
-                hull.pop_back();
-            }
-            // Left turn
-            else {
-                break;
-            }
+    hull.clear();
+    for (const Point& point : sorted) {
+        // Pop while the last two hull points and this one do not make a left turn
+        while (hull.size() >= 2 && turn(hull[hull.size() - 2], hull.back(), point) <= 0) {
+            hull.pop_back();
         }
         hull.push_back(point);
     }
     return hull;
 }
-
-
-// Angle comparison function for sorting
-bool Graph::comparePolar(Point* p1, Point* p2, Point& origin) {
-    float dx1 = p1->getX() - origin.getX(), dx2 = p2->getX() - origin.getX();
-    float dy1 = p1->getY() - origin.getY(), dy2 = p2->getY() - origin.getY();
-    return atan2(dy1, dx1) < atan2(dy2, dx2);
-}
@@ -1,35 +1,56 @@
-#include <iostream>
+#ifndef GRAPH_HPP
+#define GRAPH_HPP
+
+#include <cstdint>
 #include <vector>
-#include <memory>
-#include <algorithm>
-#include <cmath>
-#include <string>
-#include <sstream>
-#include <limits>
 #include "Point.hpp"
 
 using namespace std;
 
+typedef uint32_t PointHandle; // Names one point for as long as it stays in the graph
+
+/**
+ * @brief The points of a graph, stored by value in one contiguous array.
+ *
+ * Removal moves the last point into the freed place, so the array never has holes
+ * and the hull scans it front to back. A handle table maps each handle to the
+ * point's current place, which keeps handles valid while points move.
+ *
+ * Every buffer, including the hull's scratch space, keeps its capacity across
+ * removals and clear(), so once the graph has reached its largest size no
+ * operation allocates.
+ */
 class Graph {
 
     public:
-    vector<Point*> points;
-
-    void removePoint(int x, int y); // Remove a point from the graph
-    void addPoint(int x, int y);   // Adds a new point
-    vector<Point*> convexHull();    // Function to find convex hull
-
-
-     // Destructor to free memory
-    ~Graph() {
-        for (Point* point : points) {
-            delete point;
-        }
-    }
+    PointHandle addPoint(int x, int y);   // Adds a new point
+    void removePoint(int x, int y);       // Removes every point at (x, y)
+    bool removePoint(PointHandle handle); // Removes one point; false if the handle names none
+    void clear();                         // Removes all points, keeping the memory
+
+    const Point& getPoint(PointHandle handle) const { return points[slots[handle]]; } // handle must be live
+    const vector<Point>& getPoints() const { return points; }
+    size_t size() const { return points.size(); }
+
+    /**
+     * @brief Graham scan from the lowest point, counter-clockwise.
+     *
+     * @return The hull vertices, valid until the next call; the graph's points themselves
+     *         when there are fewer than three.
+     */
+    const vector<Point>& convexHull();
 
     private:
-    // Angle comparison function for sorting
-    static bool comparePolar(Point* p1, Point* p2, Point& origin) ;
+    vector<Point> points;          // The points, without holes
+    vector<PointHandle> handles;   // handles[i] is the handle of points[i]
+    vector<uint32_t> slots;        // slots[handle] is the place of that point in points
+    vector<PointHandle> freeHandles;
+
+    vector<Point> sorted;          // Scratch space of convexHull()
+    vector<Point> hull;
 
+    bool live(PointHandle handle) const;
+    void removeAt(size_t place);
+};
 
-};
\ No newline at end of file
+#endif // GRAPH_HPP
@@ -0,0 +1,54 @@
+#include <cstring>
+#include "Protocol.hpp"
+
+void ResponseBuffer::appendFloat(float value) {
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr - digits);
+}
+
+void ResponseBuffer::appendUnsigned(size_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr - digits);
+}
+
+void ResponseBuffer::appendPoint(float x, float y) {
+    buffer.push_back('(');
+    appendFloat(x);
+    buffer.push_back(',');
+    appendFloat(y);
+    buffer.push_back(')');
+}
+
+/**
+ * @brief Parses "x,y". std::from_chars neither allocates nor consults the locale.
+ */
+const char* TextProtocol::parsePoint(const char* begin, const char* end, float& x, float& y) {
+    begin = skipBlanks(begin, end);
+    auto first = std::from_chars(begin, end, x);
+    if (first.ec != std::errc()) return nullptr;
+
+    begin = skipBlanks(first.ptr, end);
+    if (begin == end || *begin != ',') return nullptr;
+
+    begin = skipBlanks(begin + 1, end);
+    auto second = std::from_chars(begin, end, y);
+    if (second.ec != std::errc()) return nullptr;
+
+    return second.ptr;
+}
+
+bool TextProtocol::parseCommandPoint(const char* input, size_t prefixLength, float& x, float& y) {
+    const char* end = input + strlen(input);
+    if (input + prefixLength > end) return false;
+    return parsePoint(input + prefixLength, end, x, y) != nullptr;
+}
+
+bool TextProtocol::parseCommandCount(const char* input, size_t prefixLength, size_t& count) {
+    const char* end = input + strlen(input);
+    if (input + prefixLength > end) return false;
+
+    const char* begin = skipBlanks(input + prefixLength, end);
+    return std::from_chars(begin, end, count).ec == std::errc();
+}
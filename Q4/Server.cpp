@@ -5,77 +5,90 @@
 #include <cstring>
 #include <vector>
 #include <algorithm>
-#include <fcntl.h>
+#include <poll.h>
+#include "Acceptor.hpp"
 #include "Graph.hpp" // Header file for the Graph class
+#include "Protocol.hpp"
 
 #define PORT 9034
-#define BACKLOG 10
 #define BUFFER_SIZE 1024
 
 // Global Graph object (shared by all clients)
 Graph currentGraph;
 
+// Reply buffer shared by all clients; the select loop handles one command at a time
+ResponseBuffer response;
+
 // Function to handle client commands
-void handleCommand(int client_fd, const std::string& command) {
-    std::string response;
+void handleCommand(int client_fd, const char* command) {
+    response.clear();
 
     try {
-        if (command.rfind("NewGraph", 0) == 0) {
-            int n;
-            std::istringstream ss(command.substr(9)); // Extract size from the command
-            ss >> n;
-
-            currentGraph = Graph(); // Reset the graph
-            response = "Graph cleared. Please send " + std::to_string(n) + " points in the format x,y.\n";
+        if (strncmp(command, "NewGraph", 8) == 0) {
+            size_t n;
+            if (!TextProtocol::parseCommandCount(command, 8, n)) {
+                response.append("Invalid NewGraph command.\n");
+            } else {
+                currentGraph.clear(); // Reset the graph, keeping its memory
+                response.append("Graph cleared. Please send ");
+                response.appendUnsigned(n);
+                response.append(" points in the format x,y.\n");
+            }
 
-        } else if (command.rfind("NewPoint", 0) == 0) {
+        } else if (strncmp(command, "NewPoint", 8) == 0) {
             float x, y;
-            char comma;
-            std::istringstream ss(command.substr(9)); // Extract point data
-            ss >> x >> comma >> y;
-
-            currentGraph.addPoint(x, y); // Add point to graph
-            response = "Point (" + std::to_string(x) + "," + std::to_string(y) + ") added.\n";
+            if (!TextProtocol::parseCommandPoint(command, 8, x, y)) {
+                response.append("Invalid point format.\n");
+            } else {
+                currentGraph.addPoint(x, y); // Add point to graph
+                response.append("Point ");
+                response.appendPoint(x, y);
+                response.append(" added.\n");
+            }
 
-        } else if (command.rfind("RemovePoint", 0) == 0) {
+        } else if (strncmp(command, "RemovePoint", 11) == 0) {
             float x, y;
-            char comma;
-            std::istringstream ss(command.substr(12)); // Extract point data
-            ss >> x >> comma >> y;
-
-            currentGraph.removePoint(x, y); // Remove point from graph
-            response = "Point (" + std::to_string(x) + "," + std::to_string(y) + ") removed.\n";
-
-        } else if (command.rfind("CH", 0) == 0) {
-            auto convexHull = currentGraph.convexHull(); // Calculate convex hull
-            response = "Convex Hull points:\n";
-            for (const auto& point : convexHull) {
-                response += "(" + std::to_string(point->getX()) + "," + std::to_string(point->getY()) + ")\n";
+            if (!TextProtocol::parseCommandPoint(command, 11, x, y)) {
+                response.append("Invalid point format.\n");
+            } else {
+                currentGraph.removePoint(x, y); // Remove point from graph
+                response.append("Point ");
+                response.appendPoint(x, y);
+                response.append(" removed.\n");
+            }
+
+        } else if (strncmp(command, "CH", 2) == 0) {
+            const vector<Point>& convexHull = currentGraph.convexHull(); // Calculate convex hull
+            response.append("Convex Hull points:\n");
+            for (const Point& point : convexHull) {
+                response.appendPoint(point.getX(), point.getY());
+                response.append('\n');
             }
 
         } else {
-            response = "Invalid command.\n";
+            response.append("Invalid command.\n");
         }
     } catch (const std::exception& e) {
-        response = "Error: ";
-        response += e.what();
-        response += "\n";
+        response.append("Error: ");
+        response.append(e.what());
+        response.append('\n');
     }
 
-    send(client_fd, response.c_str(), response.length(), 0);
+    send(client_fd, response.data(), response.size(), 0);
 }
 
 
 // Function to set up and run the server
-void setupServer() {
+void setupServer(const AcceptOptions& acceptOptions) {
     int server_fd = socket(AF_INET, SOCK_STREAM, 0);
     if (server_fd == -1) {
         perror("Socket creation failed");
         exit(EXIT_FAILURE);
     }
 
-    // Set the socket to non-blocking mode
-    fcntl(server_fd, F_SETFL, O_NONBLOCK);
+    // Restarting while old connections sit in TIME_WAIT must not fail the bind
+    int reuse = 1;
+    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
 
     struct sockaddr_in address;
     address.sin_family = AF_INET;
@@ -88,7 +101,9 @@ void setupServer() {
         exit(EXIT_FAILURE);
     }
 
-    if (listen(server_fd, BACKLOG) < 0) {
+    // The acceptor makes the socket non-blocking; replies use one blocking send, so clients stay blocking
+    Acceptor acceptor(acceptOptions, 0);
+    if (!acceptor.listen(server_fd)) {
         perror("Listen failed");
         close(server_fd);
         exit(EXIT_FAILURE);
@@ -96,63 +111,64 @@ void setupServer() {
 
     std::cout << "Server listening on port " << PORT << std::endl;
 
-    std::vector<int> clientSockets;
+    // Entry 0 watches the listening socket, the rest watch one client each.
+    // poll() rather than select(), which cannot watch descriptors above FD_SETSIZE
+    std::vector<struct pollfd> pollFds;
+    pollFds.push_back({server_fd, POLLIN, 0});
 
     // Main loop to handle connections and commands
     while (true) {
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        FD_SET(server_fd, &readfds);
-
-        int max_fd = server_fd;
-        for (int client_fd : clientSockets) {
-            FD_SET(client_fd, &readfds);
-            max_fd = std::max(max_fd, client_fd);
-        }
-
-        int activity = select(max_fd + 1, &readfds, nullptr, nullptr, nullptr);
+        int activity = poll(pollFds.data(), pollFds.size(), -1);
         if (activity < 0) {
-            perror("Select error");
+            perror("Poll error");
             continue;
         }
 
-        // Handle new client connections
-        if (FD_ISSET(server_fd, &readfds)) {
-            int client_fd = accept(server_fd, nullptr, nullptr);
-            if (client_fd < 0) {
-                perror("Accept failed");
-            } else {
-                clientSockets.push_back(client_fd);
-                std::cout << "New client connected: " << client_fd << std::endl;
-            }
-        }
-
         // Handle commands from existing clients
-        for (auto it = clientSockets.begin(); it != clientSockets.end();) {
-            int client_fd = *it;
-            if (FD_ISSET(client_fd, &readfds)) {
+        for (size_t i = 1; i < pollFds.size();) {
+            int client_fd = pollFds[i].fd;
+            if (pollFds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
                 char buffer[BUFFER_SIZE];
-                memset(buffer, 0, sizeof(buffer));
-                int bytesRead = recv(client_fd, buffer, sizeof(buffer), 0);
+                int bytesRead = recv(client_fd, buffer, sizeof(buffer) - 1, 0);
 
                 if (bytesRead <= 0) {
                     std::cout << "Client disconnected: " << client_fd << std::endl;
                     close(client_fd);
-                    it = clientSockets.erase(it);
+                    // The last client takes this place and is looked at next
+                    pollFds[i] = pollFds.back();
+                    pollFds.pop_back();
                     continue;
                 }
 
-                std::string command(buffer);
-                handleCommand(client_fd, command);
+                buffer[bytesRead] = '\0';
+                handleCommand(client_fd, buffer);
+            }
+            ++i;
+        }
+
+        // Handle new client connections, every pending one up to the accept budget
+        if (pollFds[0].revents & POLLIN) {
+            for (int client_fd : acceptor.acceptBatch()) {
+                pollFds.push_back({client_fd, POLLIN, 0});
+                std::cout << "New client connected: " << client_fd << std::endl;
             }
-            ++it;
         }
     }
 
     close(server_fd);
 }
 
-int main() {
-    setupServer();
+int main(int argc, char* argv[]) {
+    // -b, -a and -D set the listen backlog, accept budget and TCP_DEFER_ACCEPT seconds
+    AcceptOptions acceptOptions;
+    int option;
+    while ((option = getopt(argc, argv, "b:a:D:")) != -1) {
+        if (!acceptOptions.parse(option, optarg)) {
+            fprintf(stderr, "Usage: %s [-b listen_backlog] [-a accept_budget] [-D defer_accept_seconds]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    setupServer(acceptOptions);
     return 0;
 }
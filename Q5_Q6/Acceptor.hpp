@@ -0,0 +1,91 @@
+#ifndef ACCEPTOR_HPP
+#define ACCEPTOR_HPP
+
+#include <cstddef>
+#include <vector>
+#include <sys/socket.h>
+
+#define ACCEPT_DEFAULT_BACKLOG SOMAXCONN // The kernel caps it at net.core.somaxconn
+#define ACCEPT_DEFAULT_BUDGET 64         // Connections taken per readiness event
+
+/**
+ * @brief Listen queue settings, taken from the -b, -a and -D command line options.
+ */
+struct AcceptOptions {
+    int backlog = ACCEPT_DEFAULT_BACKLOG;
+    size_t budget = ACCEPT_DEFAULT_BUDGET;
+    int deferSeconds = 0; // TCP_DEFER_ACCEPT; 0 leaves it off
+
+    /**
+     * @brief Applies one of the options -b backlog, -a accept_budget or -D defer_seconds.
+     *
+     * @return False if @p option is not one of them or @p value is not a valid count.
+     */
+    bool parse(int option, const char* value);
+};
+
+/**
+ * @brief Drains a listening socket's accept queue in batches.
+ *
+ * The listening socket is non-blocking, so one readiness event takes every pending
+ * connection up to the budget with accept4, and the caller goes back to its loop
+ * when the queue is empty instead of blocking in accept. A larger backlog lets a
+ * reconnect storm queue in the kernel rather than having its SYNs dropped.
+ *
+ * When the process runs out of descriptors, a spare descriptor kept open for the
+ * purpose is closed to accept and immediately drop one connection. The client sees
+ * the connection closed instead of waiting in the queue, and a level-triggered poll
+ * does not keep waking for a connection that cannot be accepted.
+ *
+ * TCP_DEFER_ACCEPT holds a connection in the kernel until the client sends data,
+ * so it only suits protocols where the client speaks first; a server that greets
+ * its clients would wait for the full defer time on each of them.
+ */
+class Acceptor {
+private:
+    int listenFd;
+    int spareFd;
+    int acceptFlags;
+    AcceptOptions options;
+    std::vector<int> accepted;
+
+public:
+    /**
+     * @param options Backlog, budget and defer settings.
+     * @param clientFlags Extra accept4 flags for accepted sockets: SOCK_NONBLOCK where the server
+     *                    buffers its writes, 0 where it replies with one blocking send.
+     *                    SOCK_CLOEXEC is always set.
+     */
+    explicit Acceptor(const AcceptOptions& options = AcceptOptions(), int clientFlags = 0);
+    ~Acceptor();
+
+    Acceptor(const Acceptor&) = delete;
+    Acceptor& operator=(const Acceptor&) = delete;
+
+    /**
+     * @brief Makes a bound socket non-blocking, applies TCP_DEFER_ACCEPT and starts listening.
+     *
+     * @return False with errno set if the socket could not listen.
+     */
+    bool listen(int socketFd);
+
+    int fd() const { return listenFd; }
+
+    /**
+     * @brief Waits until a connection is pending or @p timeoutMs passes (-1 waits forever).
+     *
+     * For threads that do nothing but accept.
+     *
+     * @return False on timeout or when the socket was closed.
+     */
+    bool wait(int timeoutMs);
+
+    /**
+     * @brief Accepts pending connections until the queue is empty or the budget is spent.
+     *
+     * @return The accepted descriptors, valid until the next call.
+     */
+    const std::vector<int>& acceptBatch();
+};
+
+#endif // ACCEPTOR_HPP
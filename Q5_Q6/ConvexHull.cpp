@@ -22,7 +22,10 @@ float ConvexHullUtility::computeEnclosedArea(vector<Point>& points) {
  */
 vector<Point> ConvexHullUtility::findConvexHull(vector<Point>& points) {
     size_t totalPoints = points.size(), hullIndex = 0;
-    vector<Point> hull(totalPoints);
+    if (totalPoints < 3) return points;
+
+    // The closing point is written once more than the hull has vertices
+    vector<Point> hull(totalPoints + 1);
 
     // Sort points lexicographically
     std::sort(points.begin(), points.end());
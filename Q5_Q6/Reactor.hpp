@@ -17,8 +17,6 @@
 #include <poll.h>
 #include <signal.h>
 
-#define MAX_EVENT_COUNT 10
-
 typedef void (*EventCallback)(int fd);
 
 /**
@@ -28,8 +26,7 @@ typedef void (*EventCallback)(int fd);
 class Reactor {
 private:
     bool running;
-    struct pollfd* eventPollFds;
-    unsigned int eventPollFdsSize;
+    std::vector<struct pollfd> eventPollFds;
     std::unordered_map<int, EventCallback> eventCallbackMap;
 
 public:
@@ -1,5 +1,7 @@
+#include "Acceptor.hpp"
 #include "ConvexHull.hpp"
 #include "Reactor.hpp"
+#include "Protocol.hpp"
 #include <iostream>
 #include <string.h>
 #include <stdio.h>
@@ -12,9 +14,10 @@
 #include <netdb.h>
 #include <poll.h>
 #include <signal.h>
+#include <errno.h>
 
 #define PORT "9034" // Port number for the server
-#define BUFFER_SIZE 50 // Buffer size for client messages
+#define BUFFER_SIZE 1024 // Buffer size for client messages (fits a batch of point lines)
 
 using std::cout;
 using std::endl;
@@ -22,9 +25,12 @@ using std::string;
 
 // Global variables for server state
 Reactor reactor;               // Reactor for managing I/O events
+Acceptor* acceptor = nullptr;  // Takes new connections off the listening socket in batches
 std::vector<Point> graphPoints; // Points representing the graph
 size_t pointsRemaining = 0;    // Number of points yet to be received
 int creatorClientFd = -1;      // File descriptor of the graph creator client
+PointLineBuffer pointLines;    // The creator's point line cut off at the end of its last read
+ResponseBuffer clientResponse; // Reply buffer, reused by every client since the reactor is single-threaded
 
 // Signal handler to shut down the server gracefully
 void handleSignalInterrupt(int signal) {
@@ -32,68 +38,85 @@ void handleSignalInterrupt(int signal) {
     reactor.halt();
 }
 
-// Processes client commands and returns a response
-string processClientCommand(char* input, int clientFd) {
+// Processes client commands and writes the reply into the response buffer; it stays
+// empty when a read only carried part of a point line
+void processClientCommand(const char* input, size_t inputLength, int clientFd, ResponseBuffer& response) {
     if (pointsRemaining > 0) {
         // Handle point addition during graph creation
         if (creatorClientFd != clientFd) {
-            return "Another client is creating a graph";
+            response.append("Another client is creating a graph");
+            return;
         }
 
-        float x, y;
-        if (sscanf(input, "%f,%f", &x, &y) != 2) {
-            return "Invalid coordinates format while waiting for points";
+        // Bulk mode: every whole point line received so far is parsed at once; a read
+        // that completes no line is not answered
+        const char *lines, *linesEnd;
+        pointLines.take(input, inputLength, lines, linesEnd);
+        if (lines == linesEnd) return;
+        size_t added;
+        const char* rest = TextProtocol::parsePointLines(lines, linesEnd, graphPoints, pointsRemaining, added);
+        pointsRemaining -= added;
+        if (added == 0 || (rest != linesEnd && pointsRemaining > 0)) {
+            pointLines.clear();
+            response.append("Invalid coordinates format while waiting for points");
+            return;
         }
-
-        graphPoints.emplace_back(x, y);
-        pointsRemaining--;
         if (pointsRemaining == 0) {
+            pointLines.clear();
             creatorClientFd = -1;
-            return "Graph creation complete";
+            response.append("Graph creation complete");
+            return;
         }
-        return "Point added";
+        response.append(added == 1 ? "Point added" : "Points added");
+        return;
     }
 
     // Handle specific commands
     if (strncmp(input, "Newgraph", 8) == 0) {
         size_t numPoints;
-        if (sscanf(input, "Newgraph %zu", &numPoints) != 1 || numPoints == 0) {
-            return "Invalid Newgraph command or graph size must be at least 1";
+        if (!TextProtocol::parseCommandCount(input, 8, numPoints) || numPoints == 0) {
+            response.append("Invalid Newgraph command or graph size must be at least 1");
+            return;
         }
 
         graphPoints.clear();
         graphPoints.reserve(numPoints);
+        pointLines.clear();
         creatorClientFd = clientFd;
         pointsRemaining = numPoints;
-        return "Expecting points for new graph";
+        response.append("Expecting points for new graph");
     } else if (strncmp(input, "CH", 2) == 0) {
         float convexHullArea = ConvexHullUtility::computeHullArea(graphPoints);
-        return "Convex hull area: " + std::to_string(convexHullArea);
+        response.append("Convex hull area: ");
+        response.appendFloat(convexHullArea);
     } else if (strncmp(input, "Newpoint", 8) == 0) {
         float x, y;
-        if (sscanf(input, "Newpoint %f,%f", &x, &y) != 2) {
-            return "Invalid coordinates format";
+        if (!TextProtocol::parseCommandPoint(input, 8, x, y)) {
+            response.append("Invalid coordinates format");
+            return;
         }
 
         graphPoints.emplace_back(x, y);
-        return "Point added";
+        response.append("Point added");
     } else if (strncmp(input, "Removepoint", 11) == 0) {
         float x, y;
-        if (sscanf(input, "Removepoint %f,%f", &x, &y) != 2) {
-            return "Invalid coordinates format";
+        if (!TextProtocol::parseCommandPoint(input, 11, x, y)) {
+            response.append("Invalid coordinates format");
+            return;
         }
 
         for (size_t i = 0; i < graphPoints.size(); ++i) {
             if (graphPoints[i].getX() == x && graphPoints[i].getY() == y) {
                 graphPoints[i] = graphPoints.back();
                 graphPoints.pop_back();
-                return "Point removed";
+                response.append("Point removed");
+                return;
             }
         }
-        return "Point not found";
+        response.append("Point not found");
+    } else {
+        response.append("Unknown command");
     }
-
-    return "Unknown command";
 }
 
 // Retrieves the appropriate address (IPv4 or IPv6) from a sockaddr structure
@@ -104,8 +127,8 @@ void* getInAddress(struct sockaddr* sa) {
     return &(((struct sockaddr_in6*)sa)->sin6_addr);
 }
 
-// Creates and returns a listening socket
-int createListenerSocket() {
+// Creates a socket and starts the acceptor listening on it; returns the socket
+int createListenerSocket(Acceptor& acceptor) {
     int listener;
     int yes = 1;
     int result;
@@ -140,7 +163,7 @@ int createListenerSocket() {
 
     freeaddrinfo(ai);
 
-    if (p == NULL || listen(listener, SOMAXCONN) == -1) {
+    if (p == NULL || !acceptor.listen(listener)) {
         return -1;
     }
 
@@ -149,42 +172,57 @@ int createListenerSocket() {
 
 // Handles incoming messages from clients
 void handleClientMessage(int clientFd) {
-    char buffer[BUFFER_SIZE] = {0};
-    ssize_t bytesRead = recv(clientFd, buffer, BUFFER_SIZE, 0);
+    char buffer[BUFFER_SIZE];
+    ssize_t bytesRead = recv(clientFd, buffer, BUFFER_SIZE - 1, 0);
 
     if (bytesRead > 0) {
+        buffer[bytesRead] = '\0';
         cout << "Message from client " << clientFd << ": " << buffer;
-        string response = processClientCommand(buffer, clientFd) + "\n>> ";
-        send(clientFd, response.c_str(), response.size(), 0);
+
+        clientResponse.clear();
+        processClientCommand(buffer, bytesRead, clientFd, clientResponse);
+        if (clientResponse.size() > 0) {
+            clientResponse.append("\n>> ");
+            send(clientFd, clientResponse.data(), clientResponse.size(), 0);
+        }
     } else if (bytesRead == 0) {
         cout << "Client " << clientFd << " disconnected." << endl;
         close(clientFd);
         reactor.unregisterFd(clientFd);
-    } else {
+    } else if (errno != EAGAIN) {
+        // A reset connection stays readable; drop it rather than polling it forever
         perror("recv");
+        close(clientFd);
+        reactor.unregisterFd(clientFd);
     }
 }
 
-// Handles new client connections
-void handleNewConnection(int serverFd) {
-    struct sockaddr_in clientAddr;
-    socklen_t clientAddrLen = sizeof(clientAddr);
-    int newClientFd = accept(serverFd, (struct sockaddr*)&clientAddr, &clientAddrLen);
-
-    if (newClientFd == -1) {
-        perror("accept");
-        return;
+// Handles new client connections: takes every pending one, up to the accept budget
+void handleNewConnection(int) {
+    for (int newClientFd : acceptor->acceptBatch()) {
+        cout << "New client connected: " << newClientFd << endl;
+        send(newClientFd, ">> ", 3, MSG_NOSIGNAL);
+        reactor.registerFd(newClientFd, handleClientMessage);
     }
-
-    cout << "New client connected: " << newClientFd << endl;
-    send(newClientFd, ">> ", 3, 0);
-    reactor.registerFd(newClientFd, handleClientMessage);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     signal(SIGINT, handleSignalInterrupt);
 
-    int listener = createListenerSocket();
+    // -b, -a and -D set the listen backlog, accept budget and TCP_DEFER_ACCEPT seconds
+    AcceptOptions acceptOptions;
+    int option;
+    while ((option = getopt(argc, argv, "b:a:D:")) != -1) {
+        if (!acceptOptions.parse(option, optarg)) {
+            fprintf(stderr, "Usage: %s [-b listen_backlog] [-a accept_budget] [-D defer_accept_seconds]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Replies go out with one blocking send, so client sockets stay blocking; poll says when to read
+    Acceptor listenerAcceptor(acceptOptions, 0);
+    acceptor = &listenerAcceptor;
+    int listener = createListenerSocket(listenerAcceptor);
     if (listener == -1) {
         perror("Error creating listener socket");
         return 1;
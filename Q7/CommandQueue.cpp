@@ -0,0 +1,107 @@
+#include <climits>
+#include <thread>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "CommandQueue.hpp"
+
+static void futexWait(std::atomic<uint32_t>& word, uint32_t expected) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+static void futexWake(std::atomic<uint32_t>& word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+void CompletionSlot::complete() {
+    if (state.exchange(DONE, std::memory_order_acq_rel) == SLEEPING) futexWake(state);
+}
+
+void CompletionSlot::wait() {
+    // With one CPU the owner cannot finish while the waiter spins
+    static const int spinCount = std::thread::hardware_concurrency() > 1 ? COMMAND_SPIN_COUNT : 0;
+    for (int spin = 0; spin < spinCount; ++spin) {
+        if (state.load(std::memory_order_acquire) == DONE) return;
+        cpuRelax();
+    }
+
+    uint32_t expected = PENDING;
+    if (!state.compare_exchange_strong(expected, SLEEPING, std::memory_order_acq_rel)) return; // Already DONE
+    while (state.load(std::memory_order_acquire) == SLEEPING) futexWait(state, SLEEPING);
+}
+
+CommandQueue::CommandQueue() : head(&stub), tail(&stub), consumerSleeping(0) {}
+
+void CommandQueue::push(QueuedCommand* command) {
+    command->next.store(nullptr, std::memory_order_relaxed);
+    QueuedCommand* previous = head.exchange(command, std::memory_order_seq_cst);
+    // Until this store the consumer sees the queue as briefly cut short, and retries
+    previous->next.store(command, std::memory_order_release);
+}
+
+QueuedCommand* CommandQueue::pop() {
+    QueuedCommand* first = tail;
+    QueuedCommand* next = first->next.load(std::memory_order_acquire);
+    if (first == &stub) {
+        if (next == nullptr) return nullptr;
+        tail = next;
+        first = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+        tail = next;
+        return first;
+    }
+
+    // first is the last node; a producer may be between its exchange and its link
+    if (first != head.load(std::memory_order_acquire)) return nullptr;
+
+    // Put the stub behind it so that first can be handed out
+    push(&stub);
+    next = first->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+        tail = next;
+        return first;
+    }
+    return nullptr;
+}
+
+// Any node but the stub at the tail is a command not handed out yet
+bool CommandQueue::empty() const {
+    return tail == &stub && stub.next.load(std::memory_order_acquire) == nullptr &&
+           head.load(std::memory_order_seq_cst) == &stub;
+}
+
+void CommandQueue::submit(QueuedCommand& command) {
+    command.done.reset();
+    push(&command);
+    if (consumerSleeping.load(std::memory_order_seq_cst) && consumerSleeping.exchange(0, std::memory_order_seq_cst))
+        futexWake(consumerSleeping);
+    command.done.wait();
+}
+
+size_t CommandQueue::popBatch(QueuedCommand** batch, size_t capacity) {
+    size_t count = 0;
+    while (count == 0) {
+        while (count < capacity) {
+            QueuedCommand* command = pop();
+            if (command == nullptr) break;
+            batch[count++] = command;
+        }
+        if (count > 0) break;
+
+        // Announce the sleep, then look again so that a push in between is not missed
+        consumerSleeping.store(1, std::memory_order_seq_cst);
+        if (empty()) {
+            futexWait(consumerSleeping, 1);
+        }
+        consumerSleeping.store(0, std::memory_order_relaxed);
+    }
+    return count;
+}
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include "Protocol.hpp"
+#include "RandomPoints.hpp"
+
+#define CLUSTER_COUNT 16
+#define MIN_POINTS_PER_THREAD 65536  // Below this, starting a thread costs more than it saves
+
+/**
+ * @brief SplitMix64 finalizer; hashing (seed, counter) gives a counter-based stream.
+ */
+static inline uint64_t mix(uint64_t seed, uint64_t counter) {
+    uint64_t z = seed + (counter + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Two independent uniforms in (0, 1) from one 64-bit hash
+static inline void unitPair(uint64_t bits, float& u1, float& u2) {
+    const float scale = 1.0f / (1 << 24);
+    u1 = ((bits >> 40) + 0.5f) * scale;
+    u2 = (((bits >> 16) & 0xFFFFFF) + 0.5f) * scale;
+}
+
+static inline void normalPair(float u1, float u2, float& z1, float& z2) {
+    float radius = std::sqrt(-2.0f * std::log(u1));
+    float angle = 2.0f * (float)M_PI * u2;
+    z1 = radius * std::cos(angle);
+    z2 = radius * std::sin(angle);
+}
+
+static void fillSlice(Point* out, size_t begin, size_t end, PointDistribution distribution, uint64_t seed) {
+    // Cluster centers depend only on the seed, so every slice agrees on them
+    float centers[CLUSTER_COUNT][2];
+    if (distribution == DISTRIBUTION_CLUSTERED) {
+        for (int c = 0; c < CLUSTER_COUNT; ++c) {
+            float u1, u2;
+            unitPair(mix(~seed, c), u1, u2);
+            centers[c][0] = 0.1f + 0.8f * u1;
+            centers[c][1] = 0.1f + 0.8f * u2;
+        }
+    }
+
+    for (size_t i = begin; i < end; ++i) {
+        uint64_t bits = mix(seed, i);
+        float u1, u2, z1, z2;
+        unitPair(bits, u1, u2);
+
+        switch (distribution) {
+        case DISTRIBUTION_UNIFORM:
+            out[i] = Point(u1, u2);
+            break;
+        case DISTRIBUTION_NORMAL:
+            normalPair(u1, u2, z1, z2);
+            out[i] = Point(0.5f + 0.15f * z1, 0.5f + 0.15f * z2);
+            break;
+        case DISTRIBUTION_DISK: {
+            float radius = 0.5f * std::sqrt(u1), angle = 2.0f * (float)M_PI * u2;
+            out[i] = Point(0.5f + radius * std::cos(angle), 0.5f + radius * std::sin(angle));
+            break;
+        }
+        case DISTRIBUTION_CLUSTERED: {
+            normalPair(u1, u2, z1, z2);
+            const float* center = centers[bits % CLUSTER_COUNT];
+            out[i] = Point(center[0] + 0.02f * z1, center[1] + 0.02f * z2);
+            break;
+        }
+        }
+    }
+}
+
+bool RandomPointGenerator::parseDistribution(const char* name, size_t length, PointDistribution& distribution) {
+    static const struct { const char* name; PointDistribution value; } names[] = {
+        {"uniform", DISTRIBUTION_UNIFORM},
+        {"normal", DISTRIBUTION_NORMAL},
+        {"disk", DISTRIBUTION_DISK},
+        {"clustered", DISTRIBUTION_CLUSTERED},
+    };
+    for (const auto& entry : names) {
+        if (strlen(entry.name) == length && strncmp(entry.name, name, length) == 0) {
+            distribution = entry.value;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RandomPointGenerator::parseArguments(const char* begin, const char* end, size_t& count,
+                                          PointDistribution& distribution, uint64_t& seed) {
+    const char* word;
+    size_t length;
+
+    if (!TextProtocol::nextWord(begin, end, word, length)) return true;
+    std::from_chars_result parsed = std::from_chars(word, word + length, count);
+    if (parsed.ec != std::errc() || parsed.ptr != word + length || count == 0) return false;
+
+    if (!TextProtocol::nextWord(begin, end, word, length)) return true;
+    if (!parseDistribution(word, length, distribution)) return false;
+
+    if (!TextProtocol::nextWord(begin, end, word, length)) return true;
+    parsed = std::from_chars(word, word + length, seed);
+    if (parsed.ec != std::errc() || parsed.ptr != word + length) return false;
+
+    return !TextProtocol::nextWord(begin, end, word, length);
+}
+
+void RandomPointGenerator::generate(vector<Point>& points, size_t count, PointDistribution distribution,
+                                    uint64_t seed, unsigned int threads) {
+    points.resize(count);
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t maxThreads = std::max<size_t>(1, count / MIN_POINTS_PER_THREAD);
+    if (threads > maxThreads) threads = maxThreads;
+
+    // Each thread fills a disjoint slice; the calling thread takes the last one, and
+    // those of threads that could not be started
+    vector<std::thread> workers;
+    size_t sliceSize = count / threads;
+    unsigned int t = 0;
+    try {
+        workers.reserve(threads - 1);
+        for (; t + 1 < threads; ++t)
+            workers.emplace_back(fillSlice, points.data(), t * sliceSize, (t + 1) * sliceSize, distribution, seed);
+    } catch (const std::exception&) {
+        // Thrown with workers running; letting it escape would destroy them joinable
+    }
+    for (; t + 1 < threads; ++t) fillSlice(points.data(), t * sliceSize, (t + 1) * sliceSize, distribution, seed);
+    fillSlice(points.data(), (threads - 1) * sliceSize, count, distribution, seed);
+
+    for (std::thread& worker : workers) worker.join();
+}
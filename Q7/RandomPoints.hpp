@@ -0,0 +1,60 @@
+#ifndef RANDOM_POINTS_HPP
+#define RANDOM_POINTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Point.hpp"
+
+using std::vector;
+
+/**
+ * @brief Shapes of the random point clouds GenerateRandom can produce.
+ */
+enum PointDistribution {
+    DISTRIBUTION_UNIFORM = 0,   // Uniform over the unit square
+    DISTRIBUTION_NORMAL,        // Gaussian around (0.5, 0.5)
+    DISTRIBUTION_DISK,          // Uniform over the disk inscribed in the unit square
+    DISTRIBUTION_CLUSTERED      // 16 tight Gaussian clusters
+};
+
+/**
+ * @brief Parallel, reproducible random point generation.
+ *
+ * Point i is derived only from (seed, i) by a counter-based hash, so every
+ * thread can fill its own slice independently and the output is identical
+ * for any thread count.
+ */
+class RandomPointGenerator {
+public:
+    /**
+     * @brief Maps "uniform", "normal", "disk" or "clustered" to a distribution.
+     * 
+     * @return False if the name is not recognized.
+     */
+    static bool parseDistribution(const char* name, size_t length, PointDistribution& distribution);
+
+    /**
+     * @brief Parses the "[n] [distribution] [seed]" arguments of GenerateRandom.
+     * 
+     * Arguments that are absent keep the values passed in.
+     * 
+     * @return False if an argument is malformed.
+     */
+    static bool parseArguments(const char* begin, const char* end, size_t& count,
+                               PointDistribution& distribution, uint64_t& seed);
+
+    /**
+     * @brief Replaces the contents of @p points with @p count generated points.
+     * 
+     * @param points Destination buffer; resized to @p count.
+     * @param count Number of points to generate.
+     * @param distribution Shape of the point cloud.
+     * @param seed Seed of the counter-based generator.
+     * @param threads Worker threads to use; 0 uses every hardware thread.
+     */
+    static void generate(vector<Point>& points, size_t count, PointDistribution distribution,
+                         uint64_t seed, unsigned int threads = 0);
+};
+
+#endif // RANDOM_POINTS_HPP
@@ -1,4 +1,9 @@
+#include "Acceptor.hpp"
+#include "CommandQueue.hpp"
 #include "ConvexHull.hpp"
+#include "Protocol.hpp"
+#include "RandomPoints.hpp"
+#include <exception>
 #include <iostream>
 #include <string>
 #include <cstring>
@@ -11,9 +16,13 @@
 #include <netdb.h>
 #include <csignal>
 #include <pthread.h>
+#include <stdint.h>
 
 #define SERVER_PORT "9034" // Server's port number
-#define MESSAGE_BUFFER 50  // Buffer size for client messages
+#define MESSAGE_BUFFER 1024  // Buffer size for client messages (fits a batch of point lines)
+#define DEFAULT_RANDOM_POINTS 10000000
+#define MAX_RANDOM_POINTS 100000000 // Largest GenerateRandom accepted
+#define ACCEPT_POLL_MS 100 // The accept thread waits in poll, a cancellation point, at most this long
 
 using std::cout;
 using std::endl;
@@ -24,9 +33,13 @@ int server_socket;
 pthread_t connection_thread;
 pthread_mutex_t data_mutex;  // Mutex for protecting shared data
 
+// Actor mode (-A): client threads queue their commands for the one thread that owns point_list
+CommandQueue* command_queue = nullptr;
+
 std::vector<Point> point_list;
 size_t remaining_points = 0;
 int active_client_fd = -1;
+PointLineBuffer point_lines;  // The creator's point line cut off at the end of its last read
 
 // Signal handler to gracefully shut down the server
 void signal_handler(int signal_num) {
@@ -40,91 +53,167 @@ void signal_handler(int signal_num) {
     exit(0);
 }
 
-// Processes client commands and generates appropriate responses
-string execute_command(char* input, int client_fd) {
+// Processes client commands and writes the reply into the connection's response buffer;
+// it stays empty when a read only carried part of a point line
+void execute_command(const char* input, size_t input_length, int client_fd, ResponseBuffer& response) {
     if (remaining_points > 0) {
         if (active_client_fd != client_fd) {
-            return "Another client is currently setting up the graph.";
+            response.append("Another client is currently setting up the graph.");
+            return;
         }
 
-        float x, y;
-        if (sscanf(input, "%f,%f", &x, &y) != 2) {
-            return "Invalid format for point coordinates.";
+        // Bulk mode: every whole point line received so far is parsed at once; a read
+        // that completes no line is not answered
+        const char *lines, *lines_end;
+        point_lines.take(input, input_length, lines, lines_end);
+        if (lines == lines_end) return;
+        size_t added;
+        const char* rest = TextProtocol::parsePointLines(lines, lines_end, point_list, remaining_points, added);
+        remaining_points -= added;
+        if (added == 0 || (rest != lines_end && remaining_points > 0)) {
+            point_lines.clear();
+            response.append("Invalid format for point coordinates.");
+            return;
         }
-        point_list.emplace_back(x, y);
-        remaining_points--;
         if (remaining_points == 0) {
+            point_lines.clear();
             active_client_fd = -1;
-            return "Graph creation completed.";
+            response.append("Graph creation completed.");
+            return;
         }
-        return "Point added successfully.";
+        response.append("Point added successfully.");
+        return;
     }
 
     if (strncmp(input, "CreateGraph", 11) == 0) {
         size_t num_points;
-        if (sscanf(input, "CreateGraph %zu", &num_points) != 1 || num_points == 0) {
-            return "Invalid graph creation command.";
+        if (!TextProtocol::parseCommandCount(input, 11, num_points) || num_points == 0) {
+            response.append("Invalid graph creation command.");
+            return;
         }
 
         point_list.clear();
         point_list.reserve(num_points);
+        point_lines.clear();
         active_client_fd = client_fd;
         remaining_points = num_points;
 
-        return "Send point coordinates to create the graph.";
+        response.append("Send point coordinates to create the graph.");
     } else if (strncmp(input, "ComputeCH", 9) == 0) {
-        float area = ConvexHull::convexHullArea(point_list);
-        return "Convex hull area: " + std::to_string(area);
+        float area = ConvexHullUtility::computeHullArea(point_list);
+        response.append("Convex hull area: ");
+        response.appendFloat(area);
     } else if (strncmp(input, "AddPoint", 8) == 0) {
         float x, y;
-        if (sscanf(input, "AddPoint %f,%f", &x, &y) != 2) {
-            return "Invalid format for point coordinates.";
+        if (!TextProtocol::parseCommandPoint(input, 8, x, y)) {
+            response.append("Invalid format for point coordinates.");
+            return;
         }
 
         point_list.emplace_back(x, y);
-        return "Point added successfully.";
+        response.append("Point added successfully.");
     } else if (strncmp(input, "RemovePoint", 11) == 0) {
         float x, y;
-        if (sscanf(input, "RemovePoint %f,%f", &x, &y) != 2) {
-            return "Invalid format for point coordinates.";
+        if (!TextProtocol::parseCommandPoint(input, 11, x, y)) {
+            response.append("Invalid format for point coordinates.");
+            return;
         }
 
         for (size_t i = 0; i < point_list.size(); ++i) {
             if (point_list[i].getX() == x && point_list[i].getY() == y) {
                 point_list[i] = point_list.back();
                 point_list.pop_back();
-                return "Point removed successfully.";
+                response.append("Point removed successfully.");
+                return;
             }
         }
-        return "Point not found.";
-    } else if (strncmp(input, "GenerateRandom", 14) == 0) {
-        point_list.clear();
-        point_list.reserve(10000000);
-        for (size_t i = 0; i < 10000000; ++i) {
-            point_list.emplace_back((float)rand() / RAND_MAX, (float)rand() / RAND_MAX);
-        }
+        response.append("Point not found.");
+    } else {
+        response.append("Unknown command.");
+    }
+}
+
+// Handles "GenerateRandom [n] [distribution] [seed]". The points are generated in
+// parallel into a fresh buffer without holding data_mutex; the lock only covers the swap.
+void generate_random(const char* input, size_t input_length, ResponseBuffer& response) {
+    size_t count = DEFAULT_RANDOM_POINTS;
+    PointDistribution distribution = DISTRIBUTION_UNIFORM;
+    uint64_t seed = 1;
+    if (!RandomPointGenerator::parseArguments(input + 14, input + input_length, count, distribution, seed)) {
+        response.append("Usage: GenerateRandom [n] [uniform|normal|disk|clustered] [seed]");
+        return;
+    }
 
-        return "Random points generated.";
+    if (count > MAX_RANDOM_POINTS) {
+        response.append("At most ");
+        response.appendUnsigned(MAX_RANDOM_POINTS);
+        response.append(" random points can be generated.");
+        return;
     }
 
-    return "Unknown command.";
+    // Checked before the work of generating, and again when the points are swapped in
+    pthread_mutex_lock(&data_mutex);
+    bool creating = remaining_points > 0;
+    pthread_mutex_unlock(&data_mutex);
+    if (creating) {
+        response.append("Another client is currently setting up the graph.");
+        return;
+    }
+
+    std::vector<Point> generated;
+    try {
+        RandomPointGenerator::generate(generated, count, distribution, seed);
+    } catch (const std::exception&) {
+        // bad_alloc, or length_error past max_size()
+        response.append("Not enough memory for that many points.");
+        return;
+    }
+
+    pthread_mutex_lock(&data_mutex);
+    creating = remaining_points > 0;
+    if (!creating) point_list.swap(generated);
+    pthread_mutex_unlock(&data_mutex);
+
+    if (creating) {
+        response.append("Another client is currently setting up the graph.");
+        return;
+    }
+    // The previous points are released here, after the lock
+    response.append("Random points generated.");
 }
 
 // Thread function for handling client messages
-void* client_message_handler(void* client_fd_ptr) {
-    int client_fd = *(int*)client_fd_ptr;
+void* client_message_handler(void* client_fd_arg) {
+    int client_fd = (int)(intptr_t)client_fd_arg;
+
+    char buffer[MESSAGE_BUFFER];
+    ResponseBuffer response;  // Reused for every reply on this connection
+    QueuedCommand queued_command;  // This connection's node in the command queue
 
     while (true) {
-        char buffer[MESSAGE_BUFFER] = {0};
-        ssize_t bytes_received = recv(client_fd, buffer, MESSAGE_BUFFER, 0);
+        ssize_t bytes_received = recv(client_fd, buffer, MESSAGE_BUFFER - 1, 0);
         if (bytes_received > 0) {
+            buffer[bytes_received] = '\0';
             cout << "Received from client " << client_fd << ": " << buffer;
 
-            pthread_mutex_lock(&data_mutex);
-            string response = execute_command(buffer, client_fd) + "\n>> ";
-            pthread_mutex_unlock(&data_mutex);
-
-            send(client_fd, response.c_str(), response.size(), 0);
+            response.clear();
+            if (strncmp(buffer, "GenerateRandom", 14) == 0) {
+                generate_random(buffer, bytes_received, response);
+            } else if (command_queue != nullptr) {
+                queued_command.input = buffer;
+                queued_command.length = bytes_received;
+                queued_command.clientFd = client_fd;
+                queued_command.response = &response;
+                command_queue->submit(queued_command);
+            } else {
+                pthread_mutex_lock(&data_mutex);
+                execute_command(buffer, bytes_received, client_fd, response);
+                pthread_mutex_unlock(&data_mutex);
+            }
+            if (response.size() > 0) {
+                response.append("\n>> ");
+                send(client_fd, response.data(), response.size(), 0);
+            }
         } else if (bytes_received == 0) {
             cout << "Client " << client_fd << " disconnected." << endl;
             close(client_fd);
@@ -137,37 +226,51 @@ void* client_message_handler(void* client_fd_ptr) {
     return nullptr;
 }
 
-// Thread function for accepting new client connections
-void* connection_handler(void* server_fd_ptr) {
-    int server_fd = *(int*)server_fd_ptr;
-
+// State owner of actor mode: executes queued commands a batch at a time, taking
+// data_mutex once per batch; only GenerateRandom's swap still contends for it
+void* state_owner(void*) {
+    QueuedCommand* batch[COMMAND_BATCH_SIZE];
     while (true) {
-        struct sockaddr_in client_addr;
-        socklen_t client_addr_len = sizeof(client_addr);
-        int client_fd = accept(server_fd, (struct sockaddr*)&client_addr, &client_addr_len);
-        if (client_fd == -1) {
-            perror("accept");
-            continue;
+        size_t count = command_queue->popBatch(batch, COMMAND_BATCH_SIZE);
+        pthread_mutex_lock(&data_mutex);
+        for (size_t i = 0; i < count; ++i) {
+            QueuedCommand& command = *batch[i];
+            execute_command(command.input, command.length, command.clientFd, *command.response);
+            command.done.complete();
         }
+        pthread_mutex_unlock(&data_mutex);
+    }
+    return nullptr;
+}
 
-        cout << "New client connected: " << client_fd << endl;
-        send(client_fd, ">> ", 3, 0);
+// Thread function for accepting new client connections
+void* connection_handler(void* acceptor_ptr) {
+    Acceptor& acceptor = *(Acceptor*)acceptor_ptr;
 
-        pthread_t client_thread;
-        if (pthread_create(&client_thread, nullptr, client_message_handler, &client_fd) != 0) {
-            perror("pthread_create");
-            close(client_fd);
-            continue;
-        }
+    while (true) {
+        if (!acceptor.wait(ACCEPT_POLL_MS)) continue;
+
+        for (int client_fd : acceptor.acceptBatch()) {
+            cout << "New client connected: " << client_fd << endl;
+            send(client_fd, ">> ", 3, MSG_NOSIGNAL);
+
+            // The descriptor travels by value; a pointer to it would be overwritten by the next accept
+            pthread_t client_thread;
+            if (pthread_create(&client_thread, nullptr, client_message_handler, (void*)(intptr_t)client_fd) != 0) {
+                perror("pthread_create");
+                close(client_fd);
+                continue;
+            }
 
-        pthread_detach(client_thread);
+            pthread_detach(client_thread);
+        }
     }
 
     return nullptr;
 }
 
-// Sets up the server listener socket
-int setup_server_socket() {
+// Sets up the server socket and starts the acceptor listening on it
+int setup_server_socket(Acceptor& acceptor) {
     int listener;
     int reuse_addr = 1;
     struct addrinfo hints, *res, *p;
@@ -193,26 +296,52 @@ int setup_server_socket() {
 
     freeaddrinfo(res);
 
-    if (!p || listen(listener, 10) == -1) return -1;
+    if (!p || !acceptor.listen(listener)) return -1;
 
     return listener;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     signal(SIGINT, signal_handler);
 
+    // -b, -a and -D set the listen backlog, accept budget and TCP_DEFER_ACCEPT seconds,
+    // -A runs commands on a single state-owner thread fed by a lock-free queue
+    AcceptOptions accept_options;
+    bool actor_mode = false;
+    int option;
+    while ((option = getopt(argc, argv, "b:a:D:A")) != -1) {
+        if (option == 'A') {
+            actor_mode = true;
+        } else if (!accept_options.parse(option, optarg)) {
+            fprintf(stderr, "Usage: %s [-b listen_backlog] [-a accept_budget] [-D defer_accept_seconds] [-A]\n", argv[0]);
+            return 1;
+        }
+    }
+
     if (pthread_mutex_init(&data_mutex, nullptr) != 0) {
         perror("Failed to initialize mutex.");
         return 1;
     }
 
-    server_socket = setup_server_socket();
+    if (actor_mode) {
+        command_queue = new CommandQueue();
+        pthread_t owner_thread;
+        if (pthread_create(&owner_thread, nullptr, state_owner, nullptr) != 0) {
+            perror("Failed to create state owner thread.");
+            return 1;
+        }
+        pthread_detach(owner_thread);
+    }
+
+    // Each client gets a thread that blocks in recv, so its socket stays blocking
+    Acceptor acceptor(accept_options, 0);
+    server_socket = setup_server_socket(acceptor);
     if (server_socket == -1) {
         perror("Failed to initialize server socket.");
         return 1;
     }
 
-    if (pthread_create(&connection_thread, nullptr, connection_handler, &server_socket) != 0) {
+    if (pthread_create(&connection_thread, nullptr, connection_handler, &acceptor) != 0) {
         perror("Failed to create connection thread.");
         return 1;
     }
@@ -0,0 +1,85 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <unistd.h>
+#include "Acceptor.hpp"
+
+bool AcceptOptions::parse(int option, const char* value) {
+    char* end;
+    long number = strtol(value, &end, 10);
+    if (end == value || *end != '\0' || number < 0) return false;
+
+    switch (option) {
+    case 'b': backlog = number > 0 ? (int)number : ACCEPT_DEFAULT_BACKLOG; return true;
+    case 'a': budget = number > 0 ? (size_t)number : 1; return true;
+    case 'D': deferSeconds = (int)number; return true;
+    default: return false;
+    }
+}
+
+Acceptor::Acceptor(const AcceptOptions& options, int clientFlags)
+    : listenFd(-1), spareFd(open("/dev/null", O_RDONLY | O_CLOEXEC)),
+      acceptFlags(clientFlags | SOCK_CLOEXEC), options(options) {
+    accepted.reserve(options.budget);
+}
+
+Acceptor::~Acceptor() {
+    if (spareFd >= 0) close(spareFd);
+}
+
+bool Acceptor::listen(int socketFd) {
+    int flags = fcntl(socketFd, F_GETFL, 0);
+    if (flags == -1 || fcntl(socketFd, F_SETFL, flags | O_NONBLOCK) == -1) return false;
+
+    if (options.deferSeconds > 0 &&
+        setsockopt(socketFd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &options.deferSeconds, sizeof(int)) == -1)
+        perror("setsockopt TCP_DEFER_ACCEPT");
+
+    if (::listen(socketFd, options.backlog) == -1) return false;
+    listenFd = socketFd;
+    return true;
+}
+
+bool Acceptor::wait(int timeoutMs) {
+    struct pollfd listener = {listenFd, POLLIN, 0};
+    int ready = poll(&listener, 1, timeoutMs);
+    return ready > 0 && !(listener.revents & POLLNVAL);
+}
+
+const std::vector<int>& Acceptor::acceptBatch() {
+    accepted.clear();
+    while (accepted.size() < options.budget) {
+        int clientFd = accept4(listenFd, nullptr, nullptr, acceptFlags);
+        if (clientFd >= 0) {
+            accepted.push_back(clientFd);
+            continue;
+        }
+
+        switch (errno) {
+        case EAGAIN:
+            return accepted; // Queue drained
+        case EINTR:
+        case ECONNABORTED:
+        case EPROTO:
+            continue; // This connection went away; the next one may be fine
+        case EMFILE:
+        case ENFILE:
+            // Out of descriptors: use the spare one to accept and drop one connection
+            if (spareFd >= 0) {
+                close(spareFd);
+                int dropped = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+                if (dropped >= 0) close(dropped);
+                spareFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+            }
+            return accepted;
+        default:
+            perror("accept4");
+            return accepted;
+        }
+    }
+    return accepted;
+}
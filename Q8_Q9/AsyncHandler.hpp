@@ -5,8 +5,11 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <vector>
+#include <poll.h>
+#include "Acceptor.hpp"
 
-#define MAX_CLIENT_EVENTS 10
+#define ACCEPT_POLL_MS 100 // How often the accept thread checks for shutdown
 
 /**
  * @brief Function pointer type for handling events in a Reactor.
@@ -20,8 +23,7 @@ typedef void (*EventHandler)(int fd);
 class AsyncReactor {
 private:
     bool active;
-    struct pollfd* eventFds;
-    unsigned int eventCount;
+    std::vector<struct pollfd> eventFds;
     std::unordered_map<int, EventHandler> eventHandlers;
 
 public:
@@ -54,7 +56,11 @@ public:
     AsyncProactor();
     ~AsyncProactor();
 
-    void start(int socketFd, ClientHandler clientHandler);
+    /**
+     * @brief Accepts clients in batches from @p acceptor, which must be listening, and runs
+     * @p clientHandler on a thread per client until shutdown().
+     */
+    void start(Acceptor& acceptor, ClientHandler clientHandler);
     void shutdown();
 
 private:
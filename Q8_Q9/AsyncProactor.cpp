@@ -11,35 +11,34 @@ AsyncProactor::~AsyncProactor() {
     shutdown();
 }
 
-void AsyncProactor::start(int socketFd, ClientHandler clientHandler) {
+void AsyncProactor::start(Acceptor& acceptor, ClientHandler clientHandler) {
     active = true;
-    serverSocketFd = socketFd;
+    serverSocketFd = acceptor.fd();
 
     // Start a thread to handle new client connections
-    connectionThread = std::thread([this, clientHandler] {
-        struct sockaddr_storage clientAddress;
-        socklen_t addressSize = sizeof(clientAddress);
-
+    connectionThread = std::thread([this, &acceptor, clientHandler] {
         while (active) {
-            int clientSocketFd = accept(serverSocketFd, (struct sockaddr*)&clientAddress, &addressSize);
-            if (clientSocketFd == -1) {
-                if (!active) break; // Exit if the server is stopping
-                perror("accept");
-                continue;
+            // Wake up now and then to notice shutdown
+            if (!acceptor.wait(ACCEPT_POLL_MS)) continue;
+
+            for (int clientSocketFd : acceptor.acceptBatch()) {
+                // Log the client connection
+                struct sockaddr_storage clientAddress;
+                socklen_t addressSize = sizeof(clientAddress);
+                char addressBuffer[INET6_ADDRSTRLEN] = "unknown";
+                if (getpeername(clientSocketFd, (struct sockaddr*)&clientAddress, &addressSize) == 0) {
+                    inet_ntop(clientAddress.ss_family, extractAddress((struct sockaddr*)&clientAddress),
+                              addressBuffer, sizeof(addressBuffer));
+                }
+                std::cout << "Server: received connection from " << addressBuffer << std::endl;
+                send(clientSocketFd, ">> ", 3, MSG_NOSIGNAL);
+
+                // Spawn a new thread to handle the client
+                std::thread clientThread([clientSocketFd, clientHandler, mutexRef = std::ref(handlerMutex)] {
+                    clientHandler(clientSocketFd, mutexRef);
+                });
+                clientThread.detach();
             }
-
-            // Log the client connection
-            char addressBuffer[INET6_ADDRSTRLEN];
-            inet_ntop(clientAddress.ss_family, extractAddress((struct sockaddr*)&clientAddress), 
-                      addressBuffer, sizeof(addressBuffer));
-            std::cout << "Server: received connection from " << addressBuffer << std::endl;
-            send(clientSocketFd, ">> ", 3, 0);
-
-            // Spawn a new thread to handle the client
-            std::thread clientThread([clientSocketFd, clientHandler, mutexRef = std::ref(handlerMutex)] {
-                clientHandler(clientSocketFd, mutexRef);
-            });
-            clientThread.detach();
         }
     });
 
@@ -8,20 +8,16 @@
 /**
  * @brief Constructor for AsyncReactor, initializes internal structures for managing events.
  */
-AsyncReactor::AsyncReactor() : active(false), eventCount(0) {
-    eventFds = new struct pollfd[MAX_CLIENT_EVENTS];
-    eventHandlers.reserve(MAX_CLIENT_EVENTS);
-}
+AsyncReactor::AsyncReactor() : active(false) {}
 
 /**
  * @brief Destructor for AsyncReactor, releases resources and closes all file descriptors.
  */
 AsyncReactor::~AsyncReactor() {
     active = false;
-    for (unsigned int i = 0; i < eventCount; i++) {
-        close(eventFds[i].fd);
+    for (const struct pollfd& eventFd : eventFds) {
+        close(eventFd.fd);
     }
-    delete[] eventFds;
 }
 
 /**
@@ -30,7 +26,7 @@ AsyncReactor::~AsyncReactor() {
  * @param handler The event handler function to call when the file descriptor is ready.
  */
 void AsyncReactor::addFileDescriptor(int fd, EventHandler handler) {
-    eventFds[eventCount++] = {fd, POLLIN, 0};
+    eventFds.push_back({fd, POLLIN, 0});
     eventHandlers[fd] = handler;
 }
 
@@ -39,19 +35,15 @@ void AsyncReactor::addFileDescriptor(int fd, EventHandler handler) {
  * @param fd The file descriptor to remove.
  */
 void AsyncReactor::removeFileDescriptor(int fd) {
-    unsigned int index = MAX_CLIENT_EVENTS + 1;
-    for (unsigned int i = 0; i < eventCount; i++) {
+    for (size_t i = 0; i < eventFds.size(); i++) {
         if (eventFds[i].fd == fd) {
-            index = i;
-            break;
+            // Replace the removed fd with the last fd in the array
+            eventFds[i] = eventFds.back();
+            eventFds.pop_back();
+            eventHandlers.erase(fd);
+            return;
         }
     }
-    if (index == MAX_CLIENT_EVENTS + 1) return;
-
-    // Replace the removed fd with the last fd in the array
-    eventFds[index] = eventFds[eventCount - 1];
-    eventCount--;
-    eventHandlers.erase(fd);
 }
 
 /**
@@ -61,7 +53,7 @@ void AsyncReactor::start() {
     active = true;
 
     while (active) {
-        int readyEvents = poll(eventFds, eventCount, -1);
+        int readyEvents = poll(eventFds.data(), eventFds.size(), -1);
 
         if (readyEvents == -1) {
             if (errno == EINTR) {
@@ -74,7 +66,8 @@ void AsyncReactor::start() {
 
         // Process all triggered events
         if (readyEvents > 0) {
-            for (unsigned int i = 0; i < eventCount; i++) {
+            // Handlers may add or remove descriptors, so the array is indexed afresh each time
+            for (size_t i = 0; i < eventFds.size(); i++) {
                 if (eventFds[i].revents & POLLIN) {
                     eventFds[i].revents = 0; // Clear the event flag
                     eventHandlers[eventFds[i].fd](eventFds[i].fd);
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <utility>
+#include "BatchHull.hpp"
+#include "PointSort.hpp"
+
+#define BATCH_MIN_POINTS_PER_THREAD 65536 // Below this, starting a thread costs more than it saves
+
+/**
+ * @brief One compare-exchange of a sorting network: afterwards @c low holds the smaller element.
+ */
+struct Comparator {
+    uint8_t low;
+    uint8_t high;
+};
+
+/**
+ * @brief Batcher's odd-even merge sort on N elements, N a power of two.
+ *
+ * Writes the comparators to @p network (when it is not null) and returns how many there are.
+ */
+template <size_t N>
+constexpr size_t oddEvenMergeSort(Comparator* network) {
+    size_t count = 0;
+    for (size_t p = 1; p < N; p *= 2)
+        for (size_t k = p; k > 0; k /= 2)
+            for (size_t j = k % p; j + k < N; j += 2 * k)
+                for (size_t i = 0; i < k && i + j + k < N; ++i)
+                    if ((i + j) / (2 * p) == (i + j + k) / (2 * p)) {
+                        if (network) network[count] = Comparator{(uint8_t)(i + j), (uint8_t)(i + j + k)};
+                        count++;
+                    }
+    return count;
+}
+
+template <size_t N, size_t SIZE>
+constexpr std::array<Comparator, SIZE> buildNetwork() {
+    std::array<Comparator, SIZE> network{};
+    oddEvenMergeSort<N>(network.data());
+    return network;
+}
+
+/**
+ * @brief The sorting network for N elements, computed by the compiler.
+ */
+template <size_t N>
+struct SortingNetwork {
+    static constexpr size_t SIZE = oddEvenMergeSort<N>(nullptr);
+    static constexpr std::array<Comparator, SIZE> COMPARATORS = buildNetwork<N, SIZE>();
+};
+
+// Both results are selects rather than branches, so the compiler emits conditional moves
+static inline void compareExchange(uint64_t& a, uint64_t& b) {
+    uint64_t low = a < b ? a : b;
+    uint64_t high = a < b ? b : a;
+    a = low;
+    b = high;
+}
+
+// Expands to one compare-exchange per comparator, with every index a constant
+template <size_t N, size_t... I>
+static inline void applyNetwork(uint64_t* keys, std::index_sequence<I...>) {
+    (compareExchange(keys[SortingNetwork<N>::COMPARATORS[I].low], keys[SortingNetwork<N>::COMPARATORS[I].high]), ...);
+}
+
+template <size_t N>
+static void networkSort(uint64_t* keys) {
+    applyNetwork<N>(keys, std::make_index_sequence<SortingNetwork<N>::SIZE>());
+}
+
+/**
+ * @brief Sorts a group of at most BATCH_NETWORK_MAX_POINTS points into @p sorted.
+ *
+ * The points' 64-bit keys are padded with keys that sort last to 8, 16 or 32 and run
+ * through the network of that width.
+ */
+template <class T>
+static void sortSmallGroup(const BasicPoint<T>* group, size_t count, BasicPoint<T>* sorted) {
+    uint64_t keys[BATCH_NETWORK_MAX_POINTS];
+    size_t width = count <= 8 ? 8 : count <= 16 ? 16 : 32;
+    for (size_t i = 0; i < count; ++i) keys[i] = pointKey(group[i]);
+    for (size_t i = count; i < width; ++i) keys[i] = std::numeric_limits<uint64_t>::max();
+
+    if (width == 8) networkSort<8>(keys);
+    else if (width == 16) networkSort<16>(keys);
+    else networkSort<32>(keys);
+
+    for (size_t i = 0; i < count; ++i) sorted[i] = keyPoint<T>(keys[i]);
+}
+
+// double points have no 64-bit key; compared as points the network loses to std::sort
+template <>
+void sortSmallGroup(const DoublePoint* group, size_t count, DoublePoint* sorted) {
+    std::copy(group, group + count, sorted);
+    std::sort(sorted, sorted + count);
+}
+
+/**
+ * @brief Monotone chain over sorted points into @p chain, which has room for count + 1 points.
+ *
+ * Same steps as BasicConvexHull::findConvexHullOfSorted, without the vector.
+ *
+ * @return The number of hull vertices at the front of @p chain.
+ */
+template <class T>
+static size_t chainOfSorted(const BasicPoint<T>* points, size_t count, BasicPoint<T>* chain) {
+    if (count < 3) {
+        std::copy(points, points + count, chain);
+        return count;
+    }
+
+    size_t size = 0;
+    for (size_t i = 0; i < count; ++i) {
+        while (size >= 2 && chain[size - 2].cross(chain[size - 1], points[i]) >= 0) size--;
+        chain[size++] = points[i];
+    }
+    for (size_t i = count - 1, lowerSize = size + 1; i > 0; --i) {
+        while (size >= lowerSize && chain[size - 2].cross(chain[size - 1], points[i - 1]) >= 0) size--;
+        chain[size++] = points[i - 1];
+    }
+    return size - 1; // The last point repeats the first
+}
+
+// Shoelace formula, summed in the same order as BasicConvexHull::computeEnclosedArea
+template <class T>
+static typename CoordinateTraits<T>::Area enclosedArea(const BasicPoint<T>* hull, size_t count) {
+    typedef typename BasicPoint<T>::Wide Wide;
+    Wide total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const BasicPoint<T>& current = hull[i];
+        const BasicPoint<T>& next = hull[(i + 1) % count];
+        total += (Wide)current.getX() * next.getY() - (Wide)current.getY() * next.getX();
+    }
+    return (typename CoordinateTraits<T>::Area)(std::abs(total) / 2.0);
+}
+
+/**
+ * @brief Computes the hulls of groups [first, last) on the calling thread.
+ */
+template <class T>
+static void hullsOfGroups(const BasicPoint<T>* points, const size_t* offsets, size_t first, size_t last,
+                          BasicPoint<T>* hulls, size_t* hullSizes, typename CoordinateTraits<T>::Area* areas) {
+    BasicPoint<T> sortedSmall[BATCH_NETWORK_MAX_POINTS];
+    BasicPoint<T> chainSmall[BATCH_NETWORK_MAX_POINTS + 1];
+    vector<BasicPoint<T>> sortedLarge, chainLarge;
+
+    for (size_t g = first; g < last; ++g) {
+        const BasicPoint<T>* group = points + offsets[g];
+        size_t count = offsets[g + 1] - offsets[g];
+        const BasicPoint<T>* sorted;
+        BasicPoint<T>* chain;
+
+        if (count <= BATCH_NETWORK_MAX_POINTS) {
+            sortSmallGroup(group, count, sortedSmall);
+            sorted = sortedSmall;
+            chain = chainSmall;
+        } else {
+            sortedLarge.assign(group, group + count);
+            std::sort(sortedLarge.begin(), sortedLarge.end());
+            chainLarge.resize(count + 1);
+            sorted = sortedLarge.data();
+            chain = chainLarge.data();
+        }
+
+        size_t size = chainOfSorted(sorted, count, chain);
+        std::copy(chain, chain + size, hulls + offsets[g]);
+        hullSizes[g] = size;
+        areas[g] = enclosedArea(chain, size);
+    }
+}
+
+template <class T>
+void BatchHull<T>::compute(const PointType* points, const size_t* offsets, size_t groupCount, PointType* hulls,
+                           size_t* hullSizes, Area* areas, unsigned int threads) {
+    if (groupCount == 0) return;
+
+    size_t totalPoints = offsets[groupCount] - offsets[0];
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t maxThreads = std::min(groupCount, std::max<size_t>(1, totalPoints / BATCH_MIN_POINTS_PER_THREAD));
+    if (threads > maxThreads) threads = maxThreads;
+
+    // Split at group boundaries so that every thread gets about the same number of points
+    vector<size_t> bounds(threads + 1, groupCount);
+    bounds[0] = 0;
+    for (unsigned int t = 1; t < threads; ++t)
+        bounds[t] = std::lower_bound(offsets, offsets + groupCount, offsets[0] + totalPoints * t / threads) - offsets;
+
+    vector<std::thread> workers;
+    for (unsigned int t = 0; t + 1 < threads; ++t)
+        workers.emplace_back(hullsOfGroups<T>, points, offsets, bounds[t], bounds[t + 1], hulls, hullSizes, areas);
+    hullsOfGroups(points, offsets, bounds[threads - 1], bounds[threads], hulls, hullSizes, areas);
+
+    for (std::thread& worker : workers) worker.join();
+}
+
+template class BatchHull<int32_t>;
+template class BatchHull<float>;
+template class BatchHull<double>;
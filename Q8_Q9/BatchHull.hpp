@@ -0,0 +1,51 @@
+#ifndef BATCH_HULL_HPP
+#define BATCH_HULL_HPP
+
+#include <cstddef>
+#include <vector>
+#include "ConvexHull.hpp"
+
+using std::vector;
+
+#define BATCH_NETWORK_MAX_POINTS 32 // Groups up to this size are sorted by a fixed sorting network
+
+/**
+ * @brief Hulls and areas of many small point groups in one call.
+ *
+ * The groups are packed back to back in one buffer and described by their offsets,
+ * so no group needs an allocation of its own. For int and float, groups of up to
+ * BATCH_NETWORK_MAX_POINTS points are padded to 8, 16 or 32 and sorted by a sorting
+ * network built at compile time: a fixed, branch-free sequence of compare-exchanges
+ * on the points' 64-bit keys. Larger groups, and double groups, use std::sort. The
+ * sorted group then goes through the monotone chain.
+ */
+template <class T>
+class BatchHull {
+public:
+    typedef BasicPoint<T> PointType;
+    typedef typename CoordinateTraits<T>::Area Area;
+
+    /**
+     * @brief Computes the hull and area of every group of a packed point buffer.
+     *
+     * A hull never has more vertices than its group has points, so each group's hull
+     * is written to the same range of @p hulls that the group occupies in @p points.
+     * @p hulls may be @p points itself.
+     *
+     * @param points The groups' points, back to back.
+     * @param offsets groupCount + 1 entries; group g is points[offsets[g] .. offsets[g + 1]).
+     * @param groupCount Number of groups.
+     * @param hulls Receives the hulls: group g's starts at hulls[offsets[g]], counter-clockwise.
+     * @param hullSizes Receives the number of vertices of each group's hull.
+     * @param areas Receives the area of each group's hull.
+     * @param threads Worker threads, each taking a contiguous run of groups; 0 uses every hardware thread.
+     */
+    static void compute(const PointType* points, const size_t* offsets, size_t groupCount, PointType* hulls,
+                        size_t* hullSizes, Area* areas, unsigned int threads = 0);
+};
+
+extern template class BatchHull<int32_t>;
+extern template class BatchHull<float>;
+extern template class BatchHull<double>;
+
+#endif // BATCH_HULL_HPP
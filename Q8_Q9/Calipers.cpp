@@ -0,0 +1,127 @@
+#include <cmath>
+#include <limits>
+#include "Calipers.hpp"
+
+// Distance of vertex @p j from the line of edge (i, i + 1), times the edge's length
+template <class T>
+static typename BasicPoint<T>::Wide height(const vector<BasicPoint<T>>& hull, size_t i, size_t j) {
+    size_t count = hull.size();
+    return -hull[i].cross(hull[(i + 1) % count], hull[j % count]);
+}
+
+template <class T>
+static typename BasicPoint<T>::Wide squaredDistance(const BasicPoint<T>& a, const BasicPoint<T>& b) {
+    typedef typename BasicPoint<T>::Wide Wide;
+    Wide dx = (Wide)b.getX() - a.getX(), dy = (Wide)b.getY() - a.getY();
+    return dx * dx + dy * dy;
+}
+
+/**
+ * @brief The farthest pair is antipodal: for each edge, the vertex farthest from its line
+ * paired with either end of the edge.
+ */
+template <class T>
+double RotatingCalipers<T>::diameter(const vector<PointType>& hull, PointType& from, PointType& to) {
+    typedef typename PointType::Wide Wide;
+    size_t count = hull.size();
+    if (count < 2) {
+        from = to = count == 1 ? hull[0] : PointType();
+        return 0;
+    }
+
+    Wide best = -1;
+    size_t far = 1;
+    for (size_t i = 0; i < count; ++i) {
+        size_t next = (i + 1) % count;
+        while (count > 2 && height(hull, i, far + 1) > height(hull, i, far)) far = (far + 1) % count;
+
+        size_t ends[2] = {i, next};
+        for (size_t end : ends) {
+            Wide distance = squaredDistance(hull[end], hull[far]);
+            if (distance > best) {
+                best = distance;
+                from = hull[end];
+                to = hull[far];
+            }
+        }
+    }
+    return sqrt((double)best);
+}
+
+template <class T>
+double RotatingCalipers<T>::width(const vector<PointType>& hull, size_t& edge) {
+    size_t count = hull.size();
+    if (count < 3) return -1;
+
+    double best = std::numeric_limits<double>::infinity();
+    size_t far = 1;
+    for (size_t i = 0; i < count; ++i) {
+        while (height(hull, i, far + 1) > height(hull, i, far)) far = (far + 1) % count;
+
+        double distance = (double)height(hull, i, far) / sqrt((double)squaredDistance(hull[i], hull[(i + 1) % count]));
+        if (distance < best) {
+            best = distance;
+            edge = i;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief For each edge as the base, three calipers track the vertices farthest along the edge,
+ * farthest from it, and farthest back along it, which fix the other three sides.
+ */
+template <class T>
+double RotatingCalipers<T>::minimumRectangle(const vector<PointType>& hull, double corners[4][2]) {
+    typedef typename PointType::Wide Wide;
+    size_t count = hull.size();
+    if (count < 3) return -1;
+
+    double best = std::numeric_limits<double>::infinity();
+    size_t ahead = 1, far = 1, behind = 1;
+    for (size_t i = 0; i < count; ++i) {
+        const PointType& base = hull[i];
+        const PointType& next = hull[(i + 1) % count];
+        Wide edgeX = (Wide)next.getX() - base.getX(), edgeY = (Wide)next.getY() - base.getY();
+
+        // Projection on the edge direction, times the edge's length
+        auto along = [&](size_t k) {
+            const PointType& vertex = hull[k % count];
+            return ((Wide)vertex.getX() - base.getX()) * edgeX + ((Wide)vertex.getY() - base.getY()) * edgeY;
+        };
+
+        // Counter-clockwise from the edge come the vertices farthest ahead, then up, then behind
+        while (along(ahead + 1) > along(ahead)) ahead = (ahead + 1) % count;
+        if (i == 0) far = ahead;
+        while (height(hull, i, far + 1) > height(hull, i, far)) far = (far + 1) % count;
+        if (i == 0) behind = far;
+        while (along(behind + 1) < along(behind)) behind = (behind + 1) % count;
+
+        double length2 = (double)edgeX * edgeX + (double)edgeY * edgeY;
+        double maxAlong = (double)along(ahead), minAlong = (double)along(behind);
+        double up = (double)height(hull, i, far);
+        double area = (maxAlong - minAlong) * up / length2;
+        if (area >= best) continue;
+        best = area;
+
+        // Corners from the base vertex, along the unit edge direction and the inward normal
+        double length = sqrt(length2);
+        double unitX = edgeX / length, unitY = edgeY / length;
+        minAlong /= length;
+        maxAlong /= length;
+        up /= length;
+        corners[0][0] = base.getX() + unitX * minAlong;
+        corners[0][1] = base.getY() + unitY * minAlong;
+        corners[1][0] = base.getX() + unitX * maxAlong;
+        corners[1][1] = base.getY() + unitY * maxAlong;
+        corners[2][0] = corners[1][0] - unitY * up;
+        corners[2][1] = corners[1][1] + unitX * up;
+        corners[3][0] = corners[0][0] - unitY * up;
+        corners[3][1] = corners[0][1] + unitX * up;
+    }
+    return best;
+}
+
+template class RotatingCalipers<int32_t>;
+template class RotatingCalipers<float>;
+template class RotatingCalipers<double>;
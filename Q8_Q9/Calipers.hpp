@@ -0,0 +1,59 @@
+#ifndef ROTATING_CALIPERS_HPP
+#define ROTATING_CALIPERS_HPP
+
+#include <cstddef>
+#include <vector>
+#include "ConvexHull.hpp"
+
+using std::vector;
+
+/**
+ * @brief Rotating calipers over a computed hull: diameter, width and minimum-area rectangle.
+ *
+ * The hull is counter-clockwise with no collinear vertices, as BasicConvexHull produces it.
+ * Each measure walks the edges once while the calipers' contact vertices only move forward,
+ * so each takes O(h).
+ */
+template <class T>
+class RotatingCalipers {
+public:
+    typedef BasicPoint<T> PointType;
+
+    /**
+     * @brief The farthest pair of hull vertices.
+     *
+     * @param hull The hull vertices.
+     * @param from Receives one end of the diameter.
+     * @param to Receives the other end.
+     * @return The distance between them, 0 for a hull of one point.
+     */
+    static double diameter(const vector<PointType>& hull, PointType& from, PointType& to);
+
+    /**
+     * @brief The minimum width: the smallest distance between two parallel lines enclosing the hull.
+     *
+     * One of the lines always runs along a hull edge.
+     *
+     * @param hull The hull vertices.
+     * @param edge Receives the index of that edge's first vertex.
+     * @return The width, or -1 if the hull has fewer than three vertices.
+     */
+    static double width(const vector<PointType>& hull, size_t& edge);
+
+    /**
+     * @brief The enclosing rectangle of minimum area.
+     *
+     * One of its sides always runs along a hull edge.
+     *
+     * @param hull The hull vertices.
+     * @param corners Receives the corners, counter-clockwise, as x, y pairs.
+     * @return The rectangle's area, or -1 if the hull has fewer than three vertices.
+     */
+    static double minimumRectangle(const vector<PointType>& hull, double corners[4][2]);
+};
+
+extern template class RotatingCalipers<int32_t>;
+extern template class RotatingCalipers<float>;
+extern template class RotatingCalipers<double>;
+
+#endif // ROTATING_CALIPERS_HPP
@@ -0,0 +1,95 @@
+#ifndef COMMAND_QUEUE_HPP
+#define COMMAND_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Protocol.hpp"
+
+#define COMMAND_SPIN_COUNT 128 // Polls of a completion slot before its waiter sleeps
+#define COMMAND_BATCH_SIZE 64  // Commands the state owner takes from the queue at a time
+
+/**
+ * @brief Where the state owner reports that a command is done.
+ *
+ * The waiter spins briefly, then sleeps on a futex. The owner only makes the
+ * wake-up system call when the waiter has actually gone to sleep.
+ */
+class CompletionSlot {
+private:
+    enum { PENDING = 0, DONE = 1, SLEEPING = 2 };
+    std::atomic<uint32_t> state;
+
+public:
+    CompletionSlot() : state(PENDING) {}
+
+    void reset() { state.store(PENDING, std::memory_order_relaxed); }
+
+    /**
+     * @brief Called by the state owner; everything it wrote before is visible to the waiter.
+     */
+    void complete();
+
+    /**
+     * @brief Blocks until complete() has been called.
+     */
+    void wait();
+};
+
+/**
+ * @brief A command handed to the state owner, with room for its result.
+ *
+ * Each connection owns one and has at most one command in flight, so the queue
+ * links these nodes directly and never allocates.
+ */
+struct QueuedCommand {
+    std::atomic<QueuedCommand*> next;
+    const char* input;
+    size_t length;
+    int clientFd;
+    void* context;         // Executor-defined, e.g. the graph the command is for
+    ResponseBuffer* response;
+    int result;            // Set by the executor, e.g. the command's verb
+    CompletionSlot done;
+
+    QueuedCommand() : next(nullptr), input(nullptr), length(0), clientFd(-1), context(nullptr), response(nullptr), result(0) {}
+};
+
+/**
+ * @brief Lock-free multi-producer, single-consumer queue of commands (Vyukov's intrusive queue).
+ *
+ * A producer links its node with one atomic exchange, whatever the number of
+ * producers. Only the state owner thread may call popBatch(). When the queue is
+ * empty, the owner sleeps on a futex that producers wake only when it is asleep.
+ */
+class CommandQueue {
+private:
+    alignas(64) std::atomic<QueuedCommand*> head; // Producers swap themselves in here
+    alignas(64) QueuedCommand* tail;              // Owned by the consumer
+    std::atomic<uint32_t> consumerSleeping;
+    QueuedCommand stub;
+
+    void push(QueuedCommand* command);
+    QueuedCommand* pop();
+    bool empty() const;
+
+public:
+    CommandQueue();
+
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+
+    /**
+     * @brief Queues @p command for the state owner and waits until it has been executed.
+     */
+    void submit(QueuedCommand& command);
+
+    /**
+     * @brief State owner only: waits for at least one command and takes up to @p capacity.
+     *
+     * @return The number of commands written to @p batch. The owner calls done.complete() on each.
+     */
+    size_t popBatch(QueuedCommand** batch, size_t capacity);
+};
+
+#endif // COMMAND_QUEUE_HPP
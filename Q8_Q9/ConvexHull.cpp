@@ -1,46 +1,117 @@
 #include <complex>
 #include "ConvexHull.hpp"
+#include "PointSort.hpp"
+
+#define HULL_INITIAL_CAPACITY 64 // Typical hulls of random inputs fit without regrowing
 
 /**
  * @brief Calculates the area enclosed by the convex hull points using the shoelace formula.
+ *
+ * The sum is accumulated in the coordinate type's wide type, so for int32_t it is exact.
  */
-float ConvexHullUtility::computeEnclosedArea(vector<Point>& points) {
+template <class T>
+typename BasicConvexHull<T>::Area BasicConvexHull<T>::computeEnclosedArea(const vector<PointType>& points) {
+    typedef typename PointType::Wide Wide;
     size_t numPoints = points.size();
-    float totalArea = 0.0;
+    Wide totalArea = 0;
 
     for (size_t i = 0; i < numPoints; ++i) {
-        const Point& current = points[i];
-        const Point& next = points[(i + 1) % numPoints]; // Wrap around to the first point
-        totalArea += current.getX() * next.getY() - current.getY() * next.getX();
+        const PointType& current = points[i];
+        const PointType& next = points[(i + 1) % numPoints]; // Wrap around to the first point
+        totalArea += (Wide)current.getX() * next.getY() - (Wide)current.getY() * next.getX();
+    }
+
+    return (Area)(std::abs(totalArea) / 2.0);
+}
+
+/**
+ * @brief The shoelace terms give the area and, weighted by each edge's midpoint, the centroid.
+ *
+ * The closing edge is handled after the loop, so the loop body has no wrap-around and
+ * the independent sums can be evaluated in vector registers.
+ */
+template <class T>
+typename BasicConvexHull<T>::Shape BasicConvexHull<T>::computeShape(const vector<PointType>& points) {
+    typedef typename PointType::Wide Wide;
+    Shape shape = {0, 0, 0, 0};
+    size_t numPoints = points.size();
+    if (numPoints == 0) return shape;
+
+    Wide twiceArea = 0;
+    double perimeter = 0, momentX = 0, momentY = 0, sumX = 0, sumY = 0;
+    auto addEdge = [&](const PointType& current, const PointType& next) {
+        Wide term = (Wide)current.getX() * next.getY() - (Wide)current.getY() * next.getX();
+        double dx = (double)next.getX() - current.getX(), dy = (double)next.getY() - current.getY();
+        twiceArea += term;
+        perimeter += sqrt(dx * dx + dy * dy);
+        momentX += ((double)current.getX() + next.getX()) * (double)term;
+        momentY += ((double)current.getY() + next.getY()) * (double)term;
+        sumX += current.getX();
+        sumY += current.getY();
+    };
+    for (size_t i = 0; i + 1 < numPoints; ++i) addEdge(points[i], points[i + 1]);
+    addEdge(points[numPoints - 1], points[0]);
+
+    shape.area = (Area)(std::abs(twiceArea) / 2.0);
+    shape.perimeter = perimeter;
+    if (twiceArea == 0) {
+        shape.centroidX = sumX / numPoints;
+        shape.centroidY = sumY / numPoints;
+    } else {
+        shape.centroidX = momentX / (3 * (double)twiceArea);
+        shape.centroidY = momentY / (3 * (double)twiceArea);
     }
+    return shape;
+}
+
+/**
+ * @brief Computes the convex hull of a given set of points using Andrew's monotone chain.
+ */
+template <class T>
+vector<typename BasicConvexHull<T>::PointType> BasicConvexHull<T>::findConvexHull(PointVector<T>& points,
+                                                                                  HullMemoryMode mode) {
+    size_t totalPoints = points.size();
+    if (totalPoints < 3) return vector<PointType>(points.begin(), points.end());
 
-    return std::abs(totalArea) / 2.0;
+    // Sort points lexicographically; in fast mode large inputs take the radix path
+    if (mode == HULL_MEMORY_LEAN)
+        std::sort(points.begin(), points.end());
+    else
+        PointSorter::sort(points);
+
+    return findConvexHullOfSorted(points.data(), totalPoints);
 }
 
 /**
- * @brief Computes the convex hull of a given set of points using Graham's scan algorithm.
+ * @brief The chain is a stack that grows on demand, so it holds the hull of the points seen
+ * so far instead of a second buffer the size of the input.
  */
-vector<Point> ConvexHullUtility::findConvexHull(vector<Point>& points) {
-    size_t totalPoints = points.size(), hullIndex = 0;
-    vector<Point> hull(totalPoints);
+template <class T>
+vector<typename BasicConvexHull<T>::PointType> BasicConvexHull<T>::findConvexHullOfSorted(const PointType* points,
+                                                                                          size_t totalPoints) {
+    if (totalPoints < 3) return vector<PointType>(points, points + totalPoints);
 
-    // Sort points lexicographically
-    std::sort(points.begin(), points.end());
+    vector<PointType> hull;
+    hull.reserve(HULL_INITIAL_CAPACITY);
 
-    // Construct the lower hull
+    // Construct the lower hull; a non-negative cross product is a clockwise or collinear turn
     for (size_t i = 0; i < totalPoints; ++i) {
-        while (hullIndex >= 2 && hull[hullIndex - 2].orientation(hull[hullIndex - 1], points[i]) <= 0)
-            hullIndex--;
-        hull[hullIndex++] = points[i];
+        while (hull.size() >= 2 && hull[hull.size() - 2].cross(hull.back(), points[i]) >= 0)
+            hull.pop_back();
+        hull.push_back(points[i]);
     }
 
     // Construct the upper hull
-    for (size_t i = totalPoints - 1, startIdx = hullIndex + 1; i > 0; --i) {
-        while (hullIndex >= startIdx && hull[hullIndex - 2].orientation(hull[hullIndex - 1], points[i - 1]) <= 0)
-            hullIndex--;
-        hull[hullIndex++] = points[i - 1];
+    for (size_t i = totalPoints - 1, lowerSize = hull.size() + 1; i > 0; --i) {
+        while (hull.size() >= lowerSize && hull[hull.size() - 2].cross(hull.back(), points[i - 1]) >= 0)
+            hull.pop_back();
+        hull.push_back(points[i - 1]);
     }
 
-    hull.resize(hullIndex - 1); // Remove the last duplicate point
+    hull.pop_back(); // Remove the last duplicate point
     return hull;
 }
+
+template class BasicConvexHull<int32_t>;
+template class BasicConvexHull<float>;
+template class BasicConvexHull<double>;
@@ -8,28 +8,74 @@
 
 using std::vector;
 
+/**
+ * @brief How much scratch memory a hull computation may use.
+ */
+enum HullMemoryMode {
+    HULL_MEMORY_FAST = 0, // Radix sort with a scratch buffer as large as the input
+    HULL_MEMORY_LEAN      // In-place sort; only the hull chain is allocated
+};
+
 /**
  * @brief A utility class for computing the convex hull of a set of points
  * and calculating the area of the convex hull.
+ *
+ * Instantiated for int32_t (exact 64-bit cross products), float and double.
  */
-class ConvexHullUtility {
-private:
+template <class T>
+class BasicConvexHull {
+public:
+    typedef BasicPoint<T> PointType;
+    typedef typename CoordinateTraits<T>::Area Area;
+
     /**
      * @brief Calculates the area enclosed by the given points.
      * 
      * @param points A vector of points representing the convex hull.
      * @return The area of the convex hull.
      */
-    static float computeEnclosedArea(vector<Point>& points);
+    static Area computeEnclosedArea(const vector<PointType>& points);
+
+    /**
+     * @brief Area, perimeter and centroid of a polygon.
+     */
+    struct Shape {
+        Area area;
+        double perimeter;
+        double centroidX;
+        double centroidY;
+    };
+
+    /**
+     * @brief Measures the polygon the points form in a single pass over its edges.
+     *
+     * The centroid of a polygon without area (a hull of one or two points) is the mean of its vertices.
+     *
+     * @param points A vector of points representing the convex hull.
+     * @return Its area, perimeter and centroid.
+     */
+    static Shape computeShape(const vector<PointType>& points);
 
-public:
     /**
      * @brief Computes the convex hull of a given set of points.
      * 
+     * The points are left sorted. Besides the sort, the only allocation is the hull
+     * chain itself, which grows with the hull rather than with the input.
+     * 
      * @param points A vector of points.
+     * @param mode HULL_MEMORY_LEAN sorts in place instead of using the radix scratch buffer.
      * @return A vector of points representing the convex hull.
      */
-    static vector<Point> findConvexHull(vector<Point>& points);
+    static vector<PointType> findConvexHull(PointVector<T>& points, HullMemoryMode mode = HULL_MEMORY_FAST);
+
+    /**
+     * @brief Computes the convex hull of points that are already sorted lexicographically, in O(n).
+     * 
+     * @param points The sorted points.
+     * @param count Number of points.
+     * @return A vector of points representing the convex hull.
+     */
+    static vector<PointType> findConvexHullOfSorted(const PointType* points, size_t count);
 
     /**
      * @brief Computes the area of the convex hull for a given set of points.
@@ -37,10 +83,32 @@ public:
      * @param points A vector of points.
      * @return The area of the convex hull.
      */
-    static float computeHullArea(vector<Point>& points) {
-        vector<Point> hullPoints = findConvexHull(points);
+    static Area computeHullArea(PointVector<T>& points) {
+        vector<PointType> hullPoints = findConvexHull(points);
+        return computeEnclosedArea(hullPoints);
+    }
+
+    /**
+     * @brief Computes the area of the convex hull and reports how many vertices it has.
+     * 
+     * @param points A vector of points.
+     * @param hullSize Receives the number of hull vertices.
+     * @param mode Scratch memory policy, see findConvexHull.
+     * @return The area of the convex hull.
+     */
+    static Area computeHullArea(PointVector<T>& points, size_t& hullSize, HullMemoryMode mode = HULL_MEMORY_FAST) {
+        vector<PointType> hullPoints = findConvexHull(points, mode);
+        hullSize = hullPoints.size();
         return computeEnclosedArea(hullPoints);
     }
 };
 
+extern template class BasicConvexHull<int32_t>;
+extern template class BasicConvexHull<float>;
+extern template class BasicConvexHull<double>;
+
+typedef BasicConvexHull<int32_t> IntConvexHull;
+typedef BasicConvexHull<float> ConvexHullUtility;
+typedef BasicConvexHull<double> DoubleConvexHull;
+
 #endif // CONVEXHULL_HPP
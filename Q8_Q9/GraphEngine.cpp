@@ -0,0 +1,657 @@
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <exception>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include "GraphEngine.hpp"
+#include "RandomPoints.hpp"
+#include "StreamingHull.hpp"
+
+#define DEFAULT_RANDOM_POINTS 10000000
+#define MAX_RANDOM_POINTS 100000000 // Largest GenerateRandom accepted
+#define LEAN_HULL_POINTS (1 << 24) // From here on CH skips the radix scratch buffer (8 bytes per point)
+
+static int dataDirectoryFd = -1; // Where CHFile reads point files; -1 while it is off
+
+bool CommandEngine::setDataDirectory(const char* path) {
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return false;
+    dataDirectoryFd = fd;
+    return true;
+}
+
+CommandEngine* CommandEngine::create(const char* coordinateType) {
+    if (strcmp(coordinateType, "int") == 0) return new GraphEngine<int32_t>();
+    if (strcmp(coordinateType, "float") == 0) return new GraphEngine<float>();
+    if (strcmp(coordinateType, "double") == 0) return new GraphEngine<double>();
+    return nullptr;
+}
+
+template <class T>
+bool GraphEngine<T>::allInRange(size_t from) const {
+    for (size_t i = from; i < graphPoints.size(); ++i)
+        if (!inRange(graphPoints[i].getX(), graphPoints[i].getY())) return false;
+    return true;
+}
+
+template <class T>
+void GraphEngine<T>::resetGraph(GraphMode newMode, bool logClear) {
+    if (newMode == GRAPH_STORED) graphPoints.clear();
+    else PointVector<T>().swap(graphPoints);
+    streamHull.clear();
+    window.reset();
+    sharded.reset();
+    pendingPoints = 0;
+    pointLines.clear();
+    hullCurrent = false;
+    mode = newMode;
+    if (log != nullptr && logClear) log->appendClear(logName);
+}
+
+template <class T>
+void GraphEngine<T>::logPoints(bool remove, const PointType* points, size_t count) {
+    if (log == nullptr || mode != GRAPH_STORED || count == 0) return;
+    logCoordinates.resize(2 * count);
+    for (size_t i = 0; i < count; ++i) {
+        logCoordinates[2 * i] = points[i].getX();
+        logCoordinates[2 * i + 1] = points[i].getY();
+    }
+    log->appendPoints(remove, logName, logCoordinates.data(), count);
+}
+
+template <class T>
+const HullIndex<T>& GraphEngine<T>::currentHull() {
+    if (mode == GRAPH_WINDOWED) {
+        // Points expire as time passes, so the window's hull is never reused
+        hullIndex.assign(window->hull(ServerStats::now()));
+        ServerStats::recordHull(hullIndex.hull().size(), window->size());
+    } else if (hullCurrent) {
+        return hullIndex;
+    } else if (mode == GRAPH_SHARDED) {
+        hullIndex.assign(sharded->hull());
+        ServerStats::recordHull(hullIndex.hull().size(), sharded->pointCount());
+    } else if (mode == GRAPH_STREAMING) {
+        streamHull.flush();
+        hullIndex.assign(streamHull.hull());
+        ServerStats::recordHull(hullIndex.hull().size(), streamHull.pointCount());
+    } else {
+        hullIndex.assign(BasicConvexHull<T>::findConvexHull(graphPoints,
+            graphPoints.size() >= LEAN_HULL_POINTS ? HULL_MEMORY_LEAN : HULL_MEMORY_FAST));
+        ServerStats::recordHull(hullIndex.hull().size(), graphPoints.size());
+    }
+    hullCurrent = true;
+    return hullIndex;
+}
+
+/**
+ * @brief Handles "Contains x,y", "Extreme dx,dy", "Tangents x,y", and "ContainsBatch" followed
+ * by "x,y" lines, which is answered with one letter per point: I(nside), B(oundary) or O(utside).
+ */
+template <class T>
+CommandVerb GraphEngine<T>::queryHull(const char* inputLine, size_t inputLength, ResponseBuffer& response) {
+    if (strncmp(inputLine, "ContainsBatch", 13) == 0) {
+        size_t parsed;
+        queryPoints.clear();
+        const char* rest = TextProtocol::parsePointLines(inputLine + 13, inputLine + inputLength, queryPoints,
+                                                         SIZE_MAX, parsed);
+        if (parsed == 0 || rest != inputLine + inputLength) {
+            response.append("Usage: ContainsBatch followed by x,y lines");
+            return VERB_CONTAINS_BATCH;
+        }
+
+        queryX.resize(parsed);
+        queryY.resize(parsed);
+        for (size_t i = 0; i < parsed; ++i) {
+            queryX[i] = queryPoints[i].getX();
+            queryY[i] = queryPoints[i].getY();
+            if (!inRange(queryX[i], queryY[i])) {
+                response.append("Coordinates out of range");
+                return VERB_CONTAINS_BATCH;
+            }
+        }
+
+        static const char LOCATION_LETTERS[] = {'O', 'B', 'I'};
+        queryLocations.resize(parsed);
+        currentHull().locateBatch(queryX.data(), queryY.data(), parsed, queryLocations.data());
+        response.append("Contains: ");
+        for (unsigned char location : queryLocations) response.append(LOCATION_LETTERS[location]);
+        return VERB_CONTAINS_BATCH;
+    }
+
+    CommandVerb verb = inputLine[0] == 'C' ? VERB_CONTAINS : inputLine[0] == 'E' ? VERB_EXTREME : VERB_TANGENTS;
+    T x, y;
+    if (!TextProtocol::parseCommandPoint(inputLine, verb == VERB_EXTREME ? 7 : 8, x, y)) {
+        response.append("Invalid coordinates format");
+        return verb;
+    }
+    if (!inRange(x, y)) {
+        response.append("Coordinates out of range");
+        return verb;
+    }
+
+    const HullIndex<T>& index = currentHull();
+    PointType first, second;
+    if (verb == VERB_CONTAINS) {
+        static const char* ANSWERS[] = {"Point is outside the hull", "Point is on the hull", "Point is inside the hull"};
+        response.append(ANSWERS[index.locate(PointType(x, y))]);
+    } else if (verb == VERB_EXTREME) {
+        if (x == 0 && y == 0) {
+            response.append("Direction must not be zero");
+        } else if (!index.extreme(x, y, first)) {
+            response.append("Graph is empty");
+        } else {
+            response.append("Extreme point: ");
+            response.appendPoint(first.getX(), first.getY());
+        }
+    } else if (!index.tangents(PointType(x, y), first, second)) {
+        response.append(index.hull().size() < 3 ? "Hull has fewer than three vertices" : "Point is not outside the hull");
+    } else {
+        response.append("Tangent points: ");
+        response.appendPoint(first.getX(), first.getY());
+        response.append(' ');
+        response.appendPoint(second.getX(), second.getY());
+    }
+    return verb;
+}
+
+/**
+ * @brief Handles "CreateWindowGraph <count>" (the last count points) or
+ * "CreateWindowGraph <seconds>s" (the points added in the last seconds).
+ */
+template <class T>
+CommandVerb GraphEngine<T>::createWindowGraph(const char* inputLine, size_t inputLength, ResponseBuffer& response) {
+    const char* cursor = inputLine + 17;
+    const char* end = inputLine + inputLength;
+    const char* word;
+    size_t length;
+    size_t maxPoints = 0;
+    double seconds = 0;
+
+    bool valid = TextProtocol::nextWord(cursor, end, word, length);
+    if (valid && word[length - 1] == 's') {
+        auto parsed = std::from_chars(word, word + length - 1, seconds);
+        valid = parsed.ptr == word + length - 1 && seconds > 0 && seconds < 1e9;
+    } else if (valid) {
+        auto parsed = std::from_chars(word, word + length, maxPoints);
+        valid = parsed.ptr == word + length && maxPoints > 0;
+    }
+    if (!valid) {
+        response.append("Usage: CreateWindowGraph <count> | <seconds>s");
+        return VERB_CREATE_WINDOW_GRAPH;
+    }
+
+    resetGraph(GRAPH_WINDOWED);
+    window.reset(new WindowHull<T>(maxPoints, (uint64_t)(seconds * 1e9)));
+    response.append("Window graph created");
+    return VERB_CREATE_WINDOW_GRAPH;
+}
+
+/**
+ * @brief Handles "CreateShardedGraph [shards]"; one shard per hardware thread by default.
+ */
+template <class T>
+CommandVerb GraphEngine<T>::createShardedGraph(const char* inputLine, size_t inputLength, ResponseBuffer& response) {
+    const char* cursor = inputLine + 18;
+    const char* word;
+    size_t length;
+    size_t shardCount = std::max(1u, std::thread::hardware_concurrency());
+
+    if (TextProtocol::nextWord(cursor, inputLine + inputLength, word, length)) {
+        auto parsed = std::from_chars(word, word + length, shardCount);
+        if (parsed.ptr != word + length || shardCount == 0 || shardCount > MAX_POINT_SHARDS) {
+            response.append("Usage: CreateShardedGraph [shards], at most ");
+            response.appendUnsigned(MAX_POINT_SHARDS);
+            return VERB_CREATE_SHARDED_GRAPH;
+        }
+    }
+
+    resetGraph(GRAPH_SHARDED);
+    sharded.reset(new ShardedHull<T>(shardCount));
+    response.append("Sharded graph created with ");
+    response.appendUnsigned(shardCount);
+    response.append(shardCount == 1 ? " shard" : " shards");
+    return VERB_CREATE_SHARDED_GRAPH;
+}
+
+template <class T>
+bool GraphEngine<T>::addPoint(const PointType& point, const char*& reply) {
+    if (mode == GRAPH_STREAMING) {
+        bool kept = streamHull.insert(point);
+        hullCurrent = hullCurrent && !kept;
+        reply = kept ? "Point added" : "Point inside hull, discarded";
+        return true;
+    }
+    if (mode == GRAPH_WINDOWED) {
+        window->insert(point, ServerStats::now());
+    } else if (mode == GRAPH_SHARDED) {
+        sharded->insert(point);
+    } else {
+        graphPoints.push_back(point);
+        logPoints(false, &point, 1);
+    }
+    hullCurrent = false;
+    reply = "Point added";
+    return true;
+}
+
+template <class T>
+bool GraphEngine<T>::removePoint(const PointType& point, const char*& reply) {
+    if (mode == GRAPH_SHARDED) {
+        sharded->remove(point);
+        hullCurrent = false;
+        reply = "Point removed";
+        return true;
+    }
+    if (mode != GRAPH_STORED) {
+        reply = mode == GRAPH_STREAMING ? "Points cannot be removed from a streaming graph"
+                                        : "Points leave a windowed graph on their own";
+        return false;
+    }
+
+    for (size_t i = 0; i < graphPoints.size(); i++) {
+        if (graphPoints[i].getX() == point.getX() && graphPoints[i].getY() == point.getY()) {
+            graphPoints[i] = graphPoints.back();
+            graphPoints.pop_back();
+            hullCurrent = false;
+            logPoints(true, &point, 1);
+            break;
+        }
+    }
+    reply = "Point removed";
+    return true;
+}
+
+template <class T>
+CommandVerb GraphEngine<T>::execute(const char* inputLine, size_t inputLength, int clientFd, ResponseBuffer& response) {
+    if (pendingPoints > 0) {
+        if (graphCreatorFd != clientFd) {
+            response.append("Another client is creating a graph");
+            return VERB_GRAPH_POINTS;
+        }
+
+        // Bulk mode: take every whole point line the client has sent so far; a read that
+        // completes no line gets no reply
+        const char *lines, *linesEnd;
+        pointLines.take(inputLine, inputLength, lines, linesEnd);
+        if (lines == linesEnd) return VERB_GRAPH_POINTS;
+        size_t added, firstAdded = graphPoints.size();
+        const char* rest = TextProtocol::parsePointLines(lines, linesEnd, graphPoints, pendingPoints, added);
+        if (!allInRange(firstAdded)) {
+            graphPoints.resize(firstAdded);
+            pointLines.clear();
+            response.append("Coordinates out of range");
+            return VERB_GRAPH_POINTS;
+        }
+        pendingPoints -= added;
+        hullCurrent = false;
+        logPoints(false, graphPoints.data() + firstAdded, added);
+        if (added == 0 || (rest != linesEnd && pendingPoints > 0)) {
+            pointLines.clear();
+            response.append("Invalid coordinates format while waiting for points");
+            return VERB_GRAPH_POINTS;
+        }
+        if (pendingPoints == 0) {
+            pointLines.clear();
+            graphCreatorFd = -1;
+            response.append("Graph creation complete");
+            return VERB_GRAPH_POINTS;
+        }
+        response.append(added == 1 ? "Point added" : "Points added");
+        return VERB_GRAPH_POINTS;
+    }
+
+    if (strncmp(inputLine, "CreateGraph", 11) == 0) {
+        size_t pointCount;
+        if (!TextProtocol::parseCommandCount(inputLine, 11, pointCount)) {
+            response.append("Invalid CreateGraph command format");
+            return VERB_CREATE_GRAPH;
+        }
+        if (pointCount == 0) {
+            response.append("Graph must have at least one point");
+            return VERB_CREATE_GRAPH;
+        }
+
+        resetGraph(GRAPH_STORED);
+        graphPoints.reserve(pointCount);
+        graphCreatorFd = clientFd;
+        pendingPoints = pointCount;
+        response.append("Expecting points for new graph");
+        return VERB_CREATE_GRAPH;
+    } else if (strncmp(inputLine, "CreateStreamGraph", 17) == 0) {
+        // Points that land strictly inside the hull are dropped on arrival
+        resetGraph(GRAPH_STREAMING);
+        response.append("Streaming graph created");
+        return VERB_CREATE_STREAM_GRAPH;
+    } else if (strncmp(inputLine, "CreateWindowGraph", 17) == 0) {
+        return createWindowGraph(inputLine, inputLength, response);
+    } else if (strncmp(inputLine, "CreateShardedGraph", 18) == 0) {
+        return createShardedGraph(inputLine, inputLength, response);
+    } else if (strncmp(inputLine, "CH", 2) == 0) {
+        response.append("Convex hull area: ");
+        appendHullArea(response);
+        return VERB_CH;
+    } else if (strncmp(inputLine, "Contains", 8) == 0 || strncmp(inputLine, "Extreme", 7) == 0 ||
+               strncmp(inputLine, "Tangents", 8) == 0) {
+        return queryHull(inputLine, inputLength, response);
+    } else if (strncmp(inputLine, "Diameter", 8) == 0 || strncmp(inputLine, "Width", 5) == 0 ||
+               strncmp(inputLine, "MinRectangle", 12) == 0 || strncmp(inputLine, "Shape", 5) == 0) {
+        return measureHull(inputLine, response);
+    } else if (strncmp(inputLine, "AddPoint", 8) == 0) {
+        return addPointCommand(inputLine, response);
+    } else if (strncmp(inputLine, "RemovePoint", 11) == 0) {
+        T x, y;
+        if (!TextProtocol::parseCommandPoint(inputLine, 11, x, y)) {
+            response.append("Invalid coordinates format");
+            return VERB_REMOVE_POINT;
+        }
+        const char* reply;
+        removePoint(PointType(x, y), reply);
+        response.append(reply);
+        return VERB_REMOVE_POINT;
+    } else if (strncmp(inputLine, "Stats", 5) == 0) {
+        ServerStats::report(response);
+        return VERB_STATS;
+    }
+
+    response.append("Unknown command");
+    return VERB_UNKNOWN;
+}
+
+template <class T>
+CommandVerb GraphEngine<T>::addPointCommand(const char* inputLine, ResponseBuffer& response) {
+    T x, y;
+    if (!TextProtocol::parseCommandPoint(inputLine, 8, x, y)) {
+        response.append("Invalid coordinates format");
+        return VERB_ADD_POINT;
+    }
+    if (!inRange(x, y)) {
+        response.append("Coordinates out of range");
+        return VERB_ADD_POINT;
+    }
+    const char* reply;
+    addPoint(PointType(x, y), reply);
+    response.append(reply);
+    return VERB_ADD_POINT;
+}
+
+template <class T>
+void GraphEngine<T>::appendHullArea(ResponseBuffer& response) {
+    const vector<PointType>& hull = currentHull().hull();
+    response.appendNumber(hull.size() > 2 ? BasicConvexHull<T>::computeEnclosedArea(hull) : 0);
+}
+
+/**
+ * @brief Integer coordinates must arrive as whole numbers; floating point ones are rounded to T.
+ */
+template <class T>
+size_t GraphEngine<T>::applyPoints(bool remove, const double* coordinates, size_t count) {
+    size_t applied = 0, firstAdded = graphPoints.size();
+    bool appendStored = !remove && mode == GRAPH_STORED; // Appended in place and logged as one record
+    const char* reply;
+    for (size_t i = 0; i < count; ++i) {
+        double x = coordinates[2 * i], y = coordinates[2 * i + 1];
+        if (!(x >= CoordinateTraits<T>::MIN_COORDINATE && x <= CoordinateTraits<T>::MAX_COORDINATE &&
+              y >= CoordinateTraits<T>::MIN_COORDINATE && y <= CoordinateTraits<T>::MAX_COORDINATE))
+            continue;
+        PointType point((T)x, (T)y);
+        if (std::is_integral<T>::value && (point.getX() != x || point.getY() != y)) continue;
+        if (appendStored) {
+            graphPoints.push_back(point);
+            applied++;
+        } else if (remove ? removePoint(point, reply) : addPoint(point, reply)) {
+            applied++;
+        }
+    }
+    if (appendStored && applied > 0) {
+        hullCurrent = false;
+        logPoints(false, graphPoints.data() + firstAdded, applied);
+    }
+    return applied;
+}
+
+template <class T>
+void GraphEngine<T>::hullCoordinates(std::vector<double>& coordinates) {
+    const vector<PointType>& hull = currentHull().hull();
+    coordinates.clear();
+    for (const PointType& point : hull) {
+        coordinates.push_back(point.getX());
+        coordinates.push_back(point.getY());
+    }
+}
+
+template <class T>
+void GraphEngine<T>::resetPoints() {
+    resetGraph(GRAPH_STORED);
+    graphCreatorFd = -1;
+}
+
+template <class T>
+void GraphEngine<T>::reservePoints(size_t count) {
+    if (mode == GRAPH_STORED) graphPoints.reserve(graphPoints.size() + count);
+}
+
+template <class T>
+void GraphEngine<T>::attachLog(WriteAheadLog* newLog, const std::string& graphName) {
+    log = newLog;
+    logName = graphName;
+}
+
+template <class T>
+bool GraphEngine<T>::storedCoordinates(std::vector<double>& coordinates) {
+    if (log == nullptr || mode != GRAPH_STORED) return false;
+    coordinates.resize(2 * graphPoints.size());
+    for (size_t i = 0; i < graphPoints.size(); ++i) {
+        coordinates[2 * i] = graphPoints[i].getX();
+        coordinates[2 * i + 1] = graphPoints[i].getY();
+    }
+    return true;
+}
+
+/**
+ * @brief Handles "Diameter", "Width", "MinRectangle" and "Shape" (area, perimeter and centroid),
+ * each O(h) once the hull is known.
+ */
+template <class T>
+CommandVerb GraphEngine<T>::measureHull(const char* inputLine, ResponseBuffer& response) {
+    CommandVerb verb = inputLine[0] == 'D' ? VERB_DIAMETER : inputLine[0] == 'W' ? VERB_WIDTH
+                     : inputLine[0] == 'M' ? VERB_MIN_RECTANGLE : VERB_SHAPE;
+    const vector<PointType>& hull = currentHull().hull();
+    if (hull.empty()) {
+        response.append("Graph is empty");
+        return verb;
+    }
+
+    if (verb == VERB_DIAMETER) {
+        PointType from, to;
+        double length = RotatingCalipers<T>::diameter(hull, from, to);
+        response.append("Diameter: ");
+        response.appendNumber(length);
+        response.append(" between ");
+        response.appendPoint(from.getX(), from.getY());
+        response.append(" and ");
+        response.appendPoint(to.getX(), to.getY());
+    } else if (verb == VERB_SHAPE) {
+        typename BasicConvexHull<T>::Shape shape = BasicConvexHull<T>::computeShape(hull);
+        response.append("Hull area: ");
+        response.appendNumber(shape.area);
+        response.append(" perimeter: ");
+        response.appendNumber(shape.perimeter);
+        response.append(" centroid: ");
+        response.appendPoint(shape.centroidX, shape.centroidY);
+    } else if (hull.size() < 3) {
+        response.append("Hull has fewer than three vertices");
+    } else if (verb == VERB_WIDTH) {
+        size_t edge;
+        response.append("Width: ");
+        response.appendNumber(RotatingCalipers<T>::width(hull, edge));
+    } else {
+        double corners[4][2];
+        double area = RotatingCalipers<T>::minimumRectangle(hull, corners);
+        response.append("Minimum rectangle area: ");
+        response.appendNumber(area);
+        response.append(" corners");
+        for (const double* corner : corners) {
+            response.append(' ');
+            response.appendPoint(corner[0], corner[1]);
+        }
+    }
+    return verb;
+}
+
+/**
+ * @brief The points are generated in parallel into a fresh buffer without holding the
+ * graph mutex; the old points are freed after it is released.
+ */
+template <class T>
+CommandVerb GraphEngine<T>::generateRandom(const char* inputLine, size_t inputLength, std::mutex& mutex,
+                                           ResponseBuffer& response) {
+    size_t count = DEFAULT_RANDOM_POINTS;
+    PointDistribution distribution = DISTRIBUTION_UNIFORM;
+    uint64_t seed = 1;
+    if (!RandomPointGenerator::parseArguments(inputLine + 14, inputLine + inputLength, count, distribution, seed)) {
+        response.append("Usage: GenerateRandom [n] [uniform|normal|disk|clustered] [seed]");
+        return VERB_GENERATE_RANDOM;
+    }
+
+    if (count > MAX_RANDOM_POINTS) {
+        response.append("At most ");
+        response.appendUnsigned(MAX_RANDOM_POINTS);
+        response.append(" random points can be generated");
+        return VERB_GENERATE_RANDOM;
+    }
+
+    // Checked before the work of generating, and again when the points are swapped in
+    mutex.lock();
+    bool creating = pendingPoints > 0;
+    mutex.unlock();
+    const char* failure = "Another client is creating a graph";
+    if (creating || !loadRandomPoints(count, distribution, seed, mutex, failure)) {
+        response.append(failure);
+        return VERB_GENERATE_RANDOM;
+    }
+    response.append("Random points generated: ");
+    response.appendUnsigned(count);
+    return VERB_GENERATE_RANDOM;
+}
+
+/**
+ * @brief The generator is deterministic, so the log records its arguments rather than the points.
+ */
+template <class T>
+bool GraphEngine<T>::loadRandomPoints(size_t count, PointDistribution distribution, uint64_t seed, std::mutex& mutex,
+                                      const char*& failure) {
+    PointVector<T> generated;
+    try {
+        RandomPointGenerator::generate(generated, count, distribution, seed);
+    } catch (const std::exception&) {
+        // bad_alloc, or length_error past max_size()
+        failure = "Not enough memory for that many points";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pendingPoints > 0) {
+        failure = "Another client is creating a graph";
+        return false;
+    }
+    resetGraph(GRAPH_STORED, false); // Replaying the Generate record replaces the graph by itself
+    graphPoints.swap(generated);
+    if (log != nullptr) log->appendGenerate(logName, count, distribution, seed);
+    return true;
+}
+
+/**
+ * @brief The file holds consecutive (x, y) pairs of the engine's coordinate type. It is
+ * named relative to the data directory and opened without following a symbolic link,
+ * so a client cannot reach anything outside it.
+ */
+template <class T>
+CommandVerb GraphEngine<T>::hullOfFile(const char* inputLine, size_t inputLength, ResponseBuffer& response) {
+    if (dataDirectoryFd < 0) {
+        response.append("CHFile: off (start the server with -d)");
+        return VERB_CH_FILE;
+    }
+    const char* cursor = inputLine + 6;
+    const char* end = inputLine + inputLength;
+    const char* word;
+    size_t length;
+    if (!TextProtocol::nextWord(cursor, end, word, length)) {
+        response.append("Usage: CHFile <file in the data directory>");
+        return VERB_CH_FILE;
+    }
+    std::string name(word, length);
+    if (name.find('/') != std::string::npos) {
+        response.append("CHFile reads only files directly in the data directory");
+        return VERB_CH_FILE;
+    }
+
+    std::vector<PointType> hull;
+    size_t pointCount;
+    int fd = openat(dataDirectoryFd, name.c_str(), O_RDONLY | O_NONBLOCK | O_NOFOLLOW | O_CLOEXEC);
+    bool computed = fd >= 0 && PointFileHull<T>::compute(fd, hull, pointCount);
+    int error = errno;
+    if (fd >= 0) close(fd);
+    if (!computed) {
+        response.append("Cannot read point file: ");
+        response.append(strerror(error));
+        return VERB_CH_FILE;
+    }
+
+    ServerStats::recordHull(hull.size(), pointCount);
+    response.append("Convex hull area: ");
+    response.appendNumber(BasicConvexHull<T>::computeEnclosedArea(hull));
+    response.append(" (");
+    response.appendUnsigned(pointCount);
+    response.append(" points)");
+    return VERB_CH_FILE;
+}
+
+/**
+ * @brief The groups are packed into one buffer and handed to BatchHull in a single call.
+ */
+template <class T>
+CommandVerb GraphEngine<T>::hullsOfGroups(const char* inputLine, size_t inputLength, ResponseBuffer& response) {
+    const char* cursor = inputLine + 7;
+    const char* end = inputLine + inputLength;
+    vector<PointType> points;
+    vector<size_t> offsets(1, 0);
+
+    // The first group may follow the command word on the same line; blank lines are skipped
+    while (cursor != nullptr && cursor != end) {
+        size_t parsed;
+        cursor = TextProtocol::parsePointList(cursor, end, points, parsed);
+        if (parsed > 0) offsets.push_back(points.size());
+    }
+    if (cursor == nullptr || offsets.size() == 1) {
+        response.append("Usage: CHBatch followed by one line of x,y points per group");
+        return VERB_CH_BATCH;
+    }
+    for (const PointType& point : points) {
+        if (!inRange(point.getX(), point.getY())) {
+            response.append("Coordinates out of range");
+            return VERB_CH_BATCH;
+        }
+    }
+
+    size_t groupCount = offsets.size() - 1;
+    vector<size_t> hullSizes(groupCount);
+    vector<typename BatchHull<T>::Area> areas(groupCount);
+    BatchHull<T>::compute(points.data(), offsets.data(), groupCount, points.data(), hullSizes.data(), areas.data());
+
+    response.append("Hull areas:");
+    for (size_t g = 0; g < groupCount; ++g) {
+        ServerStats::recordHull(hullSizes[g], offsets[g + 1] - offsets[g]);
+        response.append(' ');
+        response.appendNumber(areas[g]);
+    }
+    return VERB_CH_BATCH;
+}
+
+template class GraphEngine<int32_t>;
+template class GraphEngine<float>;
+template class GraphEngine<double>;
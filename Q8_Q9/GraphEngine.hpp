@@ -0,0 +1,240 @@
+#ifndef GRAPH_ENGINE_HPP
+#define GRAPH_ENGINE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "BatchHull.hpp"
+#include "Calipers.hpp"
+#include "ConvexHull.hpp"
+#include "HullQueries.hpp"
+#include "Protocol.hpp"
+#include "ShardedHull.hpp"
+#include "Stats.hpp"
+#include "StreamingHull.hpp"
+#include "WindowHull.hpp"
+#include "WriteAheadLog.hpp"
+
+/**
+ * @brief The server's graph and the commands that operate on it.
+ *
+ * The coordinate type is chosen once at startup; every command then runs
+ * through a single virtual call into code specialized for that type.
+ */
+class CommandEngine {
+public:
+    virtual ~CommandEngine() {}
+
+    /**
+     * @brief Processes one client command. The caller holds the graph mutex.
+     * @param inputLine The command received from the client (NUL terminated).
+     * @param inputLength Number of bytes in the command.
+     * @param clientFd The file descriptor of the client sending the command.
+     * @param response The connection's reusable buffer the reply is written into; it stays
+     *        empty when a read of graph points ended before finishing a line.
+     * @return The verb the command was accounted under.
+     */
+    virtual CommandVerb execute(const char* inputLine, size_t inputLength, int clientFd, ResponseBuffer& response) = 0;
+
+    /**
+     * @brief Handles "GenerateRandom [n] [distribution] [seed]".
+     *
+     * Called without the graph mutex; it is only taken to swap the new points in.
+     */
+    virtual CommandVerb generateRandom(const char* inputLine, size_t inputLength, std::mutex& mutex,
+                                       ResponseBuffer& response) = 0;
+
+    /**
+     * @brief Handles "AddPoint x,y", as execute() does once no graph creation is pending.
+     * The caller holds the graph mutex.
+     */
+    virtual CommandVerb addPointCommand(const char* inputLine, ResponseBuffer& response) = 0;
+
+    /**
+     * @brief Handles "CHFile <file>": the hull area of a binary point file in the data directory,
+     * computed out of core.
+     *
+     * Does not touch the graph, so it is called without the graph mutex.
+     */
+    virtual CommandVerb hullOfFile(const char* inputLine, size_t inputLength, ResponseBuffer& response) = 0;
+
+    /**
+     * @brief Handles "CHBatch" followed by one line of "x,y" points per group: the hull area of every group.
+     *
+     * Does not touch the graph, so it is called without the graph mutex.
+     */
+    virtual CommandVerb hullsOfGroups(const char* inputLine, size_t inputLength, ResponseBuffer& response) = 0;
+
+    /**
+     * @brief Appends the area of the graph's hull, as CH reports it. The caller holds the graph mutex.
+     */
+    virtual void appendHullArea(ResponseBuffer& response) = 0;
+
+    /**
+     * @brief Shard link: adds (or removes) @p count points given as (x, y) pairs. The caller holds the graph mutex.
+     * @return The number of points taken; those outside the coordinate type's range are skipped.
+     */
+    virtual size_t applyPoints(bool remove, const double* coordinates, size_t count) = 0;
+
+    /**
+     * @brief Shard link: the graph's hull as (x, y) pairs. The caller holds the graph mutex.
+     */
+    virtual void hullCoordinates(std::vector<double>& coordinates) = 0;
+
+    /**
+     * @brief Replaces the graph with an empty stored one. The caller holds the graph mutex.
+     */
+    virtual void resetPoints() = 0;
+
+    /**
+     * @brief Replaces the graph with @p count generated points, as GenerateRandom does.
+     *
+     * Generates without the graph mutex and takes @p mutex only to swap the points in.
+     * @return False, with @p failure set to the reply, if there is not enough memory or
+     * another client's CreateGraph is still taking points.
+     */
+    virtual bool loadRandomPoints(size_t count, PointDistribution distribution, uint64_t seed, std::mutex& mutex,
+                                  const char*& failure) = 0;
+
+    /**
+     * @brief Makes room for @p count more points in a stored graph. The caller holds the graph mutex.
+     */
+    virtual void reservePoints(size_t count) = 0;
+
+    /**
+     * @brief Logs every later change to a stored graph in @p log under @p graphName; nullptr stops logging.
+     * The caller holds the graph mutex.
+     */
+    virtual void attachLog(WriteAheadLog* log, const std::string& graphName) = 0;
+
+    /**
+     * @brief The points of a logged, stored graph as (x, y) pairs. The caller holds the graph mutex.
+     * @return False, leaving @p coordinates alone, for other graphs.
+     */
+    virtual bool storedCoordinates(std::vector<double>& coordinates) = 0;
+
+    /**
+     * @brief Creates the engine for "int", "float" or "double" coordinates.
+     * @return nullptr if the name is not recognized.
+     */
+    static CommandEngine* create(const char* coordinateType);
+
+    /**
+     * @brief Lets CHFile read the point files in the directory at @p path; until then it is refused.
+     * @return False with errno set if the directory cannot be opened.
+     */
+    static bool setDataDirectory(const char* path);
+};
+
+/**
+ * @brief How the graph holds its points.
+ */
+enum GraphMode {
+    GRAPH_STORED = 0, // Every point is kept (CreateGraph, AddPoint, GenerateRandom)
+    GRAPH_STREAMING,  // Only hull candidates are kept (CreateStreamGraph)
+    GRAPH_WINDOWED,   // Only the most recent points are kept (CreateWindowGraph)
+    GRAPH_SHARDED     // Points are spread over worker threads, each keeping a local hull (CreateShardedGraph)
+};
+
+/**
+ * @brief Command engine over points with coordinates of type T.
+ */
+template <class T>
+class GraphEngine : public CommandEngine {
+private:
+    typedef BasicPoint<T> PointType;
+
+    // Container for graph points
+    PointVector<T> graphPoints;
+
+    // Tracks the number of points expected during graph creation
+    size_t pendingPoints = 0;
+
+    // File descriptor of the client creating the graph
+    int graphCreatorFd = -1;
+
+    // The creator's point line cut off at the end of its last read
+    PointLineBuffer pointLines;
+
+    GraphMode mode = GRAPH_STORED;
+
+    // Hull candidates of a streaming graph
+    IncrementalHull<T> streamHull;
+
+    // Points of a windowed graph
+    std::unique_ptr<WindowHull<T>> window;
+
+    // Shards of a sharded graph, with their worker threads
+    std::unique_ptr<ShardedHull<T>> sharded;
+
+    // The hull CH and the queries answer from; a windowed graph's is rebuilt on every use
+    HullIndex<T> hullIndex;
+    bool hullCurrent = false;
+
+    // Where changes to the stored points are recorded, if anywhere, and the graph's name there
+    WriteAheadLog* log = nullptr;
+    std::string logName;
+    vector<double> logCoordinates;
+
+    // Scratch for ContainsBatch: the points, their coordinates as arrays, and the answers
+    vector<PointType> queryPoints;
+    vector<T> queryX;
+    vector<T> queryY;
+    vector<unsigned char> queryLocations;
+
+    // Switches to @p newMode and releases the storage of the other modes; logs a Clear
+    // unless the caller logs a record that replaces the graph anyway
+    void resetGraph(GraphMode newMode, bool logClear = true);
+
+    // Records added or removed points of a stored graph in the log
+    void logPoints(bool remove, const PointType* points, size_t count);
+
+    CommandVerb createWindowGraph(const char* inputLine, size_t inputLength, ResponseBuffer& response);
+    CommandVerb createShardedGraph(const char* inputLine, size_t inputLength, ResponseBuffer& response);
+
+    // AddPoint and RemovePoint on whatever kind of graph this is; @p reply is the client's answer
+    bool addPoint(const PointType& point, const char*& reply);
+    bool removePoint(const PointType& point, const char*& reply);
+
+    // Recomputes the hull if the graph changed since it was last computed
+    const HullIndex<T>& currentHull();
+
+    // Contains, ContainsBatch, Extreme and Tangents
+    CommandVerb queryHull(const char* inputLine, size_t inputLength, ResponseBuffer& response);
+
+    // Diameter, Width, MinRectangle and Shape
+    CommandVerb measureHull(const char* inputLine, ResponseBuffer& response);
+
+    // Rejects coordinates outside the range the cross product is exact for
+    static bool inRange(T x, T y) {
+        return x >= CoordinateTraits<T>::MIN_COORDINATE && x <= CoordinateTraits<T>::MAX_COORDINATE &&
+               y >= CoordinateTraits<T>::MIN_COORDINATE && y <= CoordinateTraits<T>::MAX_COORDINATE;
+    }
+
+    bool allInRange(size_t from) const;
+
+public:
+    CommandVerb execute(const char* inputLine, size_t inputLength, int clientFd, ResponseBuffer& response) override;
+    CommandVerb generateRandom(const char* inputLine, size_t inputLength, std::mutex& mutex,
+                               ResponseBuffer& response) override;
+    CommandVerb addPointCommand(const char* inputLine, ResponseBuffer& response) override;
+    CommandVerb hullOfFile(const char* inputLine, size_t inputLength, ResponseBuffer& response) override;
+    CommandVerb hullsOfGroups(const char* inputLine, size_t inputLength, ResponseBuffer& response) override;
+    void appendHullArea(ResponseBuffer& response) override;
+    size_t applyPoints(bool remove, const double* coordinates, size_t count) override;
+    void hullCoordinates(std::vector<double>& coordinates) override;
+    void resetPoints() override;
+    bool loadRandomPoints(size_t count, PointDistribution distribution, uint64_t seed, std::mutex& mutex,
+                          const char*& failure) override;
+    void reservePoints(size_t count) override;
+    void attachLog(WriteAheadLog* log, const std::string& graphName) override;
+    bool storedCoordinates(std::vector<double>& coordinates) override;
+};
+
+extern template class GraphEngine<int32_t>;
+extern template class GraphEngine<float>;
+extern template class GraphEngine<double>;
+
+#endif // GRAPH_ENGINE_HPP
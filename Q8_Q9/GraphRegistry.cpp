@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include "GraphRegistry.hpp"
+
+std::shared_ptr<NamedGraph> GraphRegistry::open(const std::string& name) {
+    return open(name, SIZE_MAX);
+}
+
+std::shared_ptr<NamedGraph> GraphRegistry::open(const std::string& name, size_t maxGraphs) {
+    Shard& shard = shardOf(name);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto entry = shard.graphs.find(name);
+    if (entry != shard.graphs.end()) return entry->second;
+
+    // Other shards may be adding graphs too, so the room is claimed before the graph is made
+    if (graphCount.fetch_add(1) >= maxGraphs) {
+        graphCount--;
+        return nullptr;
+    }
+    std::shared_ptr<NamedGraph>& graph = shard.graphs[name];
+    graph = std::make_shared<NamedGraph>();
+    graph->name = name;
+    graph->engine.reset(CommandEngine::create(coordinateType.c_str()));
+    if (log != nullptr && graph->engine) graph->engine->attachLog(log, name);
+    return graph;
+}
+
+std::shared_ptr<NamedGraph> GraphRegistry::find(const std::string& name) {
+    Shard& shard = shardOf(name);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto entry = shard.graphs.find(name);
+    return entry == shard.graphs.end() ? nullptr : entry->second;
+}
+
+/**
+ * @brief The graph stops logging before the drop is logged, so a checkpoint either
+ * copies it with an earlier lsn than the drop's or leaves it out.
+ */
+bool GraphRegistry::drop(const std::string& name) {
+    Shard& shard = shardOf(name);
+    std::shared_ptr<NamedGraph> graph;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto entry = shard.graphs.find(name);
+        if (entry == shard.graphs.end()) return false;
+        graph = entry->second;
+    }
+    if (log != nullptr) {
+        std::lock_guard<std::mutex> graphLock(graph->mutex);
+        graph->engine->attachLog(nullptr, std::string());
+    }
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto entry = shard.graphs.find(name);
+    if (entry == shard.graphs.end() || entry->second != graph) return false;
+    shard.graphs.erase(entry);
+    graphCount--;
+    if (log != nullptr) log->appendDrop(name);
+    return true;
+}
+
+void GraphRegistry::attachLog(WriteAheadLog* newLog) {
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        log = newLog;
+        for (const auto& entry : shard.graphs) {
+            std::lock_guard<std::mutex> graphLock(entry.second->mutex);
+            entry.second->engine->attachLog(newLog, entry.first);
+        }
+    }
+}
+
+std::vector<std::shared_ptr<NamedGraph>> GraphRegistry::snapshot() {
+    std::vector<std::shared_ptr<NamedGraph>> graphs;
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& entry : shard.graphs) graphs.push_back(entry.second);
+    }
+    std::sort(graphs.begin(), graphs.end(),
+              [](const std::shared_ptr<NamedGraph>& a, const std::shared_ptr<NamedGraph>& b) { return a->name < b->name; });
+    return graphs;
+}
+
+void GraphRegistry::hullAreas(ResponseBuffer& response, unsigned int threads) {
+    std::vector<std::shared_ptr<NamedGraph>> graphs = snapshot();
+    std::vector<ResponseBuffer> areas(graphs.size());
+
+    // The first failure stops the others; it is rethrown once every helper is joined
+    std::atomic<size_t> next(0);
+    std::mutex failureMutex;
+    std::exception_ptr failure;
+    auto work = [&] {
+        try {
+            for (size_t i = next++; i < graphs.size(); i = next++) {
+                std::lock_guard<std::mutex> lock(graphs[i]->mutex);
+                graphs[i]->engine->appendHullArea(areas[i]);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (!failure) failure = std::current_exception();
+            next = graphs.size();
+        }
+    };
+
+    unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+    if (threads == 0) threads = hardware;
+    threads = (unsigned int)std::min<size_t>(threads, std::max<size_t>(1, graphs.size()));
+    unsigned int helpers, running = hullAreaHelpers.load();
+    do {
+        helpers = std::min(threads - 1, running < hardware - 1 ? hardware - 1 - running : 0);
+    } while (helpers > 0 && !hullAreaHelpers.compare_exchange_weak(running, running + helpers));
+
+    std::vector<std::thread> workers;
+    try {
+        workers.reserve(helpers);
+        for (unsigned int t = 0; t < helpers; ++t) workers.emplace_back(work);
+    } catch (const std::exception&) {
+        // Fewer helpers than claimed; the graphs are shared by those that started
+    }
+    work();
+    for (std::thread& worker : workers) worker.join();
+    hullAreaHelpers -= helpers;
+    if (failure) std::rethrow_exception(failure);
+
+    response.append("Hull areas of ");
+    response.appendNumber(graphs.size());
+    response.append(graphs.size() == 1 ? " graph:" : " graphs:");
+    for (size_t i = 0; i < graphs.size(); ++i) {
+        response.append('\n');
+        response.append(graphs[i]->name.data(), graphs[i]->name.size());
+        response.append(": ");
+        response.append(areas[i].data(), areas[i].size());
+    }
+}
+
+bool GraphRegistry::validName(const char* name, size_t length) {
+    if (length == 0 || length > GRAPH_NAME_MAX) return false;
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char c = name[i];
+        if (!isalnum(c) && c != '_' && c != '-' && c != '.') return false;
+    }
+    return true;
+}
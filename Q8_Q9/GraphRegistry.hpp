@@ -0,0 +1,110 @@
+#ifndef GRAPH_REGISTRY_HPP
+#define GRAPH_REGISTRY_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "GraphEngine.hpp"
+#include "Protocol.hpp"
+
+#define GRAPH_REGISTRY_SHARDS 16  // Independent locks over the name table
+#define DEFAULT_GRAPH_NAME "default"
+#define GRAPH_NAME_MAX 64
+#define GRAPH_MAX_COUNT 4096      // Graphs clients may create; the log and a leader are not limited
+
+/**
+ * @brief One graph of the namespace, with the lock its commands run under.
+ *
+ * Connections hold it by shared_ptr, so a dropped graph lives on until its last
+ * user moves to another one.
+ */
+struct NamedGraph {
+    std::string name;
+    std::mutex mutex;
+    std::unique_ptr<CommandEngine> engine;
+};
+
+/**
+ * @brief The server's graphs by name, in a hash map split into shards.
+ *
+ * A name lock is held only to find, create or drop an entry; commands on a graph
+ * take just that graph's mutex. Clients working on different graphs therefore run
+ * in parallel, each on its own connection thread.
+ */
+class GraphRegistry {
+private:
+    struct Shard {
+        alignas(64) std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<NamedGraph>> graphs;
+    };
+
+    Shard shards[GRAPH_REGISTRY_SHARDS];
+    std::atomic<size_t> graphCount{0};
+
+    // Helper threads of all CHAll requests now running, kept below the hardware threads
+    std::atomic<unsigned int> hullAreaHelpers{0};
+    std::string coordinateType;
+    WriteAheadLog* log = nullptr;
+
+    Shard& shardOf(const std::string& name) {
+        return shards[std::hash<std::string>()(name) % GRAPH_REGISTRY_SHARDS];
+    }
+
+public:
+    /**
+     * @param coordinateType "int", "float" or "double", as accepted by CommandEngine::create.
+     */
+    explicit GraphRegistry(const char* coordinateType) : coordinateType(coordinateType) {}
+
+    /**
+     * @brief Returns the graph called @p name, creating an empty one if there is none.
+     */
+    std::shared_ptr<NamedGraph> open(const std::string& name);
+
+    /**
+     * @brief As open(), but creates no graph once there are @p maxGraphs.
+     * @return nullptr if @p name does not exist and there is no room for it.
+     */
+    std::shared_ptr<NamedGraph> open(const std::string& name, size_t maxGraphs);
+
+    /**
+     * @brief Returns the graph called @p name, or nullptr if there is none.
+     */
+    std::shared_ptr<NamedGraph> find(const std::string& name);
+
+    /**
+     * @brief Removes @p name from the namespace. Connections using it keep their copy, which is no longer logged.
+     * @return False if there is no such graph.
+     */
+    bool drop(const std::string& name);
+
+    /**
+     * @brief Logs the changes of every graph, present and future, and their drops in @p log.
+     */
+    void attachLog(WriteAheadLog* log);
+
+    /**
+     * @brief Every graph, sorted by name.
+     */
+    std::vector<std::shared_ptr<NamedGraph>> snapshot();
+
+    /**
+     * @brief Handles "CHAll": the hull area of every graph, one "name: area" line each.
+     *
+     * Graphs are spread over the calling thread and up to @p threads - 1 helpers (0 uses
+     * every hardware thread), each locking one graph at a time. Helpers come out of one
+     * budget shared by concurrent calls, so together they never start more than a helper
+     * per hardware thread; a call that finds the budget spent works alone.
+     */
+    void hullAreas(ResponseBuffer& response, unsigned int threads = 0);
+
+    /**
+     * @brief Letters, digits, '_', '-' and '.', at most GRAPH_NAME_MAX characters.
+     */
+    static bool validName(const char* name, size_t length);
+};
+
+#endif // GRAPH_REGISTRY_HPP
@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <limits>
+#include "HullQueries.hpp"
+
+#define QUERY_BATCH_CHUNK 256 // Points a linear batch pass keeps partial results for
+
+// For @p point collinear with a and b: true if it lies between them
+template <class T>
+static bool betweenEnds(const BasicPoint<T>& a, const BasicPoint<T>& b, const BasicPoint<T>& point) {
+    typedef typename BasicPoint<T>::Wide Wide;
+    Wide fromA = ((Wide)point.getX() - a.getX()) * ((Wide)b.getX() - a.getX()) +
+                 ((Wide)point.getY() - a.getY()) * ((Wide)b.getY() - a.getY());
+    Wide fromB = ((Wide)point.getX() - b.getX()) * ((Wide)a.getX() - b.getX()) +
+                 ((Wide)point.getY() - b.getY()) * ((Wide)a.getY() - b.getY());
+    return fromA >= 0 && fromB >= 0;
+}
+
+template <class T>
+void HullIndex<T>::assign(const vector<PointType>& hull) {
+    vertices.assign(hull.begin(), hull.end());
+
+    // The lower chain ends at the lexicographically largest vertex
+    rightmost = 0;
+    for (size_t i = 1; i < vertices.size(); ++i)
+        if (vertices[i] > vertices[rightmost]) rightmost = i;
+
+    // One extra slot repeats vertex 0 so every edge is (i, i + 1) without a wrap
+    vertexX.clear();
+    vertexY.clear();
+    if (vertices.empty()) return;
+    vertexX.resize(vertices.size() + 1);
+    vertexY.resize(vertices.size() + 1);
+    for (size_t i = 0; i <= vertices.size(); ++i) {
+        vertexX[i] = vertex(i).getX();
+        vertexY[i] = vertex(i).getY();
+    }
+}
+
+/**
+ * @brief Fan search from vertex 0: find the wedge holding the point, then test its outer edge.
+ */
+template <class T>
+HullLocation HullIndex<T>::locate(const PointType& point) const {
+    size_t count = vertices.size();
+    if (count == 0) return HULL_OUTSIDE;
+    if (count == 1) return point == vertices[0] ? HULL_BOUNDARY : HULL_OUTSIDE;
+    if (count == 2)
+        return vertices[0].cross(vertices[1], point) == 0 && betweenEnds(vertices[0], vertices[1], point)
+                   ? HULL_BOUNDARY : HULL_OUTSIDE;
+
+    // The two edges at vertex 0 bound the fan
+    const PointType& origin = vertices[0];
+    Wide first = origin.cross(vertices[1], point);
+    Wide last = vertices[count - 1].cross(origin, point);
+    if (first > 0 || last > 0) return HULL_OUTSIDE;
+    if (first == 0) return betweenEnds(origin, vertices[1], point) ? HULL_BOUNDARY : HULL_OUTSIDE;
+    if (last == 0) return betweenEnds(vertices[count - 1], origin, point) ? HULL_BOUNDARY : HULL_OUTSIDE;
+
+    // Last fan ray the point is left of (or on)
+    size_t low = 1, high = count - 1;
+    while (high - low > 1) {
+        size_t middle = (low + high) / 2;
+        if (origin.cross(vertices[middle], point) <= 0) low = middle;
+        else high = middle;
+    }
+
+    Wide outer = vertices[low].cross(vertices[low + 1], point);
+    if (outer > 0) return HULL_OUTSIDE;
+    return outer == 0 ? HULL_BOUNDARY : HULL_INSIDE;
+}
+
+/**
+ * @brief A point is inside a convex polygon when no edge has it on its outer side, so the
+ * largest edge cross product classifies it: negative inside, zero on the boundary.
+ */
+template <class T>
+void HullIndex<T>::locateBatch(const T* xs, const T* ys, size_t count, unsigned char* locations) const {
+    size_t edges = vertices.size();
+    if (edges < 3 || edges > QUERY_LINEAR_HULL_LIMIT) {
+        for (size_t i = 0; i < count; ++i) locations[i] = locate(PointType(xs[i], ys[i]));
+        return;
+    }
+
+    Wide largest[QUERY_BATCH_CHUNK];
+    for (size_t base = 0; base < count; base += QUERY_BATCH_CHUNK) {
+        size_t chunk = std::min<size_t>(QUERY_BATCH_CHUNK, count - base);
+        const T* x = xs + base;
+        const T* y = ys + base;
+        std::fill(largest, largest + chunk, std::numeric_limits<Wide>::lowest());
+
+        for (size_t e = 0; e < edges; ++e) {
+            Wide startX = vertexX[e], startY = vertexY[e];
+            Wide edgeX = (Wide)vertexX[e + 1] - startX, edgeY = (Wide)vertexY[e + 1] - startY;
+            for (size_t i = 0; i < chunk; ++i) {
+                Wide side = edgeY * ((Wide)x[i] - startX) - edgeX * ((Wide)y[i] - startY);
+                largest[i] = side > largest[i] ? side : largest[i];
+            }
+        }
+
+        for (size_t i = 0; i < chunk; ++i)
+            locations[base + i] = largest[i] > 0 ? HULL_OUTSIDE : largest[i] == 0 ? HULL_BOUNDARY : HULL_INSIDE;
+    }
+}
+
+/**
+ * @brief The farthest vertex of the chain of edges [first, last) in direction (dx, dy), or one
+ * of its ends.
+ *
+ * The edge directions turn by less than half a turn, so their projections on (dx, dy) change
+ * sign at most once. If the first edge advances, the peak is where the edges stop advancing;
+ * otherwise it is at one of the chain's ends, which the caller checks anyway.
+ */
+template <class T>
+size_t HullIndex<T>::chainPeak(size_t first, size_t last, T dx, T dy) const {
+    auto advances = [&](size_t edge) {
+        const PointType& from = vertex(edge);
+        const PointType& to = vertex(edge + 1);
+        return ((Wide)to.getX() - from.getX()) * dx + ((Wide)to.getY() - from.getY()) * dy > 0;
+    };
+    if (first >= last || !advances(first)) return first;
+
+    // First edge that does not advance; its start is the peak
+    size_t low = first, high = last;
+    while (high - low > 1) {
+        size_t middle = (low + high) / 2;
+        if (advances(middle)) low = middle;
+        else high = middle;
+    }
+    return high % vertices.size();
+}
+
+template <class T>
+bool HullIndex<T>::extreme(T dx, T dy, PointType& farthest) const {
+    size_t count = vertices.size();
+    if (count == 0) return false;
+
+    size_t candidates[4] = {0, rightmost, 0, 0};
+    size_t candidateCount = 2;
+    if (count >= 3) {
+        candidates[candidateCount++] = chainPeak(0, rightmost, dx, dy);
+        candidates[candidateCount++] = chainPeak(rightmost, count, dx, dy);
+    } else {
+        candidates[1] = count - 1;
+    }
+
+    size_t best = candidates[0];
+    Wide bestValue = (Wide)vertices[best].getX() * dx + (Wide)vertices[best].getY() * dy;
+    for (size_t i = 1; i < candidateCount; ++i) {
+        Wide value = (Wide)vertices[candidates[i]].getX() * dx + (Wide)vertices[candidates[i]].getY() * dy;
+        if (value > bestValue) {
+            best = candidates[i];
+            bestValue = value;
+        }
+    }
+    farthest = vertices[best];
+    return true;
+}
+
+/**
+ * @brief Finds the run of edges in [first, last) that @p point faces.
+ *
+ * The edges are non-vertical and x is monotone along them. Evaluated at the point's x, the
+ * edge lines of a convex chain peak (lower chain) or bottom out (upper chain) at the edge
+ * spanning that x and change monotonically away from it, so the edges the point faces form
+ * one run around that edge, and both of its ends can be found by binary search.
+ *
+ * @return False if the point faces none of them.
+ */
+template <class T>
+bool HullIndex<T>::facingRun(size_t first, size_t last, bool increasingX, const PointType& point,
+                             size_t& runFirst, size_t& runLast) const {
+    if (first >= last) return false;
+
+    // Edge spanning the point's x: the last one starting at or before it along the chain
+    size_t low = first, high = last;
+    while (high - low > 1) {
+        size_t middle = (low + high) / 2;
+        bool before = increasingX ? vertex(middle).getX() <= point.getX() : vertex(middle).getX() >= point.getX();
+        if (before) low = middle;
+        else high = middle;
+    }
+    size_t spanning = low;
+    if (!facing(spanning, point)) return false;
+
+    runFirst = first;
+    if (!facing(first, point)) {
+        low = first;
+        high = spanning;
+        while (high - low > 1) {
+            size_t middle = (low + high) / 2;
+            if (facing(middle, point)) high = middle;
+            else low = middle;
+        }
+        runFirst = high;
+    }
+
+    runLast = last - 1;
+    if (!facing(last - 1, point)) {
+        low = spanning;
+        high = last - 1;
+        while (high - low > 1) {
+            size_t middle = (low + high) / 2;
+            if (facing(middle, point)) low = middle;
+            else high = middle;
+        }
+        runLast = low;
+    }
+    return true;
+}
+
+/**
+ * @brief The tangent vertices are the ends of the run of edges the point faces. That run is
+ * contiguous around the hull, so its ends are among the ends of its pieces on each chain and
+ * the vertical edges that can close a chain.
+ */
+template <class T>
+bool HullIndex<T>::tangents(const PointType& point, PointType& first, PointType& second) const {
+    size_t count = vertices.size();
+    if (count < 3 || locate(point) != HULL_OUTSIDE) return false;
+
+    // A vertical edge can only be the last edge of a chain
+    size_t lowerEnd = rightmost, upperEnd = count;
+    if (vertices[rightmost - 1].getX() == vertices[rightmost].getX()) lowerEnd--;
+    if (vertices[count - 1].getX() == vertices[0].getX()) upperEnd--;
+
+    size_t candidates[6];
+    size_t candidateCount = 0;
+    size_t runFirst, runLast;
+    if (facingRun(0, lowerEnd, true, point, runFirst, runLast)) {
+        candidates[candidateCount++] = runFirst;
+        candidates[candidateCount++] = runLast;
+    }
+    if (facingRun(rightmost, upperEnd, false, point, runFirst, runLast)) {
+        candidates[candidateCount++] = runFirst;
+        candidates[candidateCount++] = runLast;
+    }
+    if (lowerEnd != rightmost) candidates[candidateCount++] = lowerEnd;
+    if (upperEnd != count) candidates[candidateCount++] = upperEnd;
+
+    size_t start = count, end = count;
+    for (size_t i = 0; i < candidateCount; ++i) {
+        size_t edge = candidates[i];
+        if (!facing(edge, point)) continue;
+        if (!facing(edge + count - 1, point)) start = edge;
+        if (!facing(edge + 1, point)) end = edge;
+    }
+    if (start == count || end == count) return false;
+
+    first = vertex(start);
+    second = vertex(end + 1);
+    return true;
+}
+
+template class HullIndex<int32_t>;
+template class HullIndex<float>;
+template class HullIndex<double>;
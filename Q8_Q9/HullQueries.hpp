@@ -0,0 +1,96 @@
+#ifndef HULL_QUERIES_HPP
+#define HULL_QUERIES_HPP
+
+#include <cstddef>
+#include <vector>
+#include "ConvexHull.hpp"
+
+using std::vector;
+
+#define QUERY_LINEAR_HULL_LIMIT 16 // Up to this many vertices, batches test every edge in a vectorizable loop
+
+/**
+ * @brief Where a point lies relative to a hull.
+ */
+enum HullLocation {
+    HULL_OUTSIDE = 0,
+    HULL_BOUNDARY,
+    HULL_INSIDE
+};
+
+/**
+ * @brief A computed hull prepared for point queries, each answered in O(log h).
+ *
+ * The hull is counter-clockwise from the leftmost point with no collinear vertices,
+ * as BasicConvexHull produces it. Its lower chain runs from vertex 0 to the rightmost
+ * vertex and its upper chain back again; along each chain x is monotone and the edge
+ * directions turn by less than half a turn, which is what the binary searches rely on.
+ */
+template <class T>
+class HullIndex {
+private:
+    typedef BasicPoint<T> PointType;
+    typedef typename PointType::Wide Wide;
+
+    vector<PointType> vertices;
+    size_t rightmost = 0;       // Last vertex of the lower chain
+
+    // Vertex coordinates as separate arrays, for batches over small hulls
+    vector<T> vertexX;
+    vector<T> vertexY;
+
+    const PointType& vertex(size_t index) const { return vertices[index % vertices.size()]; }
+
+    // True if @p point is on or outside the line of edge (index, index + 1)
+    bool facing(size_t edge, const PointType& point) const {
+        return vertex(edge).cross(vertex(edge + 1), point) >= 0;
+    }
+
+    size_t chainPeak(size_t first, size_t last, T dx, T dy) const;
+    bool facingRun(size_t first, size_t last, bool increasingX, const PointType& point,
+                   size_t& runFirst, size_t& runLast) const;
+
+public:
+    /**
+     * @brief Replaces the indexed hull, in O(h).
+     */
+    void assign(const vector<PointType>& hull);
+
+    const vector<PointType>& hull() const { return vertices; }
+
+    /**
+     * @brief Whether @p point is inside, on the boundary of, or outside the hull.
+     */
+    HullLocation locate(const PointType& point) const;
+
+    /**
+     * @brief Locates @p count points given as coordinate arrays, writing one HullLocation per point.
+     *
+     * Hulls of up to QUERY_LINEAR_HULL_LIMIT vertices are tested edge by edge across the
+     * whole batch, a branch-free loop over the arrays the compiler vectorizes; larger hulls
+     * fall back to locate() per point.
+     */
+    void locateBatch(const T* xs, const T* ys, size_t count, unsigned char* locations) const;
+
+    /**
+     * @brief The vertex farthest in direction (dx, dy).
+     * @return False if the hull is empty.
+     */
+    bool extreme(T dx, T dy, PointType& farthest) const;
+
+    /**
+     * @brief The two vertices where the tangents from @p point touch the hull.
+     *
+     * Seen from @p point, the hull lies between the rays to @p first and @p second; when a
+     * tangent runs along an edge the farther endpoint is reported.
+     *
+     * @return False if the hull has fewer than three vertices or @p point is not outside it.
+     */
+    bool tangents(const PointType& point, PointType& first, PointType& second) const;
+};
+
+extern template class HullIndex<int32_t>;
+extern template class HullIndex<float>;
+extern template class HullIndex<double>;
+
+#endif // HULL_QUERIES_HPP
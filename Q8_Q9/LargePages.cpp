@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "LargePages.hpp"
+
+#define TOUCH_STRIDE 4096 // Writing one byte per base page faults the whole page in
+
+static std::atomic<int> pagePolicy(PAGES_DEFAULT);
+static std::atomic<int> numaPolicy(NUMA_LOCAL);
+
+static size_t roundToLargePages(size_t bytes) {
+    return (bytes + LARGE_PAGE_SIZE - 1) & ~(LARGE_PAGE_SIZE - 1);
+}
+
+// Maps length + one large page and trims both ends so the block starts on a large page boundary
+static void* mapAligned(size_t length) {
+    size_t padded = length + LARGE_PAGE_SIZE;
+    void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return nullptr;
+
+    uintptr_t start = (uintptr_t)raw, aligned = (start + LARGE_PAGE_SIZE - 1) & ~(LARGE_PAGE_SIZE - 1);
+    if (aligned > start) munmap(raw, aligned - start);
+    size_t tail = (start + padded) - (aligned + length);
+    if (tail > 0) munmap((void*)(aligned + length), tail);
+    return (void*)aligned;
+}
+
+// Interleaves the pages of a block over every node; without libnuma, via the raw syscall
+static void interleave(void* block, size_t length) {
+    unsigned int nodes = LargePages::nodeCount();
+    if (nodes < 2) return;
+
+    unsigned long nodeMask[16] = {0};
+    for (unsigned int node = 0; node < nodes && node < sizeof(nodeMask) * 8; ++node)
+        nodeMask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+    if (syscall(SYS_mbind, block, length, MPOL_INTERLEAVE, nodeMask, sizeof(nodeMask) * 8, 0) != 0)
+        perror("mbind");
+}
+
+// Faults the block in from as many threads as the parallel hull stages start, one slice each
+static void touchInSlices(void* block, size_t length) {
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    char* bytes = static_cast<char*>(block);
+    size_t sliceSize = (length / threads + TOUCH_STRIDE - 1) & ~(size_t)(TOUCH_STRIDE - 1);
+
+    auto touch = [bytes, length](size_t begin, size_t end) {
+        for (size_t offset = begin; offset < std::min(end, length); offset += TOUCH_STRIDE) bytes[offset] = 0;
+    };
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t + 1 < threads; ++t)
+        workers.emplace_back(touch, t * sliceSize, (t + 1) * sliceSize);
+    touch((threads - 1) * sliceSize, length);
+    for (std::thread& worker : workers) worker.join();
+}
+
+void LargePages::configure(PagePolicy pages, NumaPolicy numa) {
+    pagePolicy = pages;
+    numaPolicy = numa;
+}
+
+bool LargePages::parsePagePolicy(const char* name, PagePolicy& pages) {
+    static const struct { const char* name; PagePolicy value; } names[] = {
+        {"default", PAGES_DEFAULT},
+        {"small", PAGES_SMALL},
+        {"thp", PAGES_TRANSPARENT},
+        {"explicit", PAGES_EXPLICIT},
+    };
+    for (const auto& entry : names) {
+        if (strcmp(entry.name, name) == 0) {
+            pages = entry.value;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LargePages::parseNumaPolicy(const char* name, NumaPolicy& numa) {
+    static const struct { const char* name; NumaPolicy value; } names[] = {
+        {"local", NUMA_LOCAL},
+        {"interleave", NUMA_INTERLEAVE},
+        {"firsttouch", NUMA_FIRST_TOUCH},
+    };
+    for (const auto& entry : names) {
+        if (strcmp(entry.name, name) == 0) {
+            numa = entry.value;
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned int LargePages::nodeCount() {
+    static unsigned int nodes = [] {
+        // "possible" lists node ranges such as "0" or "0-3"
+        unsigned int highest = 0;
+        FILE* possible = fopen("/sys/devices/system/node/possible", "r");
+        if (possible) {
+            char ranges[64] = {0};
+            if (fgets(ranges, sizeof(ranges), possible)) {
+                const char* last = strrchr(ranges, '-');
+                if (!last) last = strrchr(ranges, ',');
+                highest = (unsigned int)atoi(last ? last + 1 : ranges);
+            }
+            fclose(possible);
+        }
+        return highest + 1;
+    }();
+    return nodes;
+}
+
+void* LargePages::allocate(size_t bytes) {
+    if (bytes < LARGE_PAGE_THRESHOLD) return ::operator new(bytes);
+
+    size_t length = roundToLargePages(bytes);
+    PagePolicy pages = (PagePolicy)pagePolicy.load();
+    void* block = nullptr;
+
+    if (pages == PAGES_EXPLICIT) {
+        block = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (block == MAP_FAILED) {
+            block = nullptr;
+            pages = PAGES_TRANSPARENT; // The hugetlb pool is empty or too small
+        }
+    }
+    if (block == nullptr) {
+        block = mapAligned(length);
+        if (block == nullptr) throw std::bad_alloc();
+        if (pages == PAGES_TRANSPARENT) madvise(block, length, MADV_HUGEPAGE);
+        else if (pages == PAGES_SMALL) madvise(block, length, MADV_NOHUGEPAGE);
+    }
+
+    // The NUMA policy has to be in place before the first write faults a page in
+    NumaPolicy numa = (NumaPolicy)numaPolicy.load();
+    if (numa == NUMA_INTERLEAVE) interleave(block, length);
+    else if (numa == NUMA_FIRST_TOUCH) touchInSlices(block, length);
+    return block;
+}
+
+void LargePages::deallocate(void* block, size_t bytes) {
+    if (block == nullptr) return;
+    if (bytes < LARGE_PAGE_THRESHOLD) {
+        ::operator delete(block);
+        return;
+    }
+    munmap(block, roundToLargePages(bytes));
+}
@@ -0,0 +1,90 @@
+#ifndef LARGE_PAGES_HPP
+#define LARGE_PAGES_HPP
+
+#include <cstddef>
+#include <new>
+
+#define LARGE_PAGE_SIZE (2UL << 20)           // x86-64 huge page
+#define LARGE_PAGE_THRESHOLD (2 * LARGE_PAGE_SIZE) // Smaller blocks come from the regular heap
+
+/**
+ * @brief Page size used for large blocks.
+ */
+enum PagePolicy {
+    PAGES_DEFAULT = 0,  // mmap without advice; the system THP setting decides, as for large malloc blocks
+    PAGES_SMALL,        // mmap with transparent huge pages disabled (4 KiB pages)
+    PAGES_TRANSPARENT,  // mmap aligned to LARGE_PAGE_SIZE with MADV_HUGEPAGE
+    PAGES_EXPLICIT      // MAP_HUGETLB from the reserved pool, else PAGES_TRANSPARENT
+};
+
+/**
+ * @brief NUMA placement of large blocks.
+ */
+enum NumaPolicy {
+    NUMA_LOCAL = 0,    // Kernel default: pages land on the node of the thread that first writes them
+    NUMA_INTERLEAVE,   // Pages are spread round-robin over every node (mbind MPOL_INTERLEAVE)
+    NUMA_FIRST_TOUCH   // The block is pre-faulted in slices by the same number of threads the hull uses
+};
+
+/**
+ * @brief Process-wide policy and raw allocation of large page-backed blocks.
+ *
+ * Blocks of LARGE_PAGE_THRESHOLD bytes or more are mapped directly, rounded up to
+ * whole large pages; smaller ones come from operator new.
+ */
+class LargePages {
+public:
+    /**
+     * @brief Sets the policies for blocks allocated from now on. Blocks already handed
+     * out keep the policy they were allocated with, which deallocate() does not need.
+     */
+    static void configure(PagePolicy pages, NumaPolicy numa);
+
+    /**
+     * @brief Parses "default", "small", "thp" or "explicit".
+     */
+    static bool parsePagePolicy(const char* name, PagePolicy& pages);
+
+    /**
+     * @brief Parses "local", "interleave" or "firsttouch".
+     */
+    static bool parseNumaPolicy(const char* name, NumaPolicy& numa);
+
+    /**
+     * @brief Allocates @p bytes; throws std::bad_alloc on failure.
+     */
+    static void* allocate(size_t bytes);
+
+    /**
+     * @brief Releases a block returned by allocate() for the same @p bytes.
+     */
+    static void deallocate(void* block, size_t bytes);
+
+    /**
+     * @brief Number of NUMA nodes the kernel reports (1 without NUMA).
+     */
+    static unsigned int nodeCount();
+};
+
+/**
+ * @brief Standard allocator over LargePages, for the point store and the hull scratch buffers.
+ */
+template <class T>
+class LargePageAllocator {
+public:
+    typedef T value_type;
+
+    LargePageAllocator() noexcept {}
+    template <class U>
+    LargePageAllocator(const LargePageAllocator<U>&) noexcept {}
+
+    T* allocate(size_t count) { return static_cast<T*>(LargePages::allocate(count * sizeof(T))); }
+    void deallocate(T* block, size_t count) noexcept { LargePages::deallocate(block, count * sizeof(T)); }
+
+    template <class U>
+    bool operator==(const LargePageAllocator<U>&) const noexcept { return true; }
+    template <class U>
+    bool operator!=(const LargePageAllocator<U>&) const noexcept { return false; }
+};
+
+#endif // LARGE_PAGES_HPP
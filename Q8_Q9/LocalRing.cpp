@@ -0,0 +1,321 @@
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#include "LocalRing.hpp"
+
+#define LOCAL_SEGMENT_MAGIC 0x474E495248534C43ULL // "CLSHRING"
+#define LOCAL_DATA_OFFSET 4096                     // The rings' data start on a page of their own
+
+// The segment is mapped by two processes, so these are not the _PRIVATE futex operations
+static void futexWait(std::atomic<uint32_t>& word, uint32_t expected, int timeoutMs) {
+    struct timespec timeout = {timeoutMs / 1000, (long)(timeoutMs % 1000) * 1000000};
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+static void futexWake(std::atomic<uint32_t>& word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+static inline uint64_t padded(uint64_t length) {
+    return (length + 7) & ~(uint64_t)7;
+}
+
+// The peer closed its end of the Unix socket, or the socket failed
+static bool peerGone(int fd) {
+    char byte;
+    ssize_t peeked = recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    return peeked == 0 || (peeked < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+}
+
+static void wakeIfSleeping(std::atomic<uint32_t>& sleeping) {
+    if (sleeping.load(std::memory_order_seq_cst) && sleeping.exchange(0, std::memory_order_seq_cst))
+        futexWake(sleeping);
+}
+
+void LocalRing::attach(LocalRingControl* ringControl, char* ringData, uint64_t ringSize, int ringPeerFd) {
+    control = ringControl;
+    data = ringData;
+    size = ringSize;
+    position = 0;
+    reserved = 0;
+    peerFd = ringPeerFd;
+}
+
+bool LocalRing::waitFor(std::atomic<uint32_t>& sleeping, bool producer, uint64_t needed) {
+    auto ready = [&] {
+        if (producer) return position + needed - control->tail.load(std::memory_order_seq_cst) <= size;
+        return control->head.load(std::memory_order_seq_cst) != position;
+    };
+
+    // With one CPU the peer cannot make progress while this side spins
+    static const int spinCount = std::thread::hardware_concurrency() > 1 ? LOCAL_SPIN_COUNT : 0;
+    for (int spin = 0; spin < spinCount; ++spin) {
+        if (ready()) return true;
+        cpuRelax();
+    }
+
+    while (true) {
+        // Announce the sleep, then look again so that a publish in between is not missed
+        sleeping.store(1, std::memory_order_seq_cst);
+        if (ready()) {
+            sleeping.store(0, std::memory_order_relaxed);
+            return true;
+        }
+        futexWait(sleeping, 1, LOCAL_RING_POLL_MS);
+        sleeping.store(0, std::memory_order_relaxed);
+        if (ready()) return true;
+        if (peerGone(peerFd)) return false;
+    }
+}
+
+char* LocalRing::reserve(size_t length) {
+    if (length > maxMessage()) {
+        errno = EMSGSIZE;
+        return nullptr;
+    }
+    uint64_t total = sizeof(LocalMessage) + padded(length);
+    uint64_t offset = position % size;
+    uint64_t filler = offset + total > size ? size - offset : 0;
+    if (position + filler + total - control->tail.load(std::memory_order_acquire) > size &&
+        !waitFor(control->writerSleeping, true, filler + total)) {
+        errno = EPIPE;
+        return nullptr;
+    }
+
+    if (filler > 0) {
+        LocalMessage wrap = {(uint32_t)(filler - sizeof(LocalMessage)), LOCAL_WRAP, 0};
+        memcpy(data + offset, &wrap, sizeof wrap);
+        offset = 0;
+    }
+    reserved = filler;
+    return data + offset + sizeof(LocalMessage);
+}
+
+void LocalRing::commit(LocalMessageType type, size_t length) {
+    uint64_t start = position + reserved;
+    LocalMessage header = {(uint32_t)length, (uint16_t)type, 0};
+    memcpy(data + start % size, &header, sizeof header);
+    position = start + sizeof(LocalMessage) + padded(length);
+    reserved = 0;
+    control->head.store(position, std::memory_order_seq_cst);
+    wakeIfSleeping(control->readerSleeping);
+}
+
+char* LocalRing::next(LocalMessage& message) {
+    while (true) {
+        uint64_t head = control->head.load(std::memory_order_acquire);
+        if (head == position) {
+            if (!waitFor(control->readerSleeping, false, 0)) return nullptr;
+            head = control->head.load(std::memory_order_acquire);
+        }
+
+        // The producer is another process; a header that does not fit is a damaged ring
+        uint64_t offset = position % size;
+        if (head - position > size || head - position < sizeof(LocalMessage)) return nullptr;
+        memcpy(&message, data + offset, sizeof message);
+        uint64_t total = sizeof(LocalMessage) + padded(message.length);
+        if (offset + total > size || total > head - position) return nullptr;
+
+        if (message.type == LOCAL_WRAP) {
+            if (offset + total != size) return nullptr;
+            position += total;
+            continue;
+        }
+        reserved = total;
+        return data + offset + sizeof(LocalMessage);
+    }
+}
+
+void LocalRing::release() {
+    position += reserved;
+    reserved = 0;
+    control->tail.store(position, std::memory_order_seq_cst);
+    wakeIfSleeping(control->writerSleeping);
+}
+
+// Points both rings into a mapped segment; requests flow from the client, replies to it
+template <class Side>
+static void attachRings(Side& side, LocalSegment* segment, int fd) {
+    char* base = reinterpret_cast<char*>(segment) + LOCAL_DATA_OFFSET;
+    side.requests.attach(&segment->requests, base, segment->ringBytes, fd);
+    side.replies.attach(&segment->replies, base + segment->ringBytes, segment->ringBytes, fd);
+}
+
+LocalRingServer::~LocalRingServer() {
+    if (segment != nullptr) munmap(segment, mappedBytes);
+}
+
+bool LocalRingServer::open(int fd) {
+    mappedBytes = LOCAL_DATA_OFFSET + 2 * (size_t)LOCAL_RING_BYTES;
+    int memoryFd = memfd_create("hull-local-ring", MFD_CLOEXEC);
+    if (memoryFd < 0) return false;
+    void* mapped = MAP_FAILED;
+    if (ftruncate(memoryFd, mappedBytes) == 0)
+        mapped = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, memoryFd, 0);
+    if (mapped == MAP_FAILED) {
+        int error = errno;
+        ::close(memoryFd);
+        errno = error;
+        return false;
+    }
+
+    // A new memfd reads as zeros, which is every position and flag at rest
+    segment = new (mapped) LocalSegment();
+    segment->magic = LOCAL_SEGMENT_MAGIC;
+    segment->ringBytes = LOCAL_RING_BYTES;
+    attachRings(*this, segment, fd);
+
+    char reply = (char)LOCAL_MAGIC;
+    struct iovec payload = {&reply, 1};
+    union {
+        struct cmsghdr header;
+        char space[CMSG_SPACE(sizeof(int))];
+    } control;
+    memset(&control, 0, sizeof control);
+    struct msghdr message;
+    memset(&message, 0, sizeof message);
+    message.msg_iov = &payload;
+    message.msg_iovlen = 1;
+    message.msg_control = control.space;
+    message.msg_controllen = sizeof control.space;
+    struct cmsghdr* rights = CMSG_FIRSTHDR(&message);
+    rights->cmsg_level = SOL_SOCKET;
+    rights->cmsg_type = SCM_RIGHTS;
+    rights->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(rights), &memoryFd, sizeof(int));
+
+    bool sent = sendmsg(fd, &message, MSG_NOSIGNAL) == 1;
+    int error = errno;
+    ::close(memoryFd);
+    errno = error;
+    return sent;
+}
+
+LocalRingClient::~LocalRingClient() {
+    close();
+}
+
+bool LocalRingClient::connect(const char* path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof address);
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof address.sun_path) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    strcpy(address.sun_path, path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    char greeting[3];
+    char request = (char)LOCAL_MAGIC;
+    if (::connect(fd, (struct sockaddr*)&address, sizeof address) != 0 ||
+        recv(fd, greeting, sizeof greeting, MSG_WAITALL) != sizeof greeting ||
+        ::send(fd, &request, 1, MSG_NOSIGNAL) != 1) {
+        close();
+        return false;
+    }
+
+    char reply;
+    struct iovec payload = {&reply, 1};
+    union {
+        struct cmsghdr header;
+        char space[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct msghdr message;
+    memset(&message, 0, sizeof message);
+    message.msg_iov = &payload;
+    message.msg_iovlen = 1;
+    message.msg_control = control.space;
+    message.msg_controllen = sizeof control.space;
+    struct cmsghdr* rights = nullptr;
+    if (recvmsg(fd, &message, MSG_CMSG_CLOEXEC) == 1) rights = CMSG_FIRSTHDR(&message);
+    if (rights == nullptr || rights->cmsg_type != SCM_RIGHTS || (unsigned char)reply != LOCAL_MAGIC) {
+        close();
+        errno = EPROTO;
+        return false;
+    }
+    int memoryFd;
+    memcpy(&memoryFd, CMSG_DATA(rights), sizeof(int));
+
+    struct stat status;
+    void* mapped = MAP_FAILED;
+    if (fstat(memoryFd, &status) == 0 && (size_t)status.st_size > LOCAL_DATA_OFFSET) {
+        mappedBytes = status.st_size;
+        mapped = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, memoryFd, 0);
+    }
+    ::close(memoryFd);
+    if (mapped == MAP_FAILED) {
+        close();
+        return false;
+    }
+    segment = static_cast<LocalSegment*>(mapped);
+    if (segment->magic != LOCAL_SEGMENT_MAGIC || LOCAL_DATA_OFFSET + 2 * segment->ringBytes != mappedBytes) {
+        close();
+        errno = EPROTO;
+        return false;
+    }
+    attachRings(*this, segment, fd);
+    return true;
+}
+
+bool LocalRingClient::send(const char* command, size_t length) {
+    char* payload = requests.reserve(length + 1);
+    if (payload == nullptr) return false;
+    memcpy(payload, command, length);
+    payload[length] = '\0';
+    requests.commit(LOCAL_COMMAND, length + 1);
+    return true;
+}
+
+size_t LocalRingClient::sendPoints(const double* coordinates, size_t count) {
+    size_t perMessage = requests.maxMessage() / (2 * sizeof(double));
+    size_t messages = 0;
+    for (size_t sent = 0; sent < count; ++messages) {
+        size_t points = count - sent < perMessage ? count - sent : perMessage;
+        char* payload = requests.reserve(points * 2 * sizeof(double));
+        if (payload == nullptr) return 0;
+        memcpy(payload, coordinates + 2 * sent, points * 2 * sizeof(double));
+        requests.commit(LOCAL_POINTS, points * 2 * sizeof(double));
+        sent += points;
+    }
+    return messages;
+}
+
+bool LocalRingClient::receive(std::string& reply) {
+    LocalMessage message;
+    char* payload = replies.next(message);
+    if (payload == nullptr) return false;
+    reply.assign(payload, message.length);
+    replies.release();
+    return true;
+}
+
+bool LocalRingClient::call(const char* command, std::string& reply) {
+    return send(command, strlen(command)) && receive(reply);
+}
+
+void LocalRingClient::close() {
+    if (segment != nullptr) munmap(segment, mappedBytes);
+    segment = nullptr;
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
@@ -0,0 +1,187 @@
+#ifndef LOCAL_RING_HPP
+#define LOCAL_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#define LOCAL_MAGIC 0xC7                // First byte of the request for a ring; no text command starts with it
+#define LOCAL_RING_BYTES (8 << 20)      // Data bytes of each direction's ring; a message takes at most half
+#define LOCAL_RING_POLL_MS 100          // How often a waiting side checks that its peer is still there
+#define LOCAL_SPIN_COUNT 256            // Polls of a ring before its reader sleeps on the doorbell
+
+/**
+ * @brief Kinds of messages in a ring.
+ */
+enum LocalMessageType {
+    LOCAL_WRAP = 0,  // Filler up to the end of the ring; the next message starts at offset 0
+    LOCAL_COMMAND,   // A text command, as sent over a socket, followed by a '\0'
+    LOCAL_POINTS,    // (x, y) pairs of doubles to add to the current graph
+    LOCAL_REPLY      // The text of a reply, without the ">> " prompt
+};
+
+/**
+ * @brief Header of every message, followed by length bytes and padded to 8.
+ */
+struct LocalMessage {
+    uint32_t length;
+    uint16_t type;
+    uint16_t reserved;
+};
+static_assert(sizeof(LocalMessage) == 8, "LocalMessage must not be padded");
+
+/**
+ * @brief The shared state of one direction: who has written and read how far, and the doorbell.
+ *
+ * The positions only grow; the offset into the data is the position modulo the ring size.
+ * A reader that runs out of messages raises readerSleeping and sleeps on it with a futex,
+ * and a writer that runs out of room does the same with writerSleeping. The other side
+ * only makes the wake-up system call when the flag is raised.
+ */
+struct LocalRingControl {
+    alignas(64) std::atomic<uint64_t> head;      // Written by the producer
+    alignas(64) std::atomic<uint64_t> tail;      // Written by the consumer
+    alignas(64) std::atomic<uint32_t> readerSleeping;
+    std::atomic<uint32_t> writerSleeping;
+};
+
+/**
+ * @brief Layout of the shared segment: the two rings' control blocks, then their data.
+ */
+struct LocalSegment {
+    uint64_t magic;
+    uint64_t ringBytes;
+    LocalRingControl requests;
+    LocalRingControl replies;
+};
+
+/**
+ * @brief One side of one direction of a shared ring: a single producer or a single consumer.
+ *
+ * A message is never split across the end of the ring, so the consumer reads it where it
+ * lies and the producer writes it in place. @p peerFd is the Unix socket the ring was set
+ * up over; it is only watched, so that a side waiting on a dead peer gives up.
+ */
+class LocalRing {
+private:
+    LocalRingControl* control = nullptr;
+    char* data = nullptr;
+    uint64_t size = 0;
+    uint64_t position = 0;   // This side's own head (producer) or tail (consumer)
+    uint64_t reserved = 0;   // Bytes the pending reservation takes, filler included
+    int peerFd = -1;
+
+    bool waitFor(std::atomic<uint32_t>& sleeping, bool producer, uint64_t needed);
+
+public:
+    void attach(LocalRingControl* control, char* data, uint64_t size, int peerFd);
+
+    /**
+     * @brief Producer: room for a message of @p length bytes, waiting while the ring is full.
+     * @return Where to write the payload, or nullptr if the peer is gone or the message is too long.
+     */
+    char* reserve(size_t length);
+
+    /**
+     * @brief Producer: publishes the reserved message, trimmed to @p length bytes.
+     */
+    void commit(LocalMessageType type, size_t length);
+
+    /**
+     * @brief Consumer: waits for the next message.
+     * @return Its payload, writable until release(); nullptr if the peer is gone or the ring is damaged.
+     */
+    char* next(LocalMessage& message);
+
+    /**
+     * @brief Consumer: hands the space of the message next() returned back to the producer.
+     */
+    void release();
+
+    /**
+     * @brief The longest message the ring carries.
+     */
+    size_t maxMessage() const { return size / 2 - sizeof(LocalMessage); }
+};
+
+/**
+ * @brief Server side of a local client: creates the shared segment and passes it over the Unix socket.
+ */
+class LocalRingServer {
+private:
+    LocalSegment* segment = nullptr;
+    size_t mappedBytes = 0;
+
+public:
+    LocalRing requests;
+    LocalRing replies;
+
+    LocalRingServer() {}
+    ~LocalRingServer();
+
+    LocalRingServer(const LocalRingServer&) = delete;
+    LocalRingServer& operator=(const LocalRingServer&) = delete;
+
+    /**
+     * @brief Answers the client's request for a ring on @p fd with the segment's descriptor.
+     * @return False with errno set if it could not be created or sent, e.g. over a TCP socket.
+     */
+    bool open(int fd);
+};
+
+/**
+ * @brief A client on the same host: commands go through shared memory instead of a socket.
+ *
+ * Requests and replies each have a single-producer, single-consumer ring. Several
+ * requests may be sent before their replies are read; they are answered in order.
+ */
+class LocalRingClient {
+private:
+    int fd = -1;
+    LocalSegment* segment = nullptr;
+    size_t mappedBytes = 0;
+
+public:
+    LocalRing requests;
+    LocalRing replies;
+
+    LocalRingClient() {}
+    ~LocalRingClient();
+
+    LocalRingClient(const LocalRingClient&) = delete;
+    LocalRingClient& operator=(const LocalRingClient&) = delete;
+
+    /**
+     * @brief Connects to the server's Unix socket at @p path and maps the ring it sends back.
+     * @return False with errno set on failure.
+     */
+    bool connect(const char* path);
+
+    /**
+     * @brief Queues a text command such as "CH" or "AddPoint 1,2"; no trailing newline is needed.
+     */
+    bool send(const char* command, size_t length);
+
+    /**
+     * @brief Queues @p count points given as (x, y) pairs for the current graph.
+     *
+     * Larger batches than one message holds are split; each part gets its own reply.
+     * @return The number of messages queued, 0 if the server is gone or @p count is 0.
+     */
+    size_t sendPoints(const double* coordinates, size_t count);
+
+    /**
+     * @brief Waits for the reply to the oldest command not yet answered.
+     */
+    bool receive(std::string& reply);
+
+    /**
+     * @brief send() then receive().
+     */
+    bool call(const char* command, std::string& reply);
+
+    void close();
+};
+
+#endif // LOCAL_RING_HPP
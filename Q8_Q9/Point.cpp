@@ -3,9 +3,13 @@
 /**
  * @brief Determines the orientation of three points (this, mid, other).
  */
-RelativeOrientation Point::orientation(const Point& mid, const Point& other) const {
-    float orientationValue = (mid.getY() - getY()) * (other.getX() - getX()) -
-                             (mid.getX() - getX()) * (other.getY() - getY());
+template <class T>
+RelativeOrientation BasicPoint<T>::orientation(const BasicPoint& mid, const BasicPoint& other) const {
+    Wide orientationValue = cross(mid, other);
     if (orientationValue == 0) return COLLINEAR;
     return (orientationValue > 0) ? CLOCKWISE : COUNTER_CLOCKWISE;
 }
+
+template class BasicPoint<int32_t>;
+template class BasicPoint<float>;
+template class BasicPoint<double>;
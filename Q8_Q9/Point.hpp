@@ -1,4 +1,7 @@
 #include <cmath>
+#include <cstdint>
+#include <vector>
+#include "LargePages.hpp"
 
 #ifndef GEOMETRY_UTILS_POINT_HPP
 #define GEOMETRY_UTILS_POINT_HPP
@@ -13,50 +16,114 @@ enum RelativeOrientation {
 };
 
 /**
- * @brief A class representing a 2D point with basic geometric operations.
+ * @brief Compile-time properties of a coordinate type.
+ *
+ * Wide is the type cross products are evaluated in. For int32_t it is int64_t,
+ * which makes orientation tests exact as long as coordinates stay within
+ * [MIN_COORDINATE, MAX_COORDINATE]. Area is the type areas are reported in.
  */
-class Point {
+template <class T> struct CoordinateTraits;
+
+template <> struct CoordinateTraits<int32_t> {
+    typedef int64_t Wide;
+    typedef double Area;
+    static constexpr bool exact = true;
+    static constexpr int32_t MIN_COORDINATE = -(1 << 30);
+    static constexpr int32_t MAX_COORDINATE = (1 << 30) - 1;
+    static constexpr const char* name = "int";
+};
+
+template <> struct CoordinateTraits<float> {
+    typedef double Wide;
+    typedef float Area;
+    static constexpr bool exact = false;
+    static constexpr float MIN_COORDINATE = -3.0e38f;
+    static constexpr float MAX_COORDINATE = 3.0e38f;
+    static constexpr const char* name = "float";
+};
+
+template <> struct CoordinateTraits<double> {
+    typedef long double Wide;
+    typedef double Area;
+    static constexpr bool exact = false;
+    static constexpr double MIN_COORDINATE = -1.0e300;
+    static constexpr double MAX_COORDINATE = 1.0e300;
+    static constexpr const char* name = "double";
+};
+
+/**
+ * @brief A 2D point with coordinates of type T and basic geometric operations.
+ */
+template <class T>
+class BasicPoint {
 private:
-    float coordinateX;
-    float coordinateY;
+    T coordinateX;
+    T coordinateY;
 
 public:
-    Point() : coordinateX(0), coordinateY(0) {}
-    Point(float x, float y) : coordinateX(x), coordinateY(y) {}
+    typedef T Coordinate;
+    typedef typename CoordinateTraits<T>::Wide Wide;
+
+    BasicPoint() : coordinateX(0), coordinateY(0) {}
+    BasicPoint(T x, T y) : coordinateX(x), coordinateY(y) {}
 
-    float getX() const { return coordinateX; }
-    float getY() const { return coordinateY; }
+    T getX() const { return coordinateX; }
+    T getY() const { return coordinateY; }
+
+    /**
+     * @brief Twice the signed area of the triangle (this, mid, other), evaluated in the wide type.
+     *
+     * Positive when the three points turn clockwise.
+     */
+    Wide cross(const BasicPoint& mid, const BasicPoint& other) const {
+        return ((Wide)mid.coordinateY - coordinateY) * ((Wide)other.coordinateX - coordinateX) -
+               ((Wide)mid.coordinateX - coordinateX) * ((Wide)other.coordinateY - coordinateY);
+    }
 
     /**
      * @brief Computes the orientation of three points (this, mid, other).
-     * 
+     *
      * @param mid The second point.
      * @param other The third point.
      * @return The orientation: COLLINEAR, CLOCKWISE, or COUNTER_CLOCKWISE.
      */
-    RelativeOrientation orientation(const Point& mid, const Point& other) const;
+    RelativeOrientation orientation(const BasicPoint& mid, const BasicPoint& other) const;
 
     /**
      * @brief Calculates the Euclidean distance between this point and another point.
-     * 
+     *
      * @param other The other point.
      * @return The distance between the points.
      */
-    double computeDistance(const Point& other) const {
-        return sqrt(pow(coordinateX - other.coordinateX, 2) + pow(coordinateY - other.coordinateY, 2));
+    double computeDistance(const BasicPoint& other) const {
+        return sqrt(pow((double)coordinateX - other.coordinateX, 2) + pow((double)coordinateY - other.coordinateY, 2));
     }
 
-    bool operator==(const Point& other) const {
+    bool operator==(const BasicPoint& other) const {
         return coordinateX == other.coordinateX && coordinateY == other.coordinateY;
     }
-    bool operator!=(const Point& other) const { return !(*this == other); }
+    bool operator!=(const BasicPoint& other) const { return !(*this == other); }
 
-    bool operator<(const Point& other) const {
+    bool operator<(const BasicPoint& other) const {
         return coordinateX < other.coordinateX || (coordinateX == other.coordinateX && coordinateY < other.coordinateY);
     }
-    bool operator>(const Point& other) const { return other < *this; }
-    bool operator<=(const Point& other) const { return !(*this > other); }
-    bool operator>=(const Point& other) const { return !(*this < other); }
+    bool operator>(const BasicPoint& other) const { return other < *this; }
+    bool operator<=(const BasicPoint& other) const { return !(*this > other); }
+    bool operator>=(const BasicPoint& other) const { return !(*this < other); }
 };
 
+extern template class BasicPoint<int32_t>;
+extern template class BasicPoint<float>;
+extern template class BasicPoint<double>;
+
+typedef BasicPoint<int32_t> IntPoint;
+typedef BasicPoint<float> Point;
+typedef BasicPoint<double> DoublePoint;
+
+/**
+ * @brief Storage for large point sets: graphs and the buffers the hull sorts in.
+ */
+template <class T>
+using PointVector = std::vector<BasicPoint<T>, LargePageAllocator<BasicPoint<T>>>;
+
 #endif // GEOMETRY_UTILS_POINT_HPP
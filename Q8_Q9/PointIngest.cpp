@@ -0,0 +1,250 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "PointIngest.hpp"
+
+static inline size_t padded(size_t length) {
+    return (length + 7) & ~(size_t)7;
+}
+
+// "name from address:port", the key a sender's sequence of datagrams for a graph is tracked under
+static std::string sourceName(const char* name, size_t nameLength, const struct sockaddr_storage& address) {
+    char host[INET6_ADDRSTRLEN] = "unknown";
+    unsigned int port = 0;
+    if (address.ss_family == AF_INET) {
+        const struct sockaddr_in* ipv4 = reinterpret_cast<const struct sockaddr_in*>(&address);
+        inet_ntop(AF_INET, &ipv4->sin_addr, host, sizeof host);
+        port = ntohs(ipv4->sin_port);
+    } else if (address.ss_family == AF_INET6) {
+        const struct sockaddr_in6* ipv6 = reinterpret_cast<const struct sockaddr_in6*>(&address);
+        inet_ntop(AF_INET6, &ipv6->sin6_addr, host, sizeof host);
+        port = ntohs(ipv6->sin6_port);
+    }
+    std::string source(name, nameLength);
+    source += " from ";
+    source += host;
+    source += ':';
+    source += std::to_string(port);
+    return source;
+}
+
+bool PointIngest::open(const char* port) {
+    struct addrinfo hints, *serverInfo, *current;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    int status = getaddrinfo(NULL, port, &hints, &serverInfo);
+    if (status != 0) {
+        fprintf(stderr, "Ingest error: %s\n", gai_strerror(status));
+        errno = EINVAL;
+        return false;
+    }
+    for (current = serverInfo; current != NULL; current = current->ai_next) {
+        fd = socket(current->ai_family, current->ai_socktype | SOCK_CLOEXEC, current->ai_protocol);
+        if (fd < 0) continue;
+        if (bind(fd, current->ai_addr, current->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(serverInfo);
+    if (fd < 0) return false;
+
+    // Past net.core.rmem_max only with CAP_NET_ADMIN
+    int bufferBytes = INGEST_RECEIVE_BUFFER;
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &bufferBytes, sizeof bufferBytes) != 0)
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferBytes, sizeof bufferBytes);
+    return true;
+}
+
+void PointIngest::start() {
+    std::thread(&PointIngest::run, this).detach();
+}
+
+// Called with sourcesMutex held
+bool PointIngest::track(const std::string& source, uint64_t sequence) {
+    auto found = sources.find(source);
+    if (found == sources.end()) {
+        if (sources.size() >= INGEST_MAX_SOURCES) return true;
+        SequenceTracker& tracker = sources[source];
+        tracker.first = sequence;
+        tracker.newest = sequence;
+        tracker.seen = 1;
+        tracker.datagrams = 1;
+        return true;
+    }
+
+    SequenceTracker& tracker = found->second;
+    tracker.datagrams++;
+    if (sequence > tracker.newest) {
+        uint64_t gap = sequence - tracker.newest;
+        tracker.lost += gap - 1;
+        tracker.seen = gap >= INGEST_SEQUENCE_WINDOW ? 1 : (tracker.seen << gap) | 1;
+        tracker.newest = sequence;
+        return true;
+    }
+
+    // Behind the window there is no telling a late datagram from a duplicate: it is
+    // taken, and the loss count is left alone
+    tracker.reordered++;
+    uint64_t behind = tracker.newest - sequence;
+    if (behind >= INGEST_SEQUENCE_WINDOW) return true;
+
+    uint64_t bit = 1ULL << behind;
+    if (tracker.seen & bit) {
+        tracker.reordered--;
+        tracker.duplicates++;
+        return false;
+    }
+    tracker.seen |= bit;
+    if (sequence > tracker.first) {
+        tracker.lost--; // Fills a gap counted when a later datagram skipped over it
+    } else {
+        tracker.lost += tracker.first - sequence - 1; // Numbers between it and the first are now skipped
+        tracker.first = sequence;
+    }
+    return true;
+}
+
+void PointIngest::run() {
+    // Each datagram lands 8-aligned, so its doubles are applied where they lie
+    std::vector<uint64_t> storage(INGEST_BATCH * INGEST_MAX_DATAGRAM / sizeof(uint64_t));
+    struct mmsghdr messages[INGEST_BATCH];
+    struct iovec vectors[INGEST_BATCH];
+    struct sockaddr_storage addresses[INGEST_BATCH];
+
+    struct Batch {
+        std::string name;
+        const double* coordinates;
+        uint32_t count;
+    };
+    std::vector<Batch> batches;
+    batches.reserve(INGEST_BATCH);
+
+    while (true) {
+        for (int i = 0; i < INGEST_BATCH; ++i) {
+            vectors[i].iov_base = reinterpret_cast<char*>(storage.data()) + (size_t)i * INGEST_MAX_DATAGRAM;
+            vectors[i].iov_len = INGEST_MAX_DATAGRAM;
+            memset(&messages[i].msg_hdr, 0, sizeof messages[i].msg_hdr);
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = &addresses[i];
+            messages[i].msg_hdr.msg_namelen = sizeof addresses[i];
+        }
+        // Blocks for the first datagram only, then takes what is already queued
+        int received = recvmmsg(fd, messages, INGEST_BATCH, MSG_WAITFORONE, nullptr);
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            perror("recvmmsg");
+            return;
+        }
+
+        batches.clear();
+        uint64_t bad = 0;
+        {
+            std::lock_guard<std::mutex> lock(sourcesMutex);
+            for (int i = 0; i < received; ++i) {
+                const char* datagram = static_cast<const char*>(vectors[i].iov_base);
+                size_t length = messages[i].msg_len;
+                IngestHeader header;
+                if (length < sizeof header || (messages[i].msg_hdr.msg_flags & MSG_TRUNC)) {
+                    bad++;
+                    continue;
+                }
+                memcpy(&header, datagram, sizeof header);
+                const char* name = datagram + sizeof header;
+                size_t pointsOffset = sizeof header + padded(header.nameLength);
+                if (header.magic != INGEST_MAGIC || pointsOffset + (size_t)header.count * 2 * sizeof(double) != length ||
+                    !GraphRegistry::validName(name, header.nameLength)) {
+                    bad++;
+                    continue;
+                }
+                if (!track(sourceName(name, header.nameLength, addresses[i]), header.sequence)) continue;
+                batches.push_back({std::string(name, header.nameLength),
+                                   reinterpret_cast<const double*>(datagram + pointsOffset), header.count});
+            }
+        }
+
+        // A run of datagrams for one graph takes its mutex once; graphs are not created
+        // from datagrams, which anyone can send
+        uint64_t applied = 0, offered = 0, missing = 0;
+        if (log != nullptr && log->hasFailed()) {
+            for (const Batch& batch : batches) offered += batch.count;
+            batches.clear();
+        }
+        for (size_t i = 0; i < batches.size();) {
+            std::shared_ptr<NamedGraph> graph = registry.find(batches[i].name);
+            size_t j = i;
+            if (graph == nullptr) {
+                for (; j < batches.size() && batches[j].name == batches[i].name; ++j) missing += batches[j].count;
+                i = j;
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(graph->mutex);
+            for (; j < batches.size() && batches[j].name == batches[i].name; ++j) {
+                applied += graph->engine->applyPoints(false, batches[j].coordinates, batches[j].count);
+                offered += batches[j].count;
+            }
+            i = j;
+        }
+        datagrams += received;
+        malformed += bad;
+        unknown += missing;
+        points += applied;
+        rejected += offered - applied;
+    }
+}
+
+void PointIngest::report(ResponseBuffer& response) {
+    response.append("Ingest: ");
+    response.appendUnsigned(datagrams);
+    response.append(" datagrams, ");
+    response.appendUnsigned(points);
+    response.append(" points, ");
+    response.appendUnsigned(malformed);
+    response.append(" malformed, ");
+    response.appendUnsigned(rejected);
+    response.append(" points rejected, ");
+    response.appendUnsigned(unknown);
+    response.append(" points for graphs that do not exist");
+
+    std::lock_guard<std::mutex> lock(sourcesMutex);
+    for (const auto& source : sources) {
+        const SequenceTracker& tracker = source.second;
+        response.append('\n');
+        response.append(source.first.c_str());
+        response.append(": ");
+        response.appendUnsigned(tracker.datagrams);
+        response.append(" datagrams up to sequence ");
+        response.appendUnsigned(tracker.newest);
+        response.append(", ");
+        response.appendUnsigned(tracker.lost);
+        response.append(" lost, ");
+        response.appendUnsigned(tracker.reordered);
+        response.append(" reordered, ");
+        response.appendUnsigned(tracker.duplicates);
+        response.append(" duplicates");
+    }
+}
+
+size_t PointIngest::pack(char* buffer, size_t capacity, const std::string& name, uint64_t sequence,
+                         const double* coordinates, size_t count) {
+    size_t pointsOffset = sizeof(IngestHeader) + padded(name.size());
+    size_t length = pointsOffset + count * 2 * sizeof(double);
+    if (length > capacity || name.size() > UINT16_MAX || count > UINT32_MAX) return 0;
+
+    IngestHeader header = {INGEST_MAGIC, 0, (uint16_t)name.size(), (uint32_t)count, sequence};
+    memcpy(buffer, &header, sizeof header);
+    memset(buffer + sizeof header, 0, pointsOffset - sizeof header);
+    memcpy(buffer + sizeof header, name.data(), name.size());
+    memcpy(buffer + pointsOffset, coordinates, count * 2 * sizeof(double));
+    return length;
+}
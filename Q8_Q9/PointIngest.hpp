@@ -0,0 +1,108 @@
+#ifndef POINT_INGEST_HPP
+#define POINT_INGEST_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include "GraphRegistry.hpp"
+#include "WriteAheadLog.hpp"
+#include "Protocol.hpp"
+
+#define INGEST_MAGIC 0xC8                 // First byte of every datagram
+#define INGEST_BATCH 64                   // Datagrams taken per recvmmsg
+#define INGEST_MAX_DATAGRAM 65536         // Largest datagram read; longer ones are truncated and dropped
+#define INGEST_RECEIVE_BUFFER (16 << 20)  // SO_RCVBUF asked for, to ride out bursts while a graph is locked
+#define INGEST_SEQUENCE_WINDOW 64         // Sequence numbers behind the newest that are checked for duplicates
+#define INGEST_MAX_SOURCES 4096           // Senders whose sequences are tracked; later ones are only counted
+
+/**
+ * @brief Header of an ingest datagram. It is followed by the graph's name, padded to 8,
+ * then count (x, y) pairs of doubles.
+ *
+ * Fields are in host byte order, as on the ShardLink. Each sender numbers its datagrams
+ * for a graph from any starting point, one up per datagram; the sender is identified by
+ * its address and port.
+ */
+struct IngestHeader {
+    uint8_t magic;
+    uint8_t reserved;
+    uint16_t nameLength;
+    uint32_t count;
+    uint64_t sequence;
+};
+static_assert(sizeof(IngestHeader) == 16, "IngestHeader must not be padded");
+
+/**
+ * @brief Receives point batches over UDP and appends them to the named graphs, which must exist.
+ *
+ * One thread drains the socket INGEST_BATCH datagrams per recvmmsg call and applies
+ * consecutive datagrams for the same graph under one hold of its mutex. Nothing is
+ * acknowledged: a sender learns about losses from "Ingest" only.
+ */
+class PointIngest {
+private:
+    /**
+     * @brief What one sender's sequence numbers for one graph say about the stream.
+     */
+    struct SequenceTracker {
+        uint64_t first = 0;       // Lowest number taken; numbers before it are not counted lost
+        uint64_t newest = 0;
+        uint64_t seen = 0;        // Bit i: newest - i has arrived
+        uint64_t datagrams = 0;
+        uint64_t lost = 0;        // Between first and newest, skipped over and not (yet) arrived
+        uint64_t reordered = 0;   // Arrived after a later one
+        uint64_t duplicates = 0;
+    };
+
+    GraphRegistry& registry;
+    WriteAheadLog* log;
+    int fd = -1;
+
+    std::atomic<uint64_t> datagrams{0};
+    std::atomic<uint64_t> points{0};
+    std::atomic<uint64_t> malformed{0};
+    std::atomic<uint64_t> rejected{0};   // Out of range for the coordinate type, or the log failed
+    std::atomic<uint64_t> unknown{0};    // For a graph that does not exist
+
+    std::mutex sourcesMutex;
+    std::map<std::string, SequenceTracker> sources; // "graph from address:port"
+
+    void run();
+
+    // Updates the sender's tracker; false for a duplicate, which is not applied again
+    bool track(const std::string& source, uint64_t sequence);
+
+public:
+    /**
+     * @param log The log the graphs write to, if any; once it has failed, points are rejected.
+     */
+    PointIngest(GraphRegistry& registry, WriteAheadLog* log) : registry(registry), log(log) {}
+
+    PointIngest(const PointIngest&) = delete;
+    PointIngest& operator=(const PointIngest&) = delete;
+
+    /**
+     * @brief Binds the UDP socket on @p port.
+     * @return False with errno set on failure.
+     */
+    bool open(const char* port);
+
+    void start();
+
+    /**
+     * @brief Handles "Ingest": totals, then each sender's losses, reorderings and duplicates.
+     */
+    void report(ResponseBuffer& response);
+
+    /**
+     * @brief Writes a datagram of @p count points for graph @p name into @p buffer.
+     * @return Its length, or 0 if it does not fit in @p capacity.
+     */
+    static size_t pack(char* buffer, size_t capacity, const std::string& name, uint64_t sequence,
+                       const double* coordinates, size_t count);
+};
+
+#endif // POINT_INGEST_HPP
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include "PointSort.hpp"
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES (64 / RADIX_BITS)
+#define MIN_KEYS_PER_THREAD 262144  // Below this, starting a thread costs more than it saves
+
+// The keys live in the points' own storage while sorting; memcpy keeps that free of aliasing issues
+static inline uint64_t loadKey(const unsigned char* base, size_t i) {
+    uint64_t key;
+    memcpy(&key, base + i * sizeof(key), sizeof(key));
+    return key;
+}
+
+static inline void storeKey(unsigned char* base, size_t i, uint64_t key) {
+    memcpy(base + i * sizeof(key), &key, sizeof(key));
+}
+
+/**
+ * @brief Encodes a slice of points into keys in place and counts every digit of every pass.
+ */
+template <class T>
+static void encodeSlice(BasicPoint<T>* points, size_t begin, size_t end, size_t* histograms) {
+    unsigned char* base = reinterpret_cast<unsigned char*>(points);
+    for (size_t i = begin; i < end; ++i) {
+        const BasicPoint<T> point = points[i];
+        uint64_t key = pointKey(point);
+        storeKey(base, i, key);
+        for (int pass = 0; pass < RADIX_PASSES; ++pass)
+            histograms[pass * RADIX_BUCKETS + ((key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1))]++;
+    }
+}
+
+template <class T>
+static void decodeSlice(BasicPoint<T>* points, size_t begin, size_t end) {
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(points);
+    for (size_t i = begin; i < end; ++i) points[i] = keyPoint<T>(loadKey(base, i));
+}
+
+static void countSlice(const unsigned char* source, size_t begin, size_t end, int shift, size_t* counts) {
+    for (size_t i = begin; i < end; ++i)
+        counts[(loadKey(source, i) >> shift) & (RADIX_BUCKETS - 1)]++;
+}
+
+// offsets holds this slice's first output index for every digit and is advanced while scattering
+static void scatterSlice(const unsigned char* source, unsigned char* target, size_t begin, size_t end,
+                         int shift, size_t* offsets) {
+    for (size_t i = begin; i < end; ++i) {
+        uint64_t key = loadKey(source, i);
+        storeKey(target, offsets[(key >> shift) & (RADIX_BUCKETS - 1)]++, key);
+    }
+}
+
+/**
+ * @brief Runs fn(t, begin, end) for each of @p threads equal slices of [0, count),
+ * the last slice on the calling thread. So do the slices of threads that could not
+ * be started: fn(t, ...) only has to own slice t, not a thread.
+ */
+template <class Function>
+static void forEachSlice(size_t count, unsigned int threads, Function fn) {
+    vector<std::thread> workers;
+    size_t sliceSize = count / threads;
+    unsigned int t = 0;
+    try {
+        workers.reserve(threads - 1);
+        for (; t + 1 < threads; ++t)
+            workers.emplace_back(fn, t, t * sliceSize, (t + 1) * sliceSize);
+    } catch (const std::exception&) {
+        // Thrown with workers running; letting it escape would destroy them joinable
+    }
+    for (; t + 1 < threads; ++t) fn(t, t * sliceSize, (t + 1) * sliceSize);
+    fn(threads - 1, (threads - 1) * sliceSize, count);
+    for (std::thread& worker : workers) worker.join();
+}
+
+template <class T>
+void PointSorter::radixSort(PointVector<T>& points, unsigned int threads) {
+    static_assert(sizeof(BasicPoint<T>) == sizeof(uint64_t), "a point must fit its 64-bit key");
+    size_t count = points.size();
+    if (count < 2) return;
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t maxThreads = std::max<size_t>(1, count / MIN_KEYS_PER_THREAD);
+    if (threads > maxThreads) threads = (unsigned int)maxThreads;
+
+    // Encode in place; the digit histograms of the whole input tell which passes can be skipped
+    vector<size_t> histograms((size_t)threads * RADIX_PASSES * RADIX_BUCKETS, 0);
+    forEachSlice(count, threads, [&](unsigned int t, size_t begin, size_t end) {
+        encodeSlice(points.data(), begin, end, &histograms[(size_t)t * RADIX_PASSES * RADIX_BUCKETS]);
+    });
+
+    vector<uint64_t, LargePageAllocator<uint64_t>> scratch(count);
+    unsigned char* source = reinterpret_cast<unsigned char*>(points.data());
+    unsigned char* target = reinterpret_cast<unsigned char*>(scratch.data());
+    vector<size_t> offsets((size_t)threads * RADIX_BUCKETS);
+
+    for (int pass = 0; pass < RADIX_PASSES; ++pass) {
+        // A pass where every key has the same digit would not move anything
+        bool uniform = false;
+        for (int digit = 0; digit < RADIX_BUCKETS && !uniform; ++digit) {
+            size_t total = 0;
+            for (unsigned int t = 0; t < threads; ++t)
+                total += histograms[((size_t)t * RADIX_PASSES + pass) * RADIX_BUCKETS + digit];
+            uniform = (total == count);
+        }
+        if (uniform) continue;
+
+        int shift = pass * RADIX_BITS;
+        std::fill(offsets.begin(), offsets.end(), 0);
+        forEachSlice(count, threads, [&](unsigned int t, size_t begin, size_t end) {
+            countSlice(source, begin, end, shift, &offsets[(size_t)t * RADIX_BUCKETS]);
+        });
+
+        // Digit-major prefix sum: slice t writes its keys with a given digit after slices 0..t-1
+        size_t next = 0;
+        for (int digit = 0; digit < RADIX_BUCKETS; ++digit) {
+            for (unsigned int t = 0; t < threads; ++t) {
+                size_t& slot = offsets[(size_t)t * RADIX_BUCKETS + digit];
+                size_t digitCount = slot;
+                slot = next;
+                next += digitCount;
+            }
+        }
+
+        forEachSlice(count, threads, [&](unsigned int t, size_t begin, size_t end) {
+            scatterSlice(source, target, begin, end, shift, &offsets[(size_t)t * RADIX_BUCKETS]);
+        });
+        std::swap(source, target);
+    }
+
+    // After an odd number of passes the keys are in the scratch buffer
+    if (source != reinterpret_cast<unsigned char*>(points.data()))
+        memcpy(points.data(), source, count * sizeof(uint64_t));
+
+    forEachSlice(count, threads, [&](unsigned int, size_t begin, size_t end) {
+        decodeSlice(points.data(), begin, end);
+    });
+}
+
+template <class T>
+void PointSorter::sort(PointVector<T>& points, unsigned int threads) {
+    if (points.size() < RADIX_SORT_THRESHOLD) {
+        std::sort(points.begin(), points.end());
+        return;
+    }
+    radixSort(points, threads);
+}
+
+template <>
+void PointSorter::sort(PointVector<double>& points, unsigned int) {
+    std::sort(points.begin(), points.end());
+}
+
+template void PointSorter::sort(PointVector<int32_t>&, unsigned int);
+template void PointSorter::sort(PointVector<float>&, unsigned int);
+template void PointSorter::radixSort(PointVector<int32_t>&, unsigned int);
+template void PointSorter::radixSort(PointVector<float>&, unsigned int);
@@ -0,0 +1,87 @@
+#ifndef POINT_SORT_HPP
+#define POINT_SORT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "Point.hpp"
+
+using std::vector;
+
+#define RADIX_SORT_THRESHOLD 4096 // Below this std::sort is faster than the radix passes
+
+/**
+ * @brief Order-preserving mapping of a coordinate onto an unsigned 32-bit key.
+ */
+template <class T> struct RadixKey;
+
+template <> struct RadixKey<int32_t> {
+    static uint32_t encode(int32_t value) { return (uint32_t)value ^ 0x80000000u; }
+    static int32_t decode(uint32_t key) { return (int32_t)(key ^ 0x80000000u); }
+};
+
+// Negative floats compare in reverse bit order, so their bits are inverted; positive
+// floats only get the sign bit set. NaN sorts at the ends. -0.0 is encoded as 0.0, since
+// Point::operator< finds them equal and orders such points by y.
+template <> struct RadixKey<float> {
+    static uint32_t encode(float value) {
+        if (value == 0.0f) value = 0.0f;
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+    static float decode(uint32_t key) {
+        uint32_t bits = (key & 0x80000000u) ? (key & 0x7FFFFFFFu) : ~key;
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
+/**
+ * @brief Sorts points lexicographically by (x, y), as Point::operator< orders them.
+ *
+ * Large int and float inputs are sorted with a parallel LSD radix sort. Each point
+ * is mapped to an order-preserving 64-bit key (x in the high half, y in the low half).
+ * The mapping is a bijection on the coordinate values (-0.0 comes back as 0.0), so the
+ * keys are sorted in the points' own storage and decoded back in place. The extra
+ * memory is one key buffer.
+ * Small inputs, and double points, which have no 64-bit key, use std::sort.
+ */
+class PointSorter {
+public:
+    /**
+     * @brief Sorts @p points in place.
+     *
+     * @param points The points to sort.
+     * @param threads Worker threads for the radix passes; 0 uses every hardware thread.
+     */
+    template <class T>
+    static void sort(PointVector<T>& points, unsigned int threads = 0);
+
+    /**
+     * @brief Sorts with the radix path regardless of the input size (int and float only).
+     */
+    template <class T>
+    static void radixSort(PointVector<T>& points, unsigned int threads = 0);
+};
+
+// double coordinates do not fit a 64-bit key, so they always use std::sort
+template <>
+void PointSorter::sort(PointVector<double>& points, unsigned int threads);
+
+/**
+ * @brief The 64-bit sort key of a point: x in the high half, y in the low half (int and float only).
+ */
+template <class T>
+inline uint64_t pointKey(const BasicPoint<T>& point) {
+    return ((uint64_t)RadixKey<T>::encode(point.getX()) << 32) | RadixKey<T>::encode(point.getY());
+}
+
+template <class T>
+inline BasicPoint<T> keyPoint(uint64_t key) {
+    return BasicPoint<T>(RadixKey<T>::decode((uint32_t)(key >> 32)), RadixKey<T>::decode((uint32_t)key));
+}
+
+#endif // POINT_SORT_HPP
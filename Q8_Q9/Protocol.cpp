@@ -0,0 +1,39 @@
+#include <cstring>
+#include "Protocol.hpp"
+
+void ResponseBuffer::appendFloat(float value) {
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr - digits);
+}
+
+void ResponseBuffer::appendUnsigned(size_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr - digits);
+}
+
+bool TextProtocol::parseCommandCount(const char* input, size_t prefixLength, size_t& count) {
+    const char* end = input + strlen(input);
+    if (input + prefixLength > end) return false;
+
+    const char* begin = skipBlanks(input + prefixLength, end);
+    return std::from_chars(begin, end, count).ec == std::errc();
+}
+
+void PointLineBuffer::take(const char* input, size_t length, const char*& begin, const char*& end) {
+    begin = input;
+    end = input + length;
+    if (!tail.empty()) {
+        joined.assign(tail);
+        joined.append(input, length);
+        begin = joined.data();
+        end = begin + joined.size();
+    }
+
+    const char* lineEnd = end;
+    while (lineEnd != begin && lineEnd[-1] != '\n') --lineEnd;
+    if (end - lineEnd > POINT_LINE_MAX) lineEnd = end;
+    tail.assign(lineEnd, end);
+    end = lineEnd;
+}
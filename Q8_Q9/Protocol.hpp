@@ -0,0 +1,241 @@
+#ifndef TEXT_PROTOCOL_HPP
+#define TEXT_PROTOCOL_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#define RESPONSE_RESERVE 256 // Initial capacity of a connection's response buffer
+
+/**
+ * @brief A reusable buffer that a connection formats its replies into.
+ *
+ * Clearing keeps the capacity, so once a connection has sent its longest
+ * reply no further heap allocations are made while building responses.
+ */
+class ResponseBuffer {
+private:
+    std::string buffer;
+
+public:
+    ResponseBuffer() { buffer.reserve(RESPONSE_RESERVE); }
+
+    void clear() { buffer.clear(); }
+
+    void append(const char* text) { buffer.append(text); }
+    void append(const char* text, size_t length) { buffer.append(text, length); }
+    void append(char c) { buffer.push_back(c); }
+
+    /**
+     * @brief Appends a float in its shortest round-trip representation.
+     */
+    void appendFloat(float value);
+
+    /**
+     * @brief Appends an unsigned integer in decimal.
+     */
+    void appendUnsigned(size_t value);
+
+    /**
+     * @brief Appends an integer or floating point coordinate in its shortest round-trip form.
+     */
+    template <class T>
+    void appendNumber(T value) {
+        char digits[32];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, result.ptr - digits);
+    }
+
+    /**
+     * @brief Appends "(x,y)".
+     */
+    template <class T>
+    void appendPoint(T x, T y) {
+        buffer.push_back('(');
+        appendNumber(x);
+        buffer.push_back(',');
+        appendNumber(y);
+        buffer.push_back(')');
+    }
+
+    const char* data() const { return buffer.data(); }
+    size_t size() const { return buffer.size(); }
+};
+
+/**
+ * @brief Locale-independent parsing for the "x,y" text protocol, built on std::from_chars.
+ */
+class TextProtocol {
+public:
+    /**
+     * @brief Parses a point of the form "x,y" (spaces allowed around the comma).
+     *
+     * @param begin Start of the text.
+     * @param end One past the last character of the text.
+     * @param x Receives the x coordinate.
+     * @param y Receives the y coordinate.
+     * @return Pointer just past the parsed point, or nullptr if the text is not a point.
+     *
+     * T may be any type std::from_chars accepts; for integer coordinates "1.5,2" is rejected.
+     */
+    template <class T>
+    static const char* parsePoint(const char* begin, const char* end, T& x, T& y) {
+        begin = skipBlanks(begin, end);
+        auto first = std::from_chars(begin, end, x);
+        if (first.ec != std::errc()) return nullptr;
+
+        begin = skipBlanks(first.ptr, end);
+        if (begin == end || *begin != ',') return nullptr;
+
+        begin = skipBlanks(begin + 1, end);
+        auto second = std::from_chars(begin, end, y);
+        if (second.ec != std::errc()) return nullptr;
+
+        return second.ptr;
+    }
+
+    /**
+     * @brief Parses the point argument of a command such as "AddPoint x,y".
+     *
+     * @param input The full command line (NUL terminated).
+     * @param prefixLength Length of the command word preceding the point.
+     * @return True if a point followed the command word.
+     */
+    template <class T>
+    static bool parseCommandPoint(const char* input, size_t prefixLength, T& x, T& y) {
+        const char* end = input + strlen(input);
+        if (input + prefixLength > end) return false;
+        return parsePoint(input + prefixLength, end, x, y) != nullptr;
+    }
+
+    /**
+     * @brief Parses an unsigned count following a command word, e.g. "Newgraph 100".
+     */
+    static bool parseCommandCount(const char* input, size_t prefixLength, size_t& count);
+
+    /**
+     * @brief Finds the next blank-separated word.
+     *
+     * @param cursor Read position; advanced past the word.
+     * @param end One past the last character of the text.
+     * @param word Receives the start of the word.
+     * @param length Receives the length of the word.
+     * @return False if only blanks and line breaks remain.
+     */
+    static bool nextWord(const char*& cursor, const char* end, const char*& word, size_t& length) {
+        cursor = skipLineBreaks(cursor, end);
+        word = cursor;
+        while (cursor != end && *cursor != ' ' && *cursor != '\t' && *cursor != '\n' && *cursor != '\r') ++cursor;
+        length = cursor - word;
+        return length > 0;
+    }
+
+    /**
+     * @brief Bulk mode: parses consecutive "x,y" lines straight into a point container.
+     *
+     * Blank lines are skipped. Parsing stops after @p limit points, at the end of the
+     * buffer, or at the first line that is not a point.
+     *
+     * @param begin Start of the buffer.
+     * @param end One past the last character of the buffer.
+     * @param points Container the points are emplaced into.
+     * @param limit Maximum number of points to take.
+     * @param parsed Receives the number of points appended.
+     * @return Pointer to the first unconsumed character; equals @p end unless a bad line was hit
+     *         or the limit was reached.
+     */
+    template <class PointContainer>
+    static const char* parsePointLines(const char* begin, const char* end, PointContainer& points,
+                                       size_t limit, size_t& parsed) {
+        parsed = 0;
+        while (parsed < limit) {
+            begin = skipLineBreaks(begin, end);
+            if (begin == end) break;
+
+            typename PointContainer::value_type::Coordinate x, y;
+            const char* next = parsePoint(begin, end, x, y);
+            if (next == nullptr) break;
+
+            next = skipBlanks(next, end);
+            if (next != end && *next != '\n' && *next != '\r') break;
+
+            points.emplace_back(x, y);
+            parsed++;
+            begin = next;
+        }
+        return skipLineBreaks(begin, end);
+    }
+
+    /**
+     * @brief Parses the blank-separated points of one line, e.g. "1,2 3,4 5,6".
+     *
+     * @param begin Start of the line.
+     * @param end One past the last character of the buffer.
+     * @param points Container the points are emplaced into.
+     * @param parsed Receives the number of points appended.
+     * @return Pointer just past the line break ending the line (or @p end), or nullptr if the
+     *         line holds something other than points.
+     */
+    template <class PointContainer>
+    static const char* parsePointList(const char* begin, const char* end, PointContainer& points, size_t& parsed) {
+        parsed = 0;
+        while (true) {
+            begin = skipBlanks(begin, end);
+            if (begin == end || *begin == '\n' || *begin == '\r') break;
+
+            typename PointContainer::value_type::Coordinate x, y;
+            const char* next = parsePoint(begin, end, x, y);
+            if (next == nullptr) return nullptr;
+
+            points.emplace_back(x, y);
+            parsed++;
+            begin = next;
+        }
+        if (begin != end && *begin == '\r') ++begin;
+        if (begin != end && *begin == '\n') ++begin;
+        return begin;
+    }
+
+private:
+    static const char* skipBlanks(const char* begin, const char* end) {
+        while (begin != end && (*begin == ' ' || *begin == '\t')) ++begin;
+        return begin;
+    }
+
+    static const char* skipLineBreaks(const char* begin, const char* end) {
+        while (begin != end && (*begin == '\n' || *begin == '\r' || *begin == ' ' || *begin == '\t')) ++begin;
+        return begin;
+    }
+};
+
+#define POINT_LINE_MAX 256 // Longest unfinished line carried over to the next read
+
+/**
+ * @brief Frames the point lines of bulk mode across reads.
+ *
+ * A read can end in the middle of a line. Its unfinished tail is kept and put in front
+ * of the next read, so that parsePointLines only sees whole lines. A tail longer than
+ * any point line is passed on as it is, for the parser to reject.
+ */
+class PointLineBuffer {
+private:
+    std::string joined; // The carried tail followed by the new read
+    std::string tail;
+
+public:
+    /**
+     * @brief Takes the next read and returns the whole lines it completes.
+     *
+     * @param begin Receives the start of the whole lines.
+     * @param end Receives one past their last line break; equals @p begin if the read completed none.
+     */
+    void take(const char* input, size_t length, const char*& begin, const char*& end);
+
+    /**
+     * @brief Drops the carried tail, when a graph's points are complete or rejected.
+     */
+    void clear() { tail.clear(); }
+};
+
+#endif // TEXT_PROTOCOL_HPP
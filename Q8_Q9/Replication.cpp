@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Replication.hpp"
+
+static bool readFull(int fd, void* data, size_t length) {
+    char* cursor = static_cast<char*>(data);
+    while (length > 0) {
+        ssize_t received = recv(fd, cursor, length, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        cursor += received;
+        length -= received;
+    }
+    return true;
+}
+
+static bool writeFull(int fd, const void* data, size_t length) {
+    const char* cursor = static_cast<const char*>(data);
+    while (length > 0) {
+        ssize_t sent = send(fd, cursor, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        cursor += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+// Comparable between processes, and roughly between machines with synchronized clocks
+static uint64_t wallClock() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static size_t padded(size_t length) {
+    return (length + 7) & ~(size_t)7;
+}
+
+static bool sendFrame(int fd, ReplicationFrameType type, uint64_t lsn, uint64_t sentAt, const void* data = nullptr,
+                      size_t length = 0, uint32_t count = 0) {
+    ReplicationFrame frame = {REPLICATION_MAGIC, (uint8_t)type, 0, count, lsn, length, sentAt};
+    return writeFull(fd, &frame, sizeof frame) && (length == 0 || writeFull(fd, data, length));
+}
+
+void ReplicationFeed::deliver(const char* data, size_t length, uint64_t lastLsn) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (overflowed) return;
+    if (pending.size() + length > REPLICATION_MAX_PENDING) {
+        overflowed = true;
+        std::vector<char>().swap(pending);
+    } else {
+        if (pending.empty()) pendingSince = wallClock();
+        pending.insert(pending.end(), data, data + length);
+        pendingLsn = lastLsn;
+    }
+    ready.notify_one();
+}
+
+bool ReplicationFeed::take(std::vector<char>& groups, uint64_t& lastLsn, uint64_t& since, int timeoutMs) {
+    std::unique_lock<std::mutex> lock(mutex);
+    groups.clear();
+    ready.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] { return !pending.empty() || overflowed; });
+    if (overflowed) return false;
+    groups.swap(pending);
+    lastLsn = pendingLsn;
+    since = pendingSince;
+    return true;
+}
+
+size_t ReplicationFeed::pendingBytes() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.size();
+}
+
+static std::string peerName(int fd) {
+    struct sockaddr_storage address;
+    socklen_t length = sizeof address;
+    char host[INET6_ADDRSTRLEN] = "?";
+    if (getpeername(fd, (struct sockaddr*)&address, &length) != 0) return host;
+    int port = 0;
+    if (address.ss_family == AF_INET) {
+        inet_ntop(AF_INET, &((struct sockaddr_in*)&address)->sin_addr, host, sizeof host);
+        port = ntohs(((struct sockaddr_in*)&address)->sin_port);
+    } else {
+        inet_ntop(AF_INET6, &((struct sockaddr_in6*)&address)->sin6_addr, host, sizeof host);
+        port = ntohs(((struct sockaddr_in6*)&address)->sin6_port);
+    }
+    return std::string(host) + ":" + std::to_string(port);
+}
+
+// Reads the acknowledgements that arrived, without blocking; false once the follower is gone
+static bool drainAcks(int fd, ReplicationFeed& feed) {
+    ReplicationFrame ack;
+    while (true) {
+        ssize_t received = recv(fd, &ack, sizeof ack, MSG_DONTWAIT | MSG_PEEK);
+        if (received == 0) return false;
+        if (received < (ssize_t)sizeof ack) return received > 0 || errno == EAGAIN || errno == EWOULDBLOCK;
+        if (!readFull(fd, &ack, sizeof ack) || ack.magic != REPLICATION_MAGIC || ack.type != REPL_ACK) return false;
+        feed.ackedLsn = ack.lsn;
+    }
+}
+
+void ReplicationSource::serve(int fd, const char* received, size_t length, WriteAheadLog* log,
+                              GraphRegistry& registry) {
+    ReplicationFrame request;
+    memcpy(&request, received, std::min(length, sizeof request));
+    if (log == nullptr || (length < sizeof request &&
+                           !readFull(fd, (char*)&request + length, sizeof request - length)) ||
+        request.type != REPL_SUBSCRIBE) {
+        std::cout << "Refused a follower: " << (log == nullptr ? "this server keeps no log (-L)" : "bad request")
+                  << std::endl;
+        close(fd);
+        return;
+    }
+
+    std::shared_ptr<ReplicationFeed> feed = std::make_shared<ReplicationFeed>();
+    feed->peer = peerName(fd);
+    uint64_t subscribedAt = log->subscribe(feed);
+    std::cout << "Follower " << feed->peer << " subscribed at version " << subscribedAt << std::endl;
+
+    // Graphs are copied one at a time, each under its own mutex, as for a checkpoint
+    bool open = true;
+    std::vector<double> coordinates;
+    std::vector<char> payload;
+    for (const std::shared_ptr<NamedGraph>& graph : registry.snapshot()) {
+        uint64_t lsn;
+        if (!open || !log->captureGraph(*graph, coordinates, lsn)) continue;
+        // A follower must not hold a change the leader could still lose
+        if (!log->waitDurable()) {
+            open = false;
+            break;
+        }
+        size_t nameBytes = padded(graph->name.size());
+        payload.assign(nameBytes + coordinates.size() * sizeof(double), 0);
+        memcpy(payload.data(), graph->name.data(), graph->name.size());
+        if (!coordinates.empty())
+            memcpy(payload.data() + nameBytes, coordinates.data(), coordinates.size() * sizeof(double));
+        open = sendFrame(fd, REPL_GRAPH, lsn, wallClock(), payload.data(), payload.size(), (uint32_t)graph->name.size());
+    }
+    open = open && sendFrame(fd, REPL_SNAPSHOT_END, subscribedAt, wallClock());
+    feed->sentLsn = subscribedAt;
+
+    std::vector<char> groups;
+    while (open) {
+        uint64_t lastLsn, since;
+        if (!feed->take(groups, lastLsn, since, REPLICATION_HEARTBEAT_MS)) {
+            std::cout << "Follower " << feed->peer << " fell too far behind" << std::endl;
+            break;
+        }
+        if (groups.empty()) {
+            open = sendFrame(fd, REPL_HEARTBEAT, log->durableVersion(), wallClock());
+        } else {
+            open = sendFrame(fd, REPL_RECORDS, lastLsn, since, groups.data(), groups.size());
+            feed->sentLsn = lastLsn;
+        }
+        open = open && drainAcks(fd, *feed);
+    }
+
+    log->unsubscribe(feed);
+    std::cout << "Follower " << feed->peer << " disconnected" << std::endl;
+    close(fd);
+}
+
+void ReplicationSource::report(WriteAheadLog* log, ResponseBuffer& response) {
+    if (log == nullptr) {
+        response.append("Replication: off (the leader needs -L)");
+        return;
+    }
+    uint64_t version = log->durableVersion();
+    std::vector<std::shared_ptr<ReplicationFeed>> followers = log->followers();
+    response.append("Replication: leader at version ");
+    response.appendUnsigned(version);
+    response.append(", ");
+    response.appendUnsigned(followers.size());
+    response.append(followers.size() == 1 ? " follower" : " followers");
+    for (const std::shared_ptr<ReplicationFeed>& feed : followers) {
+        uint64_t acked = feed->ackedLsn;
+        response.append('\n');
+        response.append(feed->peer.c_str());
+        response.append(": sent ");
+        response.appendUnsigned(feed->sentLsn);
+        response.append(", applied ");
+        response.appendUnsigned(acked);
+        response.append(", ");
+        response.appendUnsigned(version > acked ? version - acked : 0);
+        response.append(" records behind, ");
+        response.appendUnsigned(feed->pendingBytes());
+        response.append(" bytes queued");
+    }
+}
+
+ReplicaClient::ReplicaClient(GraphRegistry& registry, const char* leader) : registry(registry) {
+    std::string spec(leader);
+    size_t colon = spec.rfind(':');
+    host = colon == std::string::npos ? "localhost" : spec.substr(0, colon);
+    port = colon == std::string::npos ? spec : spec.substr(colon + 1);
+}
+
+int ReplicaClient::connectToLeader() {
+    struct addrinfo hints, *result;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0) return -1;
+
+    int fd = -1;
+    for (struct addrinfo* current = result; current != nullptr && fd < 0; current = current->ai_next) {
+        fd = socket(current->ai_family, current->ai_socktype | SOCK_CLOEXEC, current->ai_protocol);
+        if (fd >= 0 && connect(fd, current->ai_addr, current->ai_addrlen) < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(result);
+
+    // The leader greets every connection with the text prompt first
+    char greeting[3];
+    if (fd >= 0 && (!readFull(fd, greeting, sizeof greeting) || memcmp(greeting, ">> ", 3) != 0)) {
+        close(fd);
+        fd = -1;
+    }
+    if (fd >= 0) {
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+    }
+    return fd;
+}
+
+/**
+ * @brief One subscription: the copy of the graphs, then the stream, until the link fails.
+ * Graphs the copy does not include are dropped, since the leader has no stored graph by
+ * that name; they may be left over from an earlier subscription.
+ */
+bool ReplicaClient::follow(int fd) {
+    if (!sendFrame(fd, REPL_SUBSCRIBE, 0, wallClock())) return false;
+
+    std::unordered_map<std::string, uint64_t> capturedAt;
+    std::vector<char> payload;
+    uint64_t lastLsn = 0;
+    ReplicationFrame frame;
+    while (readFull(fd, &frame, sizeof frame)) {
+        if (frame.magic != REPLICATION_MAGIC || frame.length > REPLICATION_MAX_FRAME) return false;
+        payload.resize(frame.length);
+        if (frame.length > 0 && !readFull(fd, payload.data(), frame.length)) return false;
+
+        if (frame.type == REPL_GRAPH) {
+            size_t nameBytes = padded(frame.count);
+            if (frame.count == 0 || frame.count > GRAPH_NAME_MAX || nameBytes > frame.length) return false;
+            std::string name(payload.data(), frame.count);
+            std::shared_ptr<NamedGraph> graph = registry.open(name);
+            std::lock_guard<std::mutex> lock(graph->mutex);
+            graph->engine->resetPoints();
+            graph->engine->applyPoints(false, reinterpret_cast<const double*>(payload.data() + nameBytes),
+                                       (frame.length - nameBytes) / (2 * sizeof(double)));
+            capturedAt[name] = frame.lsn;
+        } else if (frame.type == REPL_SNAPSHOT_END) {
+            for (const std::shared_ptr<NamedGraph>& graph : registry.snapshot())
+                if (capturedAt.count(graph->name) == 0) registry.drop(graph->name);
+            lastLsn = frame.lsn;
+            std::lock_guard<std::mutex> lock(mutex);
+            appliedLsn = frame.lsn;
+            leaderLsn = std::max(leaderLsn, frame.lsn);
+            streaming = true;
+            advanced.notify_all();
+        } else if (frame.type == REPL_RECORDS) {
+            size_t records = 0;
+            size_t applied = WriteAheadLog::applyRecords(payload.data(), payload.size(), registry, 0, capturedAt,
+                                                         lastLsn, records, true);
+            if (applied != payload.size() || lastLsn != frame.lsn) {
+                std::cout << "Replication stream damaged at version " << lastLsn << std::endl;
+                return false;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                appliedLsn = lastLsn;
+                leaderLsn = std::max(leaderLsn, lastLsn);
+                recordsApplied += records;
+                lastDelay = wallClock() - std::min(frame.sentAt, wallClock());
+                advanced.notify_all();
+            }
+            if (!sendFrame(fd, REPL_ACK, lastLsn, 0)) return false;
+        } else if (frame.type == REPL_HEARTBEAT) {
+            std::lock_guard<std::mutex> lock(mutex);
+            leaderLsn = std::max(leaderLsn, frame.lsn);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ReplicaClient::run() {
+    while (true) {
+        int fd = connectToLeader();
+        if (fd >= 0) {
+            std::cout << "Following " << host << ":" << port << std::endl;
+            follow(fd);
+            close(fd);
+            std::cout << "Lost the leader at version " << version() << ", reconnecting" << std::endl;
+            std::lock_guard<std::mutex> lock(mutex);
+            streaming = false;
+            resyncs++;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(REPLICATION_RETRY_MS));
+    }
+}
+
+void ReplicaClient::start() {
+    std::thread(&ReplicaClient::run, this).detach();
+}
+
+uint64_t ReplicaClient::version() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return appliedLsn;
+}
+
+bool ReplicaClient::waitFor(uint64_t target, uint64_t timeoutMs) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return advanced.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] { return appliedLsn >= target; });
+}
+
+void ReplicaClient::report(ResponseBuffer& response) {
+    std::lock_guard<std::mutex> lock(mutex);
+    response.append("Replication: follower of ");
+    response.append(host.c_str());
+    response.append(':');
+    response.append(port.c_str());
+    response.append(streaming ? ", streaming" : ", disconnected");
+    response.append("\nversion ");
+    response.appendUnsigned(appliedLsn);
+    response.append(", leader at ");
+    response.appendUnsigned(leaderLsn);
+    response.append(", ");
+    response.appendUnsigned(leaderLsn - appliedLsn);
+    response.append(" records behind\nlast group applied ");
+    response.appendNumber(lastDelay / 1e3);
+    response.append(" us after the leader made it durable\n");
+    response.appendUnsigned(recordsApplied);
+    response.append(" records applied, ");
+    response.appendUnsigned(resyncs);
+    response.append(" reconnects");
+}
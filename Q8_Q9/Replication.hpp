@@ -0,0 +1,156 @@
+#ifndef REPLICATION_HPP
+#define REPLICATION_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "GraphRegistry.hpp"
+#include "Protocol.hpp"
+#include "WriteAheadLog.hpp"
+
+#define REPLICATION_MAGIC 0xC6                // First byte of every frame; no text command starts with it
+#define REPLICATION_MAX_PENDING (256 << 20)   // A follower this far behind is cut off, and starts over
+#define REPLICATION_MAX_FRAME (1ULL << 36)    // Larger frames are taken for a damaged stream
+#define REPLICATION_HEARTBEAT_MS 100          // A leader with nothing to send says so this often
+#define REPLICATION_RETRY_MS 500              // How long a follower waits before reconnecting
+
+/**
+ * @brief Frames of the replication stream between a leader and a follower.
+ */
+enum ReplicationFrameType {
+    REPL_SUBSCRIBE = 1, // Follower to leader: start streaming
+    REPL_GRAPH,         // A stored graph as of lsn: its name (count bytes, padded to 8) and (x, y) doubles
+    REPL_SNAPSHOT_END,  // Every graph has been sent; records follow on from lsn
+    REPL_RECORDS,       // A group of log records, lsn being the last one's
+    REPL_HEARTBEAT,     // Nothing new; lsn is the leader's durable version
+    REPL_ACK            // Follower to leader: records up to lsn are applied
+};
+
+/**
+ * @brief Header of a replication frame, followed by length bytes. Host byte order, as the ShardLink.
+ */
+struct ReplicationFrame {
+    uint8_t magic;
+    uint8_t type;
+    uint16_t reserved;
+    uint32_t count;
+    uint64_t lsn;
+    uint64_t length;
+    uint64_t sentAt;   // Leader's wall clock in ns when the group became durable
+};
+static_assert(sizeof(ReplicationFrame) == 32, "ReplicationFrame must not be padded");
+
+/**
+ * @brief The groups of log records waiting to be sent to one follower.
+ *
+ * The log's flusher delivers each group once it is durable; the follower's
+ * connection thread takes whatever has piled up and sends it in one frame.
+ */
+class ReplicationFeed {
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<char> pending;
+    uint64_t pendingLsn = 0;
+    uint64_t pendingSince = 0;   // Wall clock of the oldest group pending
+    bool overflowed = false;
+
+public:
+    std::string peer;
+    std::atomic<uint64_t> sentLsn{0};
+    std::atomic<uint64_t> ackedLsn{0};
+
+    void deliver(const char* data, size_t length, uint64_t lastLsn);
+
+    /**
+     * @brief Waits up to @p timeoutMs for groups and moves them into @p groups (left empty on timeout).
+     * @return False once the follower fell more than REPLICATION_MAX_PENDING behind.
+     */
+    bool take(std::vector<char>& groups, uint64_t& lastLsn, uint64_t& since, int timeoutMs);
+
+    size_t pendingBytes();
+};
+
+/**
+ * @brief Leader side: streams the graphs, then every durable change, to a follower.
+ */
+class ReplicationSource {
+public:
+    /**
+     * @brief Serves one follower on @p fd until it disconnects, then closes it.
+     *
+     * The follower is subscribed to @p log first and sent a copy of every stored graph
+     * second, so each change lands either in a graph's copy or in the stream after it;
+     * the follower skips records its copy already holds.
+     *
+     * @param received Bytes already read from the connection, starting with the subscribe frame.
+     * @param log The leader's log; without one the connection is refused.
+     */
+    static void serve(int fd, const char* received, size_t length, WriteAheadLog* log, GraphRegistry& registry);
+
+    /**
+     * @brief Handles "Replication" on the leader: every follower and how far behind it is.
+     */
+    static void report(WriteAheadLog* log, ResponseBuffer& response);
+};
+
+/**
+ * @brief Follower side: keeps a registry in step with a leader's, for read-only clients.
+ *
+ * A background thread subscribes to the leader and applies what it streams, each record
+ * under its graph's mutex. If the link drops it reconnects and starts over from a fresh
+ * copy of the graphs. Versions are the leader's log sequence numbers.
+ */
+class ReplicaClient {
+private:
+    GraphRegistry& registry;
+    std::string host;
+    std::string port;
+
+    std::mutex mutex;
+    std::condition_variable advanced;
+    uint64_t appliedLsn = 0;
+    uint64_t leaderLsn = 0;
+    uint64_t lastDelay = 0;        // ns from the leader making a group durable to it being applied here
+    uint64_t recordsApplied = 0;
+    uint64_t resyncs = 0;
+    bool streaming = false;
+
+    int connectToLeader();
+    bool follow(int fd);
+    void run();
+
+public:
+    /**
+     * @param leader "host:port", or a port on localhost.
+     */
+    ReplicaClient(GraphRegistry& registry, const char* leader);
+
+    ReplicaClient(const ReplicaClient&) = delete;
+    ReplicaClient& operator=(const ReplicaClient&) = delete;
+
+    void start();
+
+    /**
+     * @brief The leader version every graph here reflects.
+     */
+    uint64_t version();
+
+    /**
+     * @brief Blocks until version() reaches @p target or @p timeoutMs passes.
+     * @return False on timeout.
+     */
+    bool waitFor(uint64_t target, uint64_t timeoutMs);
+
+    /**
+     * @brief Handles "Replication" on a follower: its version, the leader's, and the lag.
+     */
+    void report(ResponseBuffer& response);
+};
+
+#endif // REPLICATION_HPP
@@ -1,118 +1,158 @@
-#include "ConvexHull.hpp"
+#include "Acceptor.hpp"
 #include "AsyncHandler.hpp"
+#include "CommandQueue.hpp"
+#include "GraphEngine.hpp"
+#include "GraphRegistry.hpp"
+#include "LocalRing.hpp"
+#include "PointIngest.hpp"
+#include "Protocol.hpp"
+#include "Replication.hpp"
+#include "ShardLink.hpp"
+#include "Stats.hpp"
+#include "WriteAheadLog.hpp"
 #include <iostream>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <signal.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netdb.h>
+#include <thread>
 
-#define SERVER_PORT "9034"
-#define MAX_EVENTS 10
-#define MSG_BUFFER_SIZE 50
+#define SERVER_PORT "9034" // Default; -p chooses another
+#define MSG_BUFFER_SIZE 1024 // Large enough to carry a batch of point lines
+#define LOG_FAILED_REPLY "Write-ahead log failed: changes are no longer made durable or accepted"
 
 using std::cout;
 using std::endl;
 using std::string;
 
-// Event-driven reactor for handling async operations
-AsyncReactor asyncReactor;
+// Proactor that accepts clients and runs each one on its own thread
+AsyncProactor asyncProactor;
 
-// Container for graph points
-std::vector<Point> graphPoints;
+// Local mode (-U): a second proactor for clients on this host, on a Unix socket at localPath
+AsyncProactor localProactor;
+const char* localPath = nullptr;
 
-// Tracks the number of points expected during graph creation
-size_t pendingPoints = 0;
+// The named graphs, each with its own lock; every connection starts on DEFAULT_GRAPH_NAME
+GraphRegistry* graphRegistry = nullptr;
 
-// File descriptor of the client creating the graph
-int graphCreatorFd = -1;
+// Coordinator mode (-S): clients' points live on other server processes, reached over ShardLinks
+ShardCoordinator* shardCoordinator = nullptr;
+
+// Actor mode (-A): client threads queue their commands for the one thread that owns the graphs
+CommandQueue* commandQueue = nullptr;
+
+// Durable mode (-L): changes to stored graphs are logged, and acknowledged once on disk
+WriteAheadLog* writeAheadLog = nullptr;
+
+// Follower mode (-F): the graphs are a read-only replica of a leader's
+ReplicaClient* replicaClient = nullptr;
+
+// UDP ingest (-u): point batches that senders fire and forget
+PointIngest* pointIngest = nullptr;
+
+/**
+ * @brief Whether a command changes a graph, which a follower leaves to its leader.
+ */
+static bool isWriteCommand(const char* messageBuffer) {
+    return strncmp(messageBuffer, "Create", 6) == 0 || strncmp(messageBuffer, "AddPoint", 8) == 0 ||
+           strncmp(messageBuffer, "RemovePoint", 11) == 0 || strncmp(messageBuffer, "GenerateRandom", 14) == 0 ||
+           strncmp(messageBuffer, "DropGraph", 9) == 0;
+}
+
+/**
+ * @brief Handles "Version", "WaitVersion <version> [timeout_ms]" and "Replication".
+ *
+ * A leader's version is its latest durable log record, which every acknowledged change is
+ * in; a follower's is the latest leader record it applied. A client that wants to read its
+ * own writes on a follower asks the leader for its version after writing, then sends
+ * WaitVersion with it to the follower before reading.
+ *
+ * @return True if the command was answered here.
+ */
+static bool handleReplication(const char* messageBuffer, ssize_t receivedBytes, ResponseBuffer& response,
+                              CommandVerb& verb) {
+    if (strncmp(messageBuffer, "Replication", 11) == 0) {
+        verb = VERB_REPLICATION;
+        if (replicaClient != nullptr) replicaClient->report(response);
+        else ReplicationSource::report(writeAheadLog, response);
+        return true;
+    }
+    bool wait = strncmp(messageBuffer, "WaitVersion", 11) == 0;
+    if (!wait && strncmp(messageBuffer, "Version", 7) != 0) return false;
+
+    verb = wait ? VERB_WAIT_VERSION : VERB_VERSION;
+    uint64_t target = 0, timeoutMs = 1000;
+    if (wait) {
+        const char* cursor = messageBuffer + 11;
+        const char* end = messageBuffer + receivedBytes;
+        const char* word;
+        size_t length;
+        bool valid = TextProtocol::nextWord(cursor, end, word, length) &&
+                     std::from_chars(word, word + length, target).ptr == word + length;
+        if (valid && TextProtocol::nextWord(cursor, end, word, length))
+            valid = std::from_chars(word, word + length, timeoutMs).ptr == word + length;
+        if (!valid) {
+            response.append("Usage: WaitVersion <version> [timeout_ms]");
+            return true;
+        }
+    }
+
+    uint64_t version = 0;
+    bool reached = true;
+    if (replicaClient != nullptr) {
+        reached = !wait || replicaClient->waitFor(target, timeoutMs);
+        version = replicaClient->version();
+    } else if (writeAheadLog != nullptr) {
+        version = writeAheadLog->durableVersion();
+        reached = version >= target;
+    }
+    response.append(reached ? "Version: " : "Timed out at version ");
+    response.appendUnsigned(version);
+    return true;
+}
+
+/**
+ * @brief Whether a command of @p verb may have changed a graph, so its reply waits for the log.
+ */
+static bool changesGraphs(CommandVerb verb) {
+    switch (verb) {
+    case VERB_CREATE_GRAPH:
+    case VERB_GRAPH_POINTS:
+    case VERB_ADD_POINT:
+    case VERB_REMOVE_POINT:
+    case VERB_GENERATE_RANDOM:
+    case VERB_CREATE_STREAM_GRAPH:
+    case VERB_CREATE_WINDOW_GRAPH:
+    case VERB_CREATE_SHARDED_GRAPH:
+    case VERB_DROP_GRAPH:
+        return true;
+    default:
+        return false;
+    }
+}
 
 /**
  * @brief Signal handler for SIGINT to gracefully shut down the server.
  */
 void signalHandler(int signal) {
     cout << "\nReceived SIGINT (" << signal << "), shutting down server..." << endl;
-    asyncReactor.stop();
-}
-
-/**
- * @brief Processes client commands and manages graph operations.
- * @param inputLine The command received from the client.
- * @param clientFd The file descriptor of the client sending the command.
- * @return A response string for the client.
- */
-string handleClientCommand(char* inputLine, int clientFd) {
-    if (pendingPoints > 0) {
-        if (graphCreatorFd != clientFd)
-            return "Another client is creating a graph";
-
-        float x, y;
-        if (sscanf(inputLine, "%f,%f", &x, &y) != 2)
-            return "Invalid coordinates format while waiting for points";
-        graphPoints.emplace_back(x, y);
-        pendingPoints--;
-        if (pendingPoints == 0) {
-            graphCreatorFd = -1;
-            return "Graph creation complete";
-        }
-        return "Point added";
-    }
-
-    if (strncmp(inputLine, "CreateGraph", 11) == 0) {
-        size_t pointCount;
-        if (sscanf(inputLine, "CreateGraph %zu", &pointCount) != 1)
-            return "Invalid CreateGraph command format";
-        if (pointCount == 0)
-            return "Graph must have at least one point";
-
-        graphPoints.clear();
-        graphPoints.reserve(pointCount);
-        graphCreatorFd = clientFd;
-        pendingPoints = pointCount;
-        return "Expecting points for new graph";
-    } else if (strncmp(inputLine, "CH", 2) == 0) {
-        float hullArea = 0;
-        if (graphPoints.size() > 2)
-            hullArea = ConvexHullUtility::computeHullArea(graphPoints);
-        return "Convex hull area: " + std::to_string(hullArea);
-    } else if (strncmp(inputLine, "AddPoint", 8) == 0) {
-        float x, y;
-        if (sscanf(inputLine, "AddPoint %f,%f", &x, &y) != 2)
-            return "Invalid coordinates format";
-        graphPoints.emplace_back(x, y);
-        return "Point added";
-    } else if (strncmp(inputLine, "RemovePoint", 11) == 0) {
-        float x, y;
-        if (sscanf(inputLine, "RemovePoint %f,%f", &x, &y) != 2)
-            return "Invalid coordinates format";
-
-        for (unsigned int i = 0; i < graphPoints.size(); i++) {
-            if (graphPoints[i].getX() == x && graphPoints[i].getY() == y) {
-                graphPoints[i] = graphPoints.back();
-                graphPoints.pop_back();
-                break;
-            }
-        }
-        return "Point removed";
-    } else if (strncmp(inputLine, "GenerateRandom", 14) == 0) {
-        graphPoints.clear();
-        graphPoints.reserve(10000000);
-        for (size_t i = 0; i < 10000000; i++) {
-            graphPoints.emplace_back((float)rand() / RAND_MAX, (float)rand() / RAND_MAX);
-        }
-        return "Random points generated";
+    if (localPath != nullptr) {
+        localProactor.shutdown();
+        unlink(localPath);
     }
-
-    return "Unknown command";
+    asyncProactor.shutdown();
 }
 
 /**
- * @brief Creates a listening socket for the server.
+ * @brief Creates the server socket on @p port and starts @p acceptor listening on it.
  * @return The file descriptor of the listening socket, or -1 on error.
  */
-int createServerSocket(void) {
+int createServerSocket(Acceptor& acceptor, const char* port) {
     int serverSocket;
     int optval = 1;
     int status;
@@ -124,7 +164,7 @@ int createServerSocket(void) {
     hints.ai_socktype = SOCK_STREAM;
     hints.ai_flags = AI_PASSIVE;
 
-    if ((status = getaddrinfo(NULL, SERVER_PORT, &hints, &serverInfo)) != 0) {
+    if ((status = getaddrinfo(NULL, port, &hints, &serverInfo)) != 0) {
         fprintf(stderr, "Server error: %s\n", gai_strerror(status));
         exit(1);
     }
@@ -151,33 +191,452 @@ int createServerSocket(void) {
         return -1;
     }
 
-    if (listen(serverSocket, MAX_EVENTS) == -1) {
+    if (!acceptor.listen(serverSocket)) {
         return -1;
     }
 
     return serverSocket;
 }
 
+/**
+ * @brief Creates a Unix socket at @p path, replacing a stale one, and starts @p acceptor listening on it.
+ * @return The file descriptor of the listening socket, or -1 on error.
+ */
+int createLocalSocket(Acceptor& acceptor, const char* path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof address);
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof address.sun_path) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+
+    int localSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (localSocket < 0) return -1;
+    unlink(path);
+    if (bind(localSocket, (struct sockaddr*)&address, sizeof address) < 0 || !acceptor.listen(localSocket)) {
+        close(localSocket);
+        return -1;
+    }
+    return localSocket;
+}
+
+/**
+ * @brief Reads the graph name that follows a command word, on the same line.
+ * @return True if a word is there; it is stored in @p name and @p nameEnd points past it.
+ */
+static bool graphNameAfter(const char* messageBuffer, size_t prefixLength, ssize_t receivedBytes,
+                           string& name, const char*& nameEnd) {
+    const char* end = messageBuffer + receivedBytes;
+    const char* word = messageBuffer + prefixLength;
+    while (word != end && (*word == ' ' || *word == '\t')) ++word;
+    nameEnd = word;
+    while (nameEnd != end && *nameEnd != ' ' && *nameEnd != '\t' && *nameEnd != '\n' && *nameEnd != '\r') ++nameEnd;
+    name.assign(word, nameEnd - word);
+    return !name.empty();
+}
+
+/**
+ * @brief The graph a client switches to. A follower only has the leader's graphs, and
+ * clients create at most GRAPH_MAX_COUNT.
+ * @return nullptr, with the reason in @p response, if the graph cannot be had.
+ */
+static std::shared_ptr<NamedGraph> openForClient(const string& name, ResponseBuffer& response) {
+    std::shared_ptr<NamedGraph> graph =
+        replicaClient != nullptr ? graphRegistry->find(name) : graphRegistry->open(name, GRAPH_MAX_COUNT);
+    if (graph == nullptr && replicaClient != nullptr) {
+        response.append("No such graph on the leader");
+    } else if (graph == nullptr) {
+        response.append("Too many graphs: at most ");
+        response.appendUnsigned(GRAPH_MAX_COUNT);
+    }
+    return graph;
+}
+
+/**
+ * @brief Handles the commands that act on the namespace rather than on one graph:
+ * "Use <name>", "DropGraph <name>", "Graphs" and "CHAll".
+ *
+ * "CreateGraph <name> N", "CreateStreamGraph <name>", "CreateWindowGraph <name> ..." and
+ * "CreateShardedGraph <name> ..." switch the connection to that graph, then cut the name
+ * out of @p messageBuffer so the engine sees the usual command.
+ *
+ * @return True if the command was answered here.
+ */
+static bool handleGraphNamespace(char* messageBuffer, ssize_t& receivedBytes, std::shared_ptr<NamedGraph>& graph,
+                                 ResponseBuffer& response, CommandVerb& verb) {
+    string name;
+    const char* nameEnd;
+
+    if (strncmp(messageBuffer, "CHAll", 5) == 0) {
+        graphRegistry->hullAreas(response);
+        verb = VERB_CH_ALL;
+        return true;
+    }
+    if (strncmp(messageBuffer, "Graphs", 6) == 0) {
+        std::vector<std::shared_ptr<NamedGraph>> graphs = graphRegistry->snapshot();
+        response.append("Graphs:");
+        for (const std::shared_ptr<NamedGraph>& named : graphs) {
+            response.append(' ');
+            response.append(named->name.data(), named->name.size());
+        }
+        verb = VERB_LIST_GRAPHS;
+        return true;
+    }
+    if (strncmp(messageBuffer, "Use", 3) == 0) {
+        verb = VERB_USE;
+        if (!graphNameAfter(messageBuffer, 3, receivedBytes, name, nameEnd) ||
+            !GraphRegistry::validName(name.data(), name.size())) {
+            response.append("Invalid graph name");
+        } else if (std::shared_ptr<NamedGraph> named = openForClient(name, response)) {
+            graph = named;
+            response.append("Using graph ");
+            response.append(name.data(), name.size());
+        }
+        return true;
+    }
+    if (strncmp(messageBuffer, "DropGraph", 9) == 0) {
+        verb = VERB_DROP_GRAPH;
+        if (!graphNameAfter(messageBuffer, 9, receivedBytes, name, nameEnd)) {
+            response.append("Invalid graph name");
+        } else {
+            response.append(graphRegistry->drop(name) ? "Graph dropped" : "No such graph");
+        }
+        return true;
+    }
+
+    size_t prefixLength = 0;
+    if (strncmp(messageBuffer, "CreateGraph", 11) == 0) {
+        prefixLength = 11;
+    } else if (strncmp(messageBuffer, "CreateStreamGraph", 17) == 0 || strncmp(messageBuffer, "CreateWindowGraph", 17) == 0) {
+        prefixLength = 17;
+    } else if (strncmp(messageBuffer, "CreateShardedGraph", 18) == 0) {
+        prefixLength = 18;
+    }
+    // A leading digit or sign is the engine's own argument, not a name
+    if (prefixLength > 0 && graphNameAfter(messageBuffer, prefixLength, receivedBytes, name, nameEnd) &&
+        !isdigit((unsigned char)name[0]) && name[0] != '-' && name[0] != '+') {
+        if (!GraphRegistry::validName(name.data(), name.size())) {
+            verb = VERB_UNKNOWN;
+            response.append("Invalid graph name");
+            return true;
+        }
+        std::shared_ptr<NamedGraph> named = openForClient(name, response);
+        if (named == nullptr) {
+            verb = VERB_UNKNOWN;
+            return true;
+        }
+        graph = named;
+        char* tail = messageBuffer + prefixLength;
+        size_t removed = nameEnd - tail;
+        memmove(tail, nameEnd, messageBuffer + receivedBytes - nameEnd + 1); // Keeps the '\0'
+        receivedBytes -= removed;
+    }
+    return false;
+}
+
+/**
+ * @brief Runs one text command of a client on its current graph, however the command arrived.
+ *
+ * Commands run under the mutex of the connection's current graph, so clients on
+ * different graphs do not wait for each other. When graphs are logged, a change is
+ * only answered once it is durable.
+ *
+ * @param messageBuffer The command (NUL terminated); namespace commands may shorten it in place.
+ * @param receivedBytes Number of bytes in the command.
+ * @param graph The connection's current graph, which Use and named Create commands switch.
+ * @param queuedCommand The connection's node in the command queue of actor mode.
+ * @return The verb the command was accounted under.
+ */
+static CommandVerb executeCommand(char* messageBuffer, ssize_t receivedBytes, int clientFd,
+                                  std::shared_ptr<NamedGraph>& graph, QueuedCommand& queuedCommand,
+                                  ResponseBuffer& response) {
+    ssize_t commandBytes = receivedBytes;
+    CommandVerb verb;
+    if (replicaClient != nullptr && isWriteCommand(messageBuffer)) {
+        verb = VERB_UNKNOWN;
+        response.append("Read-only follower: send changes to the leader");
+    } else if (writeAheadLog != nullptr && isWriteCommand(messageBuffer) && writeAheadLog->hasFailed()) {
+        verb = VERB_UNKNOWN;
+        response.append(LOG_FAILED_REPLY);
+    } else if (strncmp(messageBuffer, "Ingest", 6) == 0) {
+        verb = VERB_INGEST;
+        if (pointIngest != nullptr) pointIngest->report(response);
+        else response.append("Ingest: off (start the server with -u)");
+    } else if (handleReplication(messageBuffer, commandBytes, response, verb) ||
+               handleGraphNamespace(messageBuffer, commandBytes, graph, response, verb)) {
+        // Answered without touching a graph's points
+    } else if (strncmp(messageBuffer, "GenerateRandom", 14) == 0) {
+        verb = graph->engine->generateRandom(messageBuffer, commandBytes, graph->mutex, response);
+    } else if (strncmp(messageBuffer, "CHFile", 6) == 0) {
+        verb = graph->engine->hullOfFile(messageBuffer, commandBytes, response);
+    } else if (strncmp(messageBuffer, "CHBatch", 7) == 0) {
+        verb = graph->engine->hullsOfGroups(messageBuffer, commandBytes, response);
+    } else if (commandQueue != nullptr) {
+        queuedCommand.input = messageBuffer;
+        queuedCommand.length = commandBytes;
+        queuedCommand.clientFd = clientFd;
+        queuedCommand.context = graph.get();
+        queuedCommand.response = &response;
+        commandQueue->submit(queuedCommand);
+        verb = (CommandVerb)queuedCommand.result;
+    } else {
+        std::lock_guard<std::mutex> lock(graph->mutex);
+        verb = graph->engine->execute(messageBuffer, commandBytes, clientFd, response);
+    }
+    if (writeAheadLog != nullptr && changesGraphs(verb) && !writeAheadLog->waitDurable()) {
+        response.clear();
+        response.append(LOG_FAILED_REPLY);
+    }
+    return verb;
+}
+
+/**
+ * @brief Adds the (x, y) doubles of a LOCAL_POINTS message to the current graph, read where they lie in the ring.
+ */
+static CommandVerb addLocalPoints(const char* payload, size_t length, std::shared_ptr<NamedGraph>& graph,
+                                  ResponseBuffer& response) {
+    size_t count = length / (2 * sizeof(double)), applied;
+    if (replicaClient != nullptr) {
+        response.append("Read-only follower: send changes to the leader");
+        return VERB_UNKNOWN;
+    }
+    if (length % (2 * sizeof(double)) != 0) {
+        response.append("Invalid coordinates format while waiting for points");
+        return VERB_GRAPH_POINTS;
+    }
+    if (writeAheadLog != nullptr && writeAheadLog->hasFailed()) {
+        response.append(LOG_FAILED_REPLY);
+        return VERB_GRAPH_POINTS;
+    }
+    {
+        std::lock_guard<std::mutex> lock(graph->mutex);
+        applied = graph->engine->applyPoints(false, reinterpret_cast<const double*>(payload), count);
+    }
+    if (writeAheadLog != nullptr && !writeAheadLog->waitDurable()) {
+        response.append(LOG_FAILED_REPLY);
+        return VERB_GRAPH_POINTS;
+    }
+    response.append(applied < count ? "Coordinates out of range" : count == 1 ? "Point added" : "Points added");
+    return VERB_GRAPH_POINTS;
+}
+
+/**
+ * @brief Serves a client on this host that asked for a shared ring over its Unix socket.
+ *
+ * Commands are copied out of the ring, since the client shares it, and run through
+ * executeCommand as those read from a socket are. Point batches are applied where they
+ * lie; each coordinate is read once. Replies go into the other ring without the prompt.
+ */
+static void serveLocalRing(int clientFd, std::shared_ptr<NamedGraph>& graph, QueuedCommand& queuedCommand,
+                           ResponseBuffer& response) {
+    LocalRingServer ring;
+    if (!ring.open(clientFd)) {
+        perror("Local ring");
+        close(clientFd);
+        return;
+    }
+    std::cout << "Client " << clientFd << " is on a shared ring" << std::endl;
+
+    LocalMessage message;
+    char* payload;
+    std::vector<char> command; // Commands are parsed from a copy, since the client can still write to the ring
+    while ((payload = ring.requests.next(message)) != nullptr) {
+        uint64_t startTime = ServerStats::now();
+        response.clear();
+        CommandVerb verb;
+        if (message.type == LOCAL_COMMAND && message.length > 0) {
+            // A message is a whole line, so its '\0' becomes the line break
+            command.assign(payload, payload + message.length);
+            command.back() = '\n';
+            command.push_back('\0');
+            std::cout << "Message from client " << clientFd << ": " << command.data();
+            verb = executeCommand(command.data(), message.length, clientFd, graph, queuedCommand, response);
+        } else if (message.type == LOCAL_POINTS) {
+            verb = addLocalPoints(payload, message.length, graph, response);
+        } else {
+            verb = VERB_UNKNOWN;
+            response.append("Unknown command");
+        }
+        ring.requests.release();
+
+        char* reply = ring.replies.reserve(response.size());
+        if (reply == nullptr && errno == EMSGSIZE) {
+            response.clear();
+            response.append("Reply too long for the shared ring");
+            reply = ring.replies.reserve(response.size());
+        }
+        if (reply == nullptr) break;
+        memcpy(reply, response.data(), response.size());
+        ring.replies.commit(LOCAL_REPLY, response.size());
+        ServerStats::recordCommand(verb, ServerStats::now() - startTime, message.length, response.size());
+    }
+
+    std::cout << "Client " << clientFd << " disconnected." << std::endl;
+    close(clientFd);
+}
+
 /**
  * @brief Handles messages from clients and processes their commands.
+ *
+ * The proactor's shared mutex is not used. A connection that opens with a binary
+ * frame is a coordinator's ShardLink, a follower, or a local client asking for a ring;
+ * later reads are text, whatever byte they start with.
+ *
  * @param clientFd The file descriptor of the client socket.
- * @param mutex Mutex for synchronizing command handling.
  */
-void* processClientMessages(int clientFd, std::mutex &mutex) {
-    char messageBuffer[MSG_BUFFER_SIZE] = {0};
+void* processClientMessages(int clientFd, std::mutex& /* shared handler mutex */) {
+    char messageBuffer[MSG_BUFFER_SIZE];
+    ResponseBuffer response; // Reused for every reply on this connection
+    QueuedCommand queuedCommand; // This connection's node in the command queue
+    std::shared_ptr<NamedGraph> graph = graphRegistry->open(DEFAULT_GRAPH_NAME);
     ssize_t receivedBytes;
+    bool opening = true; // Only the first read may switch the connection to a binary protocol
 
     while ((receivedBytes = recv(clientFd, messageBuffer, MSG_BUFFER_SIZE - 1, 0)) > 0) {
+        unsigned char magic = opening ? (unsigned char)messageBuffer[0] : 0;
+        opening = false;
+        if (magic == LINK_MAGIC) {
+            std::cout << "Client " << clientFd << " is a shard link" << std::endl;
+            if (replicaClient != nullptr) {
+                std::cout << "Refused a shard link: this server is a follower" << std::endl;
+                close(clientFd);
+                return nullptr;
+            }
+            ShardLink::serve(clientFd, messageBuffer, receivedBytes, *graph->engine, graph->mutex, writeAheadLog);
+            return nullptr;
+        }
+        if (magic == REPLICATION_MAGIC) {
+            std::cout << "Client " << clientFd << " is a follower" << std::endl;
+            ReplicationSource::serve(clientFd, messageBuffer, receivedBytes, writeAheadLog, *graphRegistry);
+            return nullptr;
+        }
+        if (magic == LOCAL_MAGIC) {
+            serveLocalRing(clientFd, graph, queuedCommand, response);
+            return nullptr;
+        }
         messageBuffer[receivedBytes] = '\0';
         std::cout << "Message from client " << clientFd << ": " << messageBuffer;
 
-        std::string response;
-        mutex.lock();
-        response = handleClientCommand(messageBuffer, clientFd) + "\n>> ";
-        mutex.unlock();
+        uint64_t startTime = ServerStats::now();
+        response.clear();
+        CommandVerb verb = executeCommand(messageBuffer, receivedBytes, clientFd, graph, queuedCommand, response);
+        // A read of graph points that ends before finishing a line is answered with the next one
+        if (verb != VERB_GRAPH_POINTS || response.size() > 0) {
+            response.append("\n>> ");
+            send(clientFd, response.data(), response.size(), 0);
+        }
+        ServerStats::recordCommand(verb, ServerStats::now() - startTime, receivedBytes, response.size());
+    }
 
-        send(clientFd, response.c_str(), response.size(), 0);
-        memset(messageBuffer, 0, sizeof(messageBuffer));
+    if (receivedBytes == 0) {
+        std::cout << "Client " << clientFd << " disconnected." << std::endl;
+        close(clientFd);
+    } else {
+        perror("recv");
+    }
+    return nullptr;
+}
+
+// The command is exactly @p word, not a longer one that starts with it
+static bool isCommand(const char* messageBuffer, const char* word) {
+    size_t length = strlen(word);
+    char after = messageBuffer[length];
+    return strncmp(messageBuffer, word, length) == 0 &&
+           (after == '\0' || after == '\n' || after == '\r' || after == ' ');
+}
+
+/**
+ * @brief Handles a client of coordinator mode: graph creation and point updates are
+ * forwarded to the shards, hull commands are answered from the shards' hulls.
+ * @param clientFd The file descriptor of the client socket.
+ */
+void* processCoordinatorMessages(int clientFd, std::mutex& /* shared handler mutex */) {
+    char messageBuffer[MSG_BUFFER_SIZE];
+    ResponseBuffer response;
+    vector<DoublePoint> points;
+    size_t pendingPoints = 0; // Still expected after "CreateGraph N"
+    PointLineBuffer pointLines; // A point line cut off at the end of the last read
+    ssize_t receivedBytes;
+
+    while ((receivedBytes = recv(clientFd, messageBuffer, MSG_BUFFER_SIZE - 1, 0)) > 0) {
+        messageBuffer[receivedBytes] = '\0';
+        std::cout << "Message from client " << clientFd << ": " << messageBuffer;
+
+        uint64_t startTime = ServerStats::now();
+        response.clear();
+        CommandVerb verb;
+        size_t applied;
+        double x, y;
+        if (pendingPoints > 0) {
+            verb = VERB_GRAPH_POINTS;
+            size_t parsed;
+            const char *lines, *linesEnd;
+            pointLines.take(messageBuffer, receivedBytes, lines, linesEnd);
+            points.clear();
+            const char* rest = TextProtocol::parsePointLines(lines, linesEnd, points, pendingPoints, parsed);
+            if (lines == linesEnd) {
+                // No line finished yet: the reply waits for the read that finishes one
+            } else if (parsed == 0 || (rest != linesEnd && parsed < pendingPoints)) {
+                pointLines.clear();
+                response.append("Invalid coordinates format while waiting for points");
+            } else if (!shardCoordinator->apply(false, points.data(), parsed, applied)) {
+                pointLines.clear();
+                response.append("A shard is unavailable");
+            } else if (applied < parsed) {
+                pointLines.clear();
+                response.append("Coordinates out of range");
+            } else {
+                pendingPoints -= parsed;
+                if (pendingPoints == 0) pointLines.clear();
+                response.append(pendingPoints == 0 ? "Graph creation complete" : parsed == 1 ? "Point added" : "Points added");
+            }
+        } else if (strncmp(messageBuffer, "CreateGraph", 11) == 0) {
+            verb = VERB_CREATE_GRAPH;
+            if (!TextProtocol::parseCommandCount(messageBuffer, 11, pendingPoints) || pendingPoints == 0) {
+                pendingPoints = 0;
+                response.append("Invalid CreateGraph command format");
+            } else if (!shardCoordinator->reset()) {
+                pendingPoints = 0;
+                response.append("A shard is unavailable");
+            } else {
+                pointLines.clear();
+                response.append("Expecting points for new graph");
+            }
+        } else if (strncmp(messageBuffer, "AddPoint", 8) == 0 || strncmp(messageBuffer, "RemovePoint", 11) == 0) {
+            bool remove = messageBuffer[0] == 'R';
+            verb = remove ? VERB_REMOVE_POINT : VERB_ADD_POINT;
+            if (!TextProtocol::parseCommandPoint(messageBuffer, remove ? 11 : 8, x, y)) {
+                response.append("Invalid coordinates format");
+            } else {
+                DoublePoint point(x, y);
+                if (!shardCoordinator->apply(remove, &point, 1, applied)) response.append("A shard is unavailable");
+                else if (applied == 0 && !remove) response.append("Coordinates out of range");
+                else response.append(remove ? "Point removed" : "Point added");
+            }
+        } else if (strncmp(messageBuffer, "Stats", 5) == 0) {
+            verb = VERB_STATS;
+            ServerStats::report(response);
+        } else if (strncmp(messageBuffer, "CHFile", 6) == 0 || strncmp(messageBuffer, "CHBatch", 7) == 0) {
+            verb = shardCoordinator->computeLocally(messageBuffer, receivedBytes, response);
+        } else if (strncmp(messageBuffer, "CHAll", 5) == 0) {
+            verb = VERB_CH_ALL;
+            response.append("A coordinator has a single graph: use CH");
+        } else if (isCommand(messageBuffer, "CH") || strncmp(messageBuffer, "Contains", 8) == 0 ||
+                   strncmp(messageBuffer, "Extreme", 7) == 0 || strncmp(messageBuffer, "Tangents", 8) == 0 ||
+                   strncmp(messageBuffer, "Diameter", 8) == 0 || strncmp(messageBuffer, "Width", 5) == 0 ||
+                   strncmp(messageBuffer, "MinRectangle", 12) == 0 || strncmp(messageBuffer, "Shape", 5) == 0) {
+            verb = shardCoordinator->query(messageBuffer, receivedBytes, clientFd, response);
+        } else {
+            verb = VERB_UNKNOWN;
+            response.append("Unknown command");
+        }
+        if (verb != VERB_GRAPH_POINTS || response.size() > 0) {
+            response.append("\n>> ");
+            send(clientFd, response.data(), response.size(), 0);
+        }
+        ServerStats::recordCommand(verb, ServerStats::now() - startTime, receivedBytes, response.size());
     }
 
     if (receivedBytes == 0) {
@@ -189,20 +648,201 @@ void* processClientMessages(int clientFd, std::mutex &mutex) {
     return nullptr;
 }
 
-int main() {
-    int serverSocket = createServerSocket();
+/**
+ * @brief The state owner of actor mode: executes queued commands a batch at a time.
+ *
+ * A graph's mutex is taken when the batch moves on to that graph and held across
+ * consecutive commands for it. Only GenerateRandom, which swaps in its points from a
+ * client thread, still contends for it.
+ */
+void ownGraphState() {
+    QueuedCommand* batch[COMMAND_BATCH_SIZE];
+    while (true) {
+        size_t count = commandQueue->popBatch(batch, COMMAND_BATCH_SIZE);
+        NamedGraph* locked = nullptr;
+        for (size_t i = 0; i < count; ++i) {
+            QueuedCommand& command = *batch[i];
+            NamedGraph* graph = static_cast<NamedGraph*>(command.context);
+            if (graph != locked) {
+                if (locked != nullptr) locked->mutex.unlock();
+                graph->mutex.lock();
+                locked = graph;
+            }
+            command.result = graph->engine->execute(command.input, command.length, command.clientFd, *command.response);
+            command.done.complete();
+        }
+        if (locked != nullptr) locked->mutex.unlock();
+    }
+}
+
+/**
+ * @brief Prints the command statistics every @p intervalSeconds seconds.
+ */
+void dumpStatsPeriodically(unsigned int intervalSeconds) {
+    ResponseBuffer report;
+    while (true) {
+        sleep(intervalSeconds);
+        report.clear();
+        ServerStats::report(report);
+        cout << "---- Stats ----" << endl;
+        cout.write(report.data(), report.size()) << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    signal(SIGINT, signalHandler);
+
+    // -s <seconds> enables a periodic statistics dump, -c selects the coordinate type,
+    // -H and -N choose the page size and NUMA placement of large point buffers,
+    // -b, -a and -D set the listen backlog, accept budget and TCP_DEFER_ACCEPT seconds,
+    // -A runs graph commands on a single state-owner thread fed by a lock-free queue,
+    // -p sets the port and -S "port,host:port,..." makes this server a coordinator of those shards,
+    // -L <dir> logs graph changes there (recovering them first), with -G the group commit budget
+    // in microseconds and -K the megabytes of log between checkpoints,
+    // -F <host:port> makes this server a read-only follower of that leader, which must run with -L,
+    // -U <path> also serves clients on this host on a Unix socket there, over shared rings if they ask,
+    // -u <port> takes point batches in UDP datagrams on that port,
+    // -d <dir> is the directory CHFile reads point files from (CHFile is off without it)
+    const char* coordinateType = "float";
+    PagePolicy pages = PAGES_TRANSPARENT;
+    NumaPolicy numa = NUMA_LOCAL;
+    AcceptOptions acceptOptions;
+    bool actorMode = false;
+    const char* port = SERVER_PORT;
+    const char* shards = nullptr;
+    const char* logDirectory = nullptr;
+    const char* leader = nullptr;
+    const char* ingestPort = nullptr;
+    const char* dataDirectory = nullptr;
+    uint64_t commitBudget = WAL_DEFAULT_BUDGET_US;
+    uint64_t checkpointMegabytes = WAL_DEFAULT_CHECKPOINT_MB;
+    int option;
+    while ((option = getopt(argc, argv, "s:c:H:N:b:a:D:Ap:S:L:G:K:F:U:u:d:")) != -1) {
+        if (option == 's' && atoi(optarg) > 0) {
+            std::thread(dumpStatsPeriodically, (unsigned int)atoi(optarg)).detach();
+        } else if (option == 'c') {
+            coordinateType = optarg;
+        } else if (option == 'H' && LargePages::parsePagePolicy(optarg, pages)) {
+            continue;
+        } else if (option == 'N' && LargePages::parseNumaPolicy(optarg, numa)) {
+            continue;
+        } else if (option == 'A') {
+            actorMode = true;
+        } else if (option == 'p') {
+            port = optarg;
+        } else if (option == 'S') {
+            shards = optarg;
+        } else if (option == 'L') {
+            logDirectory = optarg;
+        } else if (option == 'G') {
+            commitBudget = strtoull(optarg, nullptr, 10);
+        } else if (option == 'K') {
+            checkpointMegabytes = strtoull(optarg, nullptr, 10);
+        } else if (option == 'F') {
+            leader = optarg;
+        } else if (option == 'U') {
+            localPath = optarg;
+        } else if (option == 'u') {
+            ingestPort = optarg;
+        } else if (option == 'd') {
+            dataDirectory = optarg;
+        } else if (acceptOptions.parse(option, optarg)) {
+            continue;
+        } else {
+            fprintf(stderr, "Usage: %s [-s stats_interval_seconds] [-c int|float|double] "
+                            "[-H default|small|thp|explicit] [-N local|interleave|firsttouch]\n"
+                            "          [-b listen_backlog] [-a accept_budget] [-D defer_accept_seconds] [-A]\n"
+                            "          [-p port] [-S shard_ports] [-L log_dir] [-G commit_budget_us] [-K checkpoint_mb]\n"
+                            "          [-F leader_host:port] [-U local_socket_path] [-u ingest_udp_port]\n"
+                            "          [-d chfile_data_dir]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    LargePages::configure(pages, numa);
+
+    graphRegistry = new GraphRegistry(coordinateType);
+    if (graphRegistry->open(DEFAULT_GRAPH_NAME)->engine == nullptr) {
+        fprintf(stderr, "Unknown coordinate type '%s', expected int, float or double\n", coordinateType);
+        return 1;
+    }
+
+    if (dataDirectory != nullptr && !CommandEngine::setDataDirectory(dataDirectory)) {
+        perror(dataDirectory);
+        return 1;
+    }
+
+    if (leader != nullptr && (logDirectory != nullptr || shards != nullptr)) {
+        fprintf(stderr, "A follower (-F) takes its graphs from the leader and cannot use -L or -S\n");
+        return 1;
+    }
+    if (localPath != nullptr && shards != nullptr) {
+        fprintf(stderr, "Local clients (-U) are served from this server's own graphs and cannot be used with -S\n");
+        return 1;
+    }
+    if (ingestPort != nullptr && (leader != nullptr || shards != nullptr)) {
+        fprintf(stderr, "UDP ingest (-u) writes to this server's own graphs and cannot be used with -F or -S\n");
+        return 1;
+    }
+    if (leader != nullptr) {
+        replicaClient = new ReplicaClient(*graphRegistry, leader);
+        replicaClient->start();
+    }
+
+    if (logDirectory != nullptr) {
+        writeAheadLog = new WriteAheadLog(logDirectory, commitBudget, checkpointMegabytes << 20);
+        if (!writeAheadLog->recover(*graphRegistry)) return 1;
+        graphRegistry->attachLog(writeAheadLog);
+        writeAheadLog->start(*graphRegistry);
+    }
+
+    // After recovery, so datagrams land on the recovered graphs
+    if (ingestPort != nullptr) {
+        pointIngest = new PointIngest(*graphRegistry, writeAheadLog);
+        if (!pointIngest->open(ingestPort)) {
+            perror("Error creating ingest socket");
+            return 1;
+        }
+        pointIngest->start();
+    }
+
+    if (shards != nullptr) {
+        shardCoordinator = new ShardCoordinator(coordinateType);
+        if (!shardCoordinator->connect(shards)) return 1;
+    }
+
+    // Each client gets a thread that blocks in recv, so its socket stays blocking
+    Acceptor acceptor(acceptOptions, 0);
+    int serverSocket = createServerSocket(acceptor, port);
     if (serverSocket == -1) {
         perror("Error creating server socket");
         return 1;
     }
 
-    asyncReactor.addFileDescriptor(serverSocket, [](int fd) {
-    std::mutex mutex; // Adjust if needed
-    processClientMessages(fd, mutex); // Wrap in lambda for additional arguments
-});
+    // Same handler as TCP clients; only a Unix socket can pass a ring's descriptor
+    AcceptOptions localOptions = acceptOptions;
+    localOptions.deferSeconds = 0;
+    Acceptor localAcceptor(localOptions, 0);
+    if (localPath != nullptr) {
+        if (createLocalSocket(localAcceptor, localPath) == -1) {
+            perror("Error creating local socket");
+            return 1;
+        }
+        std::thread([&localAcceptor] { localProactor.start(localAcceptor, processClientMessages); }).detach();
+    }
+
+    if (actorMode) {
+        commandQueue = new CommandQueue();
+        std::thread(ownGraphState).detach();
+    }
 
-    std::cout << "Server started, listening on port " << SERVER_PORT << std::endl;
-    asyncReactor.start();
+    std::cout << "Server started (" << coordinateType << " coordinates), listening on port " << port;
+    if (shardCoordinator != nullptr) std::cout << ", coordinating " << shardCoordinator->shardCount() << " shards";
+    if (replicaClient != nullptr) std::cout << ", following " << leader;
+    if (localPath != nullptr) std::cout << ", local clients on " << localPath;
+    if (pointIngest != nullptr) std::cout << ", UDP ingest on port " << ingestPort;
+    std::cout << std::endl;
+    asyncProactor.start(acceptor, shardCoordinator != nullptr ? processCoordinatorMessages : processClientMessages);
 
     return 0;
 }
@@ -0,0 +1,331 @@
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "ShardLink.hpp"
+#include "WriteAheadLog.hpp"
+
+static bool readFull(int fd, void* data, size_t length) {
+    char* cursor = static_cast<char*>(data);
+    while (length > 0) {
+        ssize_t received = recv(fd, cursor, length, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        cursor += received;
+        length -= received;
+    }
+    return true;
+}
+
+static bool writeFull(int fd, const void* data, size_t length) {
+    const char* cursor = static_cast<const char*>(data);
+    while (length > 0) {
+        ssize_t sent = send(fd, cursor, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        cursor += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+static void appendFrame(std::vector<char>& buffer, const LinkHeader& header, const double* coordinates, size_t pairs) {
+    size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(LinkHeader) + pairs * 2 * sizeof(double));
+    memcpy(buffer.data() + offset, &header, sizeof(LinkHeader));
+    if (pairs > 0) memcpy(buffer.data() + offset + sizeof(LinkHeader), coordinates, pairs * 2 * sizeof(double));
+}
+
+ShardLink::~ShardLink() {
+    if (fd < 0) return;
+    shutdown(fd, SHUT_RDWR);
+    reader.join();
+    close(fd);
+}
+
+bool ShardLink::connect(const char* host, const char* port) {
+    struct addrinfo hints, *result;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, port, &hints, &result) != 0) return false;
+
+    for (struct addrinfo* current = result; current != nullptr && fd < 0; current = current->ai_next) {
+        fd = socket(current->ai_family, current->ai_socktype | SOCK_CLOEXEC, current->ai_protocol);
+        if (fd < 0) continue;
+        if (::connect(fd, current->ai_addr, current->ai_addrlen) < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(result);
+    if (fd < 0) return false;
+
+    // Like any client, the link is greeted with the text prompt first
+    char greeting[3];
+    if (!readFull(fd, greeting, sizeof greeting) || memcmp(greeting, ">> ", 3) != 0) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    // Requests are small and latency bound
+    int yes = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+    reader = std::thread(&ShardLink::readReplies, this);
+    return true;
+}
+
+void ShardLink::fail(Request& request) {
+    request.status = LINK_FAILED;
+    request.count = 0;
+    request.done.complete();
+}
+
+void ShardLink::start(Request& request, LinkOp op, const double* coordinates, size_t count) {
+    request.done.reset();
+    std::lock_guard<std::mutex> sendLock(sendMutex);
+    {
+        std::lock_guard<std::mutex> lock(inflightMutex);
+        if (broken) {
+            fail(request);
+            return;
+        }
+        request.id = nextId++;
+        inflight.push_back(&request);
+    }
+
+    LinkHeader header = {LINK_MAGIC, (uint8_t)op, LINK_OK, request.id, (uint32_t)count};
+    sendBuffer.clear();
+    appendFrame(sendBuffer, header, coordinates, count);
+    // On failure the reader sees the link close and fails every request in flight
+    if (!writeFull(fd, sendBuffer.data(), sendBuffer.size())) shutdown(fd, SHUT_RDWR);
+}
+
+void ShardLink::readReplies() {
+    LinkHeader header;
+    while (readFull(fd, &header, sizeof header)) {
+        Request* request = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(inflightMutex);
+            if (!inflight.empty()) {
+                request = inflight.front();
+                inflight.pop_front();
+            }
+        }
+        if (request == nullptr || header.magic != LINK_MAGIC || header.id != request->id ||
+            header.count > LINK_MAX_POINTS) {
+            if (request != nullptr) fail(*request);
+            break;
+        }
+
+        request->status = header.status;
+        request->count = header.count;
+        if (header.op == LINK_HULL) {
+            request->coordinates.resize(2 * (size_t)header.count);
+            if (!readFull(fd, request->coordinates.data(), request->coordinates.size() * sizeof(double))) {
+                fail(*request);
+                break;
+            }
+        }
+        request->done.complete();
+    }
+
+    std::lock_guard<std::mutex> lock(inflightMutex);
+    broken = true;
+    for (Request* request : inflight) fail(*request);
+    inflight.clear();
+}
+
+/**
+ * @brief Every complete frame in hand is answered before the replies go out in one send,
+ * so a pipelined burst costs one system call each way.
+ */
+void ShardLink::serve(int fd, const char* received, size_t length, CommandEngine& engine, std::mutex& mutex,
+                      WriteAheadLog* log) {
+    std::vector<char> input(received, received + length);
+    std::vector<char> output;
+    std::vector<size_t> changeReplies; // Offsets in output of the replies that wait for the log
+    std::vector<double> coordinates;
+    char buffer[64 * 1024];
+    bool open = true;
+
+    while (open) {
+        size_t consumed = 0;
+        while (input.size() - consumed >= sizeof(LinkHeader)) {
+            LinkHeader header;
+            memcpy(&header, input.data() + consumed, sizeof header);
+            if (header.magic != LINK_MAGIC || header.count > LINK_MAX_POINTS) {
+                open = false;
+                break;
+            }
+            bool carriesPoints = header.op == LINK_ADD || header.op == LINK_REMOVE;
+            size_t payload = carriesPoints ? (size_t)header.count * 2 * sizeof(double) : 0;
+            if (input.size() - consumed - sizeof header < payload) break;
+            coordinates.resize(payload / sizeof(double));
+            if (payload > 0) memcpy(coordinates.data(), input.data() + consumed + sizeof header, payload);
+            consumed += sizeof header + payload;
+
+            LinkHeader reply = {LINK_MAGIC, header.op, LINK_OK, header.id, 0};
+            bool changes = carriesPoints || header.op == LINK_RESET;
+            if (changes && log != nullptr && log->hasFailed()) {
+                reply.status = LINK_FAILED;
+            } else {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (carriesPoints)
+                    reply.count = (uint32_t)engine.applyPoints(header.op == LINK_REMOVE, coordinates.data(), header.count);
+                else if (header.op == LINK_HULL) engine.hullCoordinates(coordinates);
+                else if (header.op == LINK_RESET) engine.resetPoints();
+                else reply.status = LINK_FAILED;
+            }
+
+            size_t pairs = 0;
+            if (header.op == LINK_HULL) {
+                pairs = coordinates.size() / 2;
+                if (pairs > LINK_MAX_POINTS) {
+                    reply.status = LINK_FAILED;
+                    pairs = 0;
+                }
+                reply.count = (uint32_t)pairs;
+            }
+            if (changes && reply.status == LINK_OK) changeReplies.push_back(output.size());
+            appendFrame(output, reply, coordinates.data(), pairs);
+        }
+        input.erase(input.begin(), input.begin() + consumed);
+
+        // One wait covers the burst; if the log failed, none of its changes is acknowledged
+        if (!changeReplies.empty() && log != nullptr && !log->waitDurable()) {
+            uint16_t failed = LINK_FAILED;
+            for (size_t offset : changeReplies)
+                memcpy(output.data() + offset + offsetof(LinkHeader, status), &failed, sizeof failed);
+        }
+        changeReplies.clear();
+
+        if (!output.empty() && !writeFull(fd, output.data(), output.size())) break;
+        output.clear();
+        if (!open) break;
+
+        ssize_t count = recv(fd, buffer, sizeof buffer, 0);
+        if (count <= 0) break;
+        input.insert(input.end(), buffer, buffer + count);
+    }
+    close(fd);
+}
+
+/**
+ * @brief Mixes the bit patterns of both coordinates; -0.0 is folded into 0.0 first, as they compare equal.
+ */
+static size_t shardOf(double x, double y, size_t shards) {
+    x += 0.0;
+    y += 0.0;
+    uint64_t xBits, yBits;
+    memcpy(&xBits, &x, sizeof x);
+    memcpy(&yBits, &y, sizeof y);
+    uint64_t hash = xBits * 0x9E3779B97F4A7C15ull + yBits;
+    hash ^= hash >> 29;
+    hash *= 0xBF58476D1CE4E5B9ull;
+    hash ^= hash >> 32;
+    return hash % shards;
+}
+
+bool ShardCoordinator::connect(const char* spec) {
+    std::string list(spec);
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        size_t end = list.find(',', begin);
+        if (end == std::string::npos) end = list.size();
+        std::string item = list.substr(begin, end - begin);
+        begin = end + 1;
+        if (item.empty()) continue;
+
+        size_t colon = item.rfind(':');
+        std::string host = colon == std::string::npos ? "localhost" : item.substr(0, colon);
+        std::string port = colon == std::string::npos ? item : item.substr(colon + 1);
+        links.emplace_back(new ShardLink());
+        if (!links.back()->connect(host.c_str(), port.c_str())) {
+            fprintf(stderr, "Cannot reach shard %s:%s\n", host.c_str(), port.c_str());
+            return false;
+        }
+    }
+    if (links.empty()) {
+        fprintf(stderr, "No shards given\n");
+        return false;
+    }
+    return true;
+}
+
+bool ShardCoordinator::apply(bool remove, const DoublePoint* points, size_t count, size_t& applied) {
+    std::vector<std::vector<double>> shares(links.size());
+    for (size_t i = 0; i < count; ++i) {
+        std::vector<double>& share = shares[shardOf(points[i].getX(), points[i].getY(), links.size())];
+        share.push_back(points[i].getX());
+        share.push_back(points[i].getY());
+    }
+
+    // Every frame is sent before any reply is awaited; a deque never moves its requests
+    std::deque<ShardLink::Request> requests;
+    for (size_t s = 0; s < links.size(); ++s) {
+        size_t pairs = shares[s].size() / 2;
+        for (size_t offset = 0; offset < pairs; offset += LINK_BATCH_POINTS) {
+            requests.emplace_back();
+            links[s]->start(requests.back(), remove ? LINK_REMOVE : LINK_ADD, shares[s].data() + 2 * offset,
+                            std::min<size_t>(LINK_BATCH_POINTS, pairs - offset));
+        }
+    }
+
+    bool reached = true;
+    applied = 0;
+    for (ShardLink::Request& request : requests) {
+        request.done.wait();
+        if (request.status != LINK_OK) reached = false;
+        else applied += request.count;
+    }
+    return reached;
+}
+
+bool ShardCoordinator::reset() {
+    std::deque<ShardLink::Request> requests(links.size());
+    for (size_t s = 0; s < links.size(); ++s) links[s]->start(requests[s], LINK_RESET, nullptr, 0);
+
+    bool reached = true;
+    for (ShardLink::Request& request : requests) {
+        request.done.wait();
+        if (request.status != LINK_OK) reached = false;
+    }
+    return reached;
+}
+
+CommandVerb ShardCoordinator::query(const char* inputLine, size_t inputLength, int clientFd, ResponseBuffer& response) {
+    std::deque<ShardLink::Request> requests(links.size());
+    for (size_t s = 0; s < links.size(); ++s) links[s]->start(requests[s], LINK_HULL, nullptr, 0);
+
+    bool reached = true;
+    for (ShardLink::Request& request : requests) {
+        request.done.wait();
+        if (request.status != LINK_OK) reached = false;
+    }
+    if (!reached) {
+        response.append("A shard is unavailable");
+        return VERB_CH;
+    }
+
+    std::lock_guard<std::mutex> lock(mergedMutex);
+    mergedCoordinates.clear();
+    for (ShardLink::Request& request : requests)
+        mergedCoordinates.insert(mergedCoordinates.end(), request.coordinates.begin(), request.coordinates.end());
+    merged->resetPoints();
+    merged->applyPoints(false, mergedCoordinates.data(), mergedCoordinates.size() / 2);
+    return merged->execute(inputLine, inputLength, clientFd, response);
+}
+
+// Neither command touches the merged graph, so mergedMutex is not needed
+CommandVerb ShardCoordinator::computeLocally(const char* inputLine, size_t inputLength, ResponseBuffer& response) {
+    if (strncmp(inputLine, "CHFile", 6) == 0) return merged->hullOfFile(inputLine, inputLength, response);
+    return merged->hullsOfGroups(inputLine, inputLength, response);
+}
@@ -0,0 +1,165 @@
+#ifndef SHARD_LINK_HPP
+#define SHARD_LINK_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CommandQueue.hpp"
+#include "GraphEngine.hpp"
+#include "Protocol.hpp"
+
+#define LINK_MAGIC 0xC5             // First byte of every frame; no text command starts with it
+#define LINK_MAX_POINTS (1 << 20)   // Largest point payload a frame may carry
+#define LINK_BATCH_POINTS 4096      // Points the coordinator packs into one frame per shard
+
+/**
+ * @brief Operations of the binary link between a coordinator and its shard servers.
+ */
+enum LinkOp {
+    LINK_ADD = 1, // Add the points that follow; the reply's count is how many were taken
+    LINK_REMOVE,  // Remove the points that follow; the reply's count is how many were taken
+    LINK_HULL,    // The reply carries the shard's hull
+    LINK_RESET    // Replace the shard's graph with an empty one
+};
+
+enum LinkStatus { LINK_OK = 0, LINK_FAILED };
+
+/**
+ * @brief Header of a request or reply frame.
+ *
+ * LINK_ADD and LINK_REMOVE requests, and LINK_HULL replies, are followed by count
+ * (x, y) pairs of doubles; other frames carry no points. Fields are in host byte
+ * order: the link is meant for servers on one machine or on machines of the same
+ * architecture. Replies come back in request order, with the
+ * request's id, so any number of requests may be in flight on a link.
+ */
+struct LinkHeader {
+    uint8_t magic;
+    uint8_t op;
+    uint16_t status;
+    uint32_t id;
+    uint32_t count;
+};
+static_assert(sizeof(LinkHeader) == 12, "LinkHeader must not be padded");
+
+/**
+ * @brief The coordinator's connection to one shard server.
+ *
+ * Requests from any number of threads are written back to back without waiting
+ * for replies; a reader thread hands each reply to the request it answers.
+ */
+class ShardLink {
+public:
+    /**
+     * @brief One request and, once done completes, its reply.
+     */
+    struct Request {
+        uint32_t id = 0;
+        uint16_t status = LINK_OK;
+        uint32_t count = 0;
+        std::vector<double> coordinates; // LINK_HULL replies only
+        CompletionSlot done;
+    };
+
+private:
+    int fd = -1;
+    std::mutex sendMutex;            // Keeps frames whole and in the order they are queued below
+    std::vector<char> sendBuffer;
+    std::mutex inflightMutex;
+    std::deque<Request*> inflight;   // Awaiting a reply, oldest first
+    bool broken = false;             // Guarded by inflightMutex
+    uint32_t nextId = 1;
+    std::thread reader;
+
+    void readReplies();
+    void fail(Request& request);
+
+public:
+    ShardLink() {}
+    ~ShardLink();
+
+    ShardLink(const ShardLink&) = delete;
+    ShardLink& operator=(const ShardLink&) = delete;
+
+    /**
+     * @brief Connects to the shard at @p host : @p port and starts the reader thread.
+     * @return False if the connection failed.
+     */
+    bool connect(const char* host, const char* port);
+
+    /**
+     * @brief Sends a request and returns at once; wait on @p request.done for the reply.
+     *
+     * If the link is down, the request completes right away with LINK_FAILED.
+     */
+    void start(Request& request, LinkOp op, const double* coordinates, size_t count);
+
+    /**
+     * @brief Shard side: answers frames on @p fd until the coordinator disconnects, then closes it.
+     *
+     * @param received Bytes already read from the connection, starting with the first frame.
+     * @param engine The graph the link works on, guarded by @p mutex.
+     * @param log If not nullptr, changes are durable in it before they are answered.
+     */
+    static void serve(int fd, const char* received, size_t length, CommandEngine& engine, std::mutex& mutex,
+                      WriteAheadLog* log);
+};
+
+/**
+ * @brief Coordinator mode: several shard servers behind one client-facing server.
+ *
+ * Points are forwarded to the shard their coordinates hash to, so equal points always
+ * meet in the same shard. Hull commands fetch every shard's hull at once and run on a
+ * local graph made of those hulls, since the hull of the union is the hull of the parts'
+ * hulls. The shards must use the same coordinate type as the coordinator.
+ */
+class ShardCoordinator {
+private:
+    std::vector<std::unique_ptr<ShardLink>> links;
+    std::unique_ptr<CommandEngine> merged;
+    std::mutex mergedMutex;
+    std::vector<double> mergedCoordinates;
+
+public:
+    /**
+     * @param coordinateType "int", "float" or "double", as accepted by CommandEngine::create.
+     */
+    explicit ShardCoordinator(const char* coordinateType) : merged(CommandEngine::create(coordinateType)) {}
+
+    /**
+     * @brief Connects to every shard of @p spec: "port,port,..." on localhost, or "host:port,...".
+     * @return False, after printing why, if a shard cannot be reached.
+     */
+    bool connect(const char* spec);
+
+    size_t shardCount() const { return links.size(); }
+
+    /**
+     * @brief Adds (or removes) @p count points, sending each shard its share in one frame per batch.
+     * @param applied Receives the number of points the shards took.
+     * @return False if a shard could not be reached.
+     */
+    bool apply(bool remove, const DoublePoint* points, size_t count, size_t& applied);
+
+    /**
+     * @brief Empties the graph of every shard.
+     */
+    bool reset();
+
+    /**
+     * @brief Gathers the shards' hulls, then runs a hull command (CH, Contains, Shape, ...) on their union.
+     */
+    CommandVerb query(const char* inputLine, size_t inputLength, int clientFd, ResponseBuffer& response);
+
+    /**
+     * @brief Handles CHFile and CHBatch, which do not involve the graph, on the coordinator itself.
+     */
+    CommandVerb computeLocally(const char* inputLine, size_t inputLength, ResponseBuffer& response);
+};
+
+#endif // SHARD_LINK_HPP
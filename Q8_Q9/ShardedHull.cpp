@@ -0,0 +1,118 @@
+#include <cstring>
+#include "ShardedHull.hpp"
+
+template <class T>
+ShardedHull<T>::ShardedHull(size_t shardCount) {
+    shardCount = std::min<size_t>(std::max<size_t>(shardCount, 1), MAX_POINT_SHARDS);
+    for (size_t s = 0; s < shardCount; ++s) {
+        shards.emplace_back(new Shard());
+        shards.back()->worker = std::thread(run, shards.back().get());
+    }
+}
+
+template <class T>
+ShardedHull<T>::~ShardedHull() {
+    for (std::unique_ptr<Shard>& shard : shards) {
+        post(*shard, UPDATE_STOP, PointType());
+        shard->worker.join();
+    }
+}
+
+/**
+ * @brief Mixes the bit patterns of both coordinates; -0.0 is folded into 0.0 first, as they compare equal.
+ */
+template <class T>
+size_t ShardedHull<T>::shardOf(const PointType& point) const {
+    T x = point.getX() + T(0), y = point.getY() + T(0);
+    uint64_t xBits = 0, yBits = 0;
+    memcpy(&xBits, &x, sizeof(T));
+    memcpy(&yBits, &y, sizeof(T));
+    uint64_t hash = xBits * 0x9E3779B97F4A7C15ull + yBits;
+    hash ^= hash >> 29;
+    hash *= 0xBF58476D1CE4E5B9ull;
+    hash ^= hash >> 32;
+    return hash % shards.size();
+}
+
+template <class T>
+void ShardedHull<T>::post(Shard& shard, UpdateKind kind, const PointType& point) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.inbox.push_back(Update{kind, point});
+    if (shard.sleeping) shard.wake.notify_one();
+}
+
+/**
+ * @brief A worker: takes everything queued for its shard at once and applies it outside the lock.
+ */
+template <class T>
+void ShardedHull<T>::run(Shard* shard) {
+    std::unique_lock<std::mutex> lock(shard->mutex);
+    while (true) {
+        while (shard->inbox.empty()) {
+            shard->sleeping = true;
+            shard->wake.wait(lock);
+            shard->sleeping = false;
+        }
+        shard->working.swap(shard->inbox);
+        lock.unlock();
+
+        for (const Update& update : shard->working) {
+            if (update.kind == UPDATE_STOP) return;
+            apply(*shard, update);
+        }
+        shard->working.clear();
+        lock.lock();
+    }
+}
+
+template <class T>
+void ShardedHull<T>::apply(Shard& shard, const Update& update) {
+    if (update.kind == UPDATE_ADD) {
+        shard.points.push_back(update.point);
+        if (!shard.hullStale) shard.localHull.insert(update.point);
+    } else if (update.kind == UPDATE_REMOVE) {
+        for (size_t i = 0; i < shard.points.size(); ++i) {
+            if (shard.points[i].getX() == update.point.getX() && shard.points[i].getY() == update.point.getY()) {
+                shard.points[i] = shard.points.back();
+                shard.points.pop_back();
+                // A point strictly inside the hull is neither a vertex nor a pending candidate
+                if (!shard.localHull.strictlyInside(update.point)) shard.hullStale = true;
+                break;
+            }
+        }
+    } else {
+        if (shard.hullStale) {
+            shard.localHull.clear();
+            shard.localHull.add(shard.points.data(), shard.points.size());
+            shard.hullStale = false;
+        } else {
+            shard.localHull.flush();
+        }
+        shard.published = shard.localHull.hull();
+        shard.publishedCount = shard.points.size();
+        shard.publishDone.complete();
+    }
+}
+
+template <class T>
+const vector<typename ShardedHull<T>::PointType>& ShardedHull<T>::hull() {
+    // Ask every shard first so that they all work at once
+    for (std::unique_ptr<Shard>& shard : shards) {
+        shard->publishDone.reset();
+        post(*shard, UPDATE_PUBLISH, PointType());
+    }
+
+    mergeBuffer.clear();
+    mergedCount = 0;
+    for (std::unique_ptr<Shard>& shard : shards) {
+        shard->publishDone.wait();
+        mergeBuffer.insert(mergeBuffer.end(), shard->published.begin(), shard->published.end());
+        mergedCount += shard->publishedCount;
+    }
+    mergedHull = BasicConvexHull<T>::findConvexHull(mergeBuffer);
+    return mergedHull;
+}
+
+template class ShardedHull<int32_t>;
+template class ShardedHull<float>;
+template class ShardedHull<double>;
@@ -0,0 +1,115 @@
+#ifndef SHARDED_HULL_HPP
+#define SHARDED_HULL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CommandQueue.hpp"
+#include "StreamingHull.hpp"
+
+using std::vector;
+
+#define MAX_POINT_SHARDS 64
+
+/**
+ * @brief A point set split into shards, each owned by its own worker thread.
+ *
+ * A point goes to the shard its coordinates hash to, so equal points always meet
+ * in the same shard and a removal never has to look elsewhere. Nothing is shared
+ * between shards: each worker keeps its points and the hull of its points, and
+ * applies the updates queued for it in order. insert() and remove() only queue
+ * the update and return.
+ *
+ * hull() asks every shard for its hull and merges those. Since the hull of a
+ * union is the hull of the parts' hulls, it touches O(shards * h) points rather
+ * than all n.
+ */
+template <class T>
+class ShardedHull {
+private:
+    typedef BasicPoint<T> PointType;
+
+    enum UpdateKind { UPDATE_ADD, UPDATE_REMOVE, UPDATE_PUBLISH, UPDATE_STOP };
+
+    struct Update {
+        UpdateKind kind;
+        PointType point;
+    };
+
+    struct Shard {
+        // Shared with the threads that queue updates
+        alignas(64) std::mutex mutex;
+        std::condition_variable wake;
+        vector<Update> inbox;
+        bool sleeping = false;
+
+        // Owned by the worker
+        PointVector<T> points;
+        IncrementalHull<T> localHull;
+        bool hullStale = false;      // A hull point was removed; rebuilt from the points on the next publish
+        vector<Update> working;
+
+        // Written by the worker before it completes a publish
+        vector<PointType> published;
+        size_t publishedCount = 0;
+        CompletionSlot publishDone;
+
+        std::thread worker;
+    };
+
+    vector<std::unique_ptr<Shard>> shards;
+    PointVector<T> mergeBuffer;
+    vector<PointType> mergedHull;
+    size_t mergedCount = 0;
+
+    size_t shardOf(const PointType& point) const;
+    void post(Shard& shard, UpdateKind kind, const PointType& point);
+    static void run(Shard* shard);
+    static void apply(Shard& shard, const Update& update);
+
+public:
+    /**
+     * @brief Starts @p shardCount workers, between 1 and MAX_POINT_SHARDS.
+     */
+    explicit ShardedHull(size_t shardCount);
+
+    /**
+     * @brief Stops and joins the workers.
+     */
+    ~ShardedHull();
+
+    ShardedHull(const ShardedHull&) = delete;
+    ShardedHull& operator=(const ShardedHull&) = delete;
+
+    /**
+     * @brief Queues @p point for its shard.
+     */
+    void insert(const PointType& point) { post(*shards[shardOf(point)], UPDATE_ADD, point); }
+
+    /**
+     * @brief Queues the removal of one point equal to @p point, if there is one.
+     */
+    void remove(const PointType& point) { post(*shards[shardOf(point)], UPDATE_REMOVE, point); }
+
+    /**
+     * @brief Waits for every queued update, then merges the shards' hulls.
+     * @return The hull, counter-clockwise from the leftmost point.
+     */
+    const vector<PointType>& hull();
+
+    /**
+     * @brief Number of points as of the last hull().
+     */
+    size_t pointCount() const { return mergedCount; }
+
+    size_t shardCount() const { return shards.size(); }
+};
+
+extern template class ShardedHull<int32_t>;
+extern template class ShardedHull<float>;
+extern template class ShardedHull<double>;
+
+#endif // SHARDED_HULL_HPP
@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include "Stats.hpp"
+
+/**
+ * @brief All statistics recorded by one thread.
+ */
+struct StatsShard {
+    std::atomic<VerbStats*> verbs[VERB_COUNT] = {}; // Published by the writer, read by report()
+    std::atomic<uint64_t> hullCount{0};
+    std::atomic<uint64_t> hullVertexTotal{0};
+    std::atomic<uint64_t> maxHullSize{0};
+    std::atomic<uint64_t> pointsHulled{0};
+
+    StatsShard() {}
+    StatsShard(const StatsShard&) = delete;
+    StatsShard& operator=(const StatsShard&) = delete;
+
+    ~StatsShard() {
+        for (std::atomic<VerbStats*>& stats : verbs) delete stats.load(std::memory_order_relaxed);
+    }
+};
+
+// The shard's counters for @p verb; only the shard's writer calls this
+static VerbStats& verbStats(StatsShard& shard, int verb) {
+    VerbStats* stats = shard.verbs[verb].load(std::memory_order_relaxed);
+    if (stats == nullptr) {
+        stats = new VerbStats();
+        shard.verbs[verb].store(stats, std::memory_order_release);
+    }
+    return *stats;
+}
+
+// Single-writer update: a relaxed load/store pair avoids a locked read-modify-write
+static inline void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+static inline void raise(std::atomic<uint64_t>& counter, uint64_t value) {
+    if (value > counter.load(std::memory_order_relaxed))
+        counter.store(value, std::memory_order_relaxed);
+}
+
+static void mergeShard(StatsShard& into, const StatsShard& from) {
+    for (int v = 0; v < VERB_COUNT; ++v) {
+        const VerbStats* source = from.verbs[v].load(std::memory_order_acquire);
+        if (source == nullptr) continue;
+        VerbStats& target = verbStats(into, v);
+        for (size_t b = 0; b < HISTOGRAM_BUCKETS; ++b)
+            bump(target.histogramBuckets[b], source->histogramBuckets[b].load(std::memory_order_relaxed));
+        bump(target.count, source->count.load(std::memory_order_relaxed));
+        raise(target.maxLatency, source->maxLatency.load(std::memory_order_relaxed));
+        bump(target.bytesIn, source->bytesIn.load(std::memory_order_relaxed));
+        bump(target.bytesOut, source->bytesOut.load(std::memory_order_relaxed));
+    }
+    bump(into.hullCount, from.hullCount.load(std::memory_order_relaxed));
+    bump(into.hullVertexTotal, from.hullVertexTotal.load(std::memory_order_relaxed));
+    raise(into.maxHullSize, from.maxHullSize.load(std::memory_order_relaxed));
+    bump(into.pointsHulled, from.pointsHulled.load(std::memory_order_relaxed));
+}
+
+// Registry of live shards; totals of exited threads are folded into retiredShard
+static std::mutex registryMutex;
+static std::vector<StatsShard*> liveShards;
+static StatsShard* retiredShard = new StatsShard();
+
+/**
+ * @brief Owns the calling thread's shard for the lifetime of the thread.
+ */
+class ShardHandle {
+public:
+    StatsShard* shard;
+
+    ShardHandle() : shard(new StatsShard()) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        liveShards.push_back(shard);
+    }
+
+    ~ShardHandle() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        mergeShard(*retiredShard, *shard);
+        liveShards.erase(std::find(liveShards.begin(), liveShards.end(), shard));
+        delete shard;
+    }
+};
+
+static StatsShard& localShard() {
+    static thread_local ShardHandle handle;
+    return *handle.shard;
+}
+
+void LatencyHistogram::reset() {
+    std::fill(buckets, buckets + HISTOGRAM_BUCKETS, 0);
+    total = 0;
+    maxValue = 0;
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < HISTOGRAM_SUB_BUCKETS) return value;
+
+    int highestBit = 63 - __builtin_clzll(value);
+    if (highestBit > HISTOGRAM_MAX_BIT) return HISTOGRAM_BUCKETS - 1;
+    int shift = highestBit - HISTOGRAM_SUB_BUCKET_BITS;
+    size_t subBucket = (value >> shift) & (HISTOGRAM_SUB_BUCKETS - 1);
+    return (shift + 1) * HISTOGRAM_SUB_BUCKETS + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < HISTOGRAM_SUB_BUCKETS) return index;
+
+    int shift = index / HISTOGRAM_SUB_BUCKETS - 1;
+    uint64_t subBucket = index % HISTOGRAM_SUB_BUCKETS;
+    uint64_t lower = (HISTOGRAM_SUB_BUCKETS + subBucket) << shift;
+    return lower + ((uint64_t)1 << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    buckets[bucketIndex(value)]++;
+    total++;
+    maxValue = std::max(maxValue, value);
+}
+
+void LatencyHistogram::addToBucket(size_t index, uint64_t hits, uint64_t maxSample) {
+    buckets[index] += hits;
+    total += hits;
+    maxValue = std::max(maxValue, maxSample);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) buckets[i] += other.buckets[i];
+    total += other.total;
+    maxValue = std::max(maxValue, other.maxValue);
+}
+
+uint64_t LatencyHistogram::quantile(double q) const {
+    if (total == 0) return 0;
+
+    uint64_t rank = (uint64_t)(q * total);
+    if (rank >= total) rank = total - 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        seen += buckets[i];
+        if (seen > rank) return std::min(bucketUpperBound(i), maxValue);
+    }
+    return maxValue;
+}
+
+uint64_t ServerStats::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* ServerStats::verbName(CommandVerb verb) {
+    static const char* names[VERB_COUNT] = {
+        "CreateGraph", "GraphPoints", "CH", "AddPoint", "RemovePoint", "GenerateRandom", "Stats", "CHFile", "CreateStreamGraph", "CreateWindowGraph",
+        "Contains", "ContainsBatch", "Extreme", "Tangents", "Diameter", "Width", "MinRectangle", "Shape", "CHBatch",
+        "Use", "DropGraph", "Graphs", "CHAll", "CreateShardedGraph",
+        "Version", "WaitVersion", "Replication", "Ingest",
+        "Unknown"
+    };
+    return names[verb];
+}
+
+void ServerStats::recordCommand(CommandVerb verb, uint64_t latencyNs, size_t bytesIn, size_t bytesOut) {
+    VerbStats& stats = verbStats(localShard(), verb);
+    bump(stats.histogramBuckets[LatencyHistogram::bucketIndex(latencyNs)], 1);
+    bump(stats.count, 1);
+    raise(stats.maxLatency, latencyNs);
+    bump(stats.bytesIn, bytesIn);
+    bump(stats.bytesOut, bytesOut);
+}
+
+void ServerStats::recordHull(size_t hullSize, size_t pointCount) {
+    StatsShard& shard = localShard();
+    bump(shard.hullCount, 1);
+    bump(shard.hullVertexTotal, hullSize);
+    raise(shard.maxHullSize, hullSize);
+    bump(shard.pointsHulled, pointCount);
+}
+
+// Writes a nanosecond value as microseconds
+static void appendMicros(ResponseBuffer& out, uint64_t nanos) {
+    out.appendFloat(nanos / 1000.0f);
+    out.append("us");
+}
+
+void ServerStats::report(ResponseBuffer& out) {
+    StatsShard merged;
+    LatencyHistogram histogram;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    mergeShard(merged, *retiredShard);
+    for (StatsShard* shard : liveShards) mergeShard(merged, *shard);
+
+    for (int v = 0; v < VERB_COUNT; ++v) {
+        const VerbStats* recorded = merged.verbs[v].load(std::memory_order_relaxed);
+        if (recorded == nullptr) continue;
+        const VerbStats& stats = *recorded;
+        uint64_t count = stats.count.load(std::memory_order_relaxed);
+
+        histogram.reset();
+        uint64_t maxLatency = stats.maxLatency.load(std::memory_order_relaxed);
+        for (size_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+            uint64_t hits = stats.histogramBuckets[b].load(std::memory_order_relaxed);
+            if (hits > 0) histogram.addToBucket(b, hits, maxLatency);
+        }
+
+        out.append(verbName((CommandVerb)v));
+        out.append(" count=");
+        out.appendUnsigned(count);
+        out.append(" p50=");
+        appendMicros(out, histogram.quantile(0.5));
+        out.append(" p99=");
+        appendMicros(out, histogram.quantile(0.99));
+        out.append(" p999=");
+        appendMicros(out, histogram.quantile(0.999));
+        out.append(" max=");
+        appendMicros(out, maxLatency);
+        out.append(" in=");
+        out.appendUnsigned(stats.bytesIn.load(std::memory_order_relaxed));
+        out.append("B out=");
+        out.appendUnsigned(stats.bytesOut.load(std::memory_order_relaxed));
+        out.append("B\n");
+    }
+
+    uint64_t hulls = merged.hullCount.load(std::memory_order_relaxed);
+    out.append("Hulls computed=");
+    out.appendUnsigned(hulls);
+    if (hulls > 0) {
+        out.append(" avg_points=");
+        out.appendUnsigned(merged.pointsHulled.load(std::memory_order_relaxed) / hulls);
+        out.append(" avg_hull_size=");
+        out.appendUnsigned(merged.hullVertexTotal.load(std::memory_order_relaxed) / hulls);
+        out.append(" max_hull_size=");
+        out.appendUnsigned(merged.maxHullSize.load(std::memory_order_relaxed));
+    }
+}
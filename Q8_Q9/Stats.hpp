@@ -0,0 +1,138 @@
+#ifndef SERVER_STATS_HPP
+#define SERVER_STATS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "Protocol.hpp"
+
+#define HISTOGRAM_SUB_BUCKET_BITS 4  // 16 linear sub-buckets per power of two (~6% resolution)
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_MAX_BIT 36         // Values of 2^37 ns (about 137 s) and more share the last bucket
+#define HISTOGRAM_BUCKETS ((HISTOGRAM_MAX_BIT - HISTOGRAM_SUB_BUCKET_BITS + 2) * HISTOGRAM_SUB_BUCKETS)
+
+/**
+ * @brief The command verbs whose latency is tracked separately.
+ */
+enum CommandVerb {
+    VERB_CREATE_GRAPH = 0,
+    VERB_GRAPH_POINTS,  // "x,y" lines sent while a graph is being created
+    VERB_CH,
+    VERB_ADD_POINT,
+    VERB_REMOVE_POINT,
+    VERB_GENERATE_RANDOM,
+    VERB_STATS,
+    VERB_CH_FILE,
+    VERB_CREATE_STREAM_GRAPH,
+    VERB_CREATE_WINDOW_GRAPH,
+    VERB_CONTAINS,
+    VERB_CONTAINS_BATCH,
+    VERB_EXTREME,
+    VERB_TANGENTS,
+    VERB_DIAMETER,
+    VERB_WIDTH,
+    VERB_MIN_RECTANGLE,
+    VERB_SHAPE,
+    VERB_CH_BATCH,
+    VERB_USE,
+    VERB_DROP_GRAPH,
+    VERB_LIST_GRAPHS,
+    VERB_CH_ALL,
+    VERB_CREATE_SHARDED_GRAPH,
+    VERB_VERSION,
+    VERB_WAIT_VERSION,
+    VERB_REPLICATION,
+    VERB_INGEST,
+    VERB_UNKNOWN,
+    VERB_COUNT
+};
+
+/**
+ * @brief Log-linear (HDR-style) histogram of nanosecond latencies.
+ *
+ * Values are bucketed by their highest set bit and then linearly by the next
+ * HISTOGRAM_SUB_BUCKET_BITS bits, so every bucket has a bounded relative error.
+ * Values past HISTOGRAM_MAX_BIT are only bounded by the maximum.
+ */
+class LatencyHistogram {
+private:
+    uint64_t buckets[HISTOGRAM_BUCKETS];
+    uint64_t total;
+    uint64_t maxValue;
+
+public:
+    LatencyHistogram() { reset(); }
+
+    void reset();
+    void record(uint64_t value);
+    void merge(const LatencyHistogram& other);
+
+    /**
+     * @brief Adds @p hits samples directly to a bucket, e.g. when merging raw shard counts.
+     */
+    void addToBucket(size_t index, uint64_t hits, uint64_t maxSample);
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return maxValue; }
+
+    /**
+     * @brief Returns an upper bound of the given quantile (0..1).
+     */
+    uint64_t quantile(double q) const;
+
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(size_t index);
+};
+
+/**
+ * @brief Per-verb counters. Each instance is written by a single thread only, and
+ * allocated when that thread first records the verb.
+ */
+struct VerbStats {
+    std::atomic<uint64_t> histogramBuckets[HISTOGRAM_BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> maxLatency;
+    std::atomic<uint64_t> bytesIn;
+    std::atomic<uint64_t> bytesOut;
+};
+
+/**
+ * @brief Process-wide command statistics, recorded into per-thread shards.
+ *
+ * The recording path only touches the calling thread's shard with relaxed
+ * single-writer stores, so client threads never contend with each other.
+ * A shard holds counters only for the verbs its thread has run, which for a
+ * client connection is a handful. Readers merge all live shards plus the
+ * totals of threads that have exited.
+ */
+class ServerStats {
+public:
+    /**
+     * @brief Records one executed command.
+     *
+     * @param verb The command verb.
+     * @param latencyNs Time from receiving the command until its reply was sent.
+     * @param bytesIn Size of the request.
+     * @param bytesOut Size of the reply.
+     */
+    static void recordCommand(CommandVerb verb, uint64_t latencyNs, size_t bytesIn, size_t bytesOut);
+
+    /**
+     * @brief Records the size of a computed hull and of the graph it came from.
+     */
+    static void recordHull(size_t hullSize, size_t pointCount);
+
+    /**
+     * @brief Writes a human readable summary (counts, p50/p99/p999/max, bytes, hull sizes).
+     */
+    static void report(ResponseBuffer& out);
+
+    /**
+     * @brief Monotonic clock in nanoseconds.
+     */
+    static uint64_t now();
+
+    static const char* verbName(CommandVerb verb);
+};
+
+#endif // SERVER_STATS_HPP
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <cerrno>
+#include <future>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "StreamingHull.hpp"
+
+/**
+ * @brief Picks the hull vertices extreme in x, y, x + y and x - y (Akl-Toussaint).
+ *
+ * The result is a convex polygon of at most 8 vertices, in the hull's counter-clockwise
+ * order, that lies inside the hull; a point strictly inside it cannot be a hull vertex.
+ * The first vertex is repeated after the last to close the polygon.
+ */
+template <class T>
+static size_t extremeVertices(const vector<BasicPoint<T>>& hull, BasicPoint<T> polygon[9]) {
+    typedef typename BasicPoint<T>::Wide Wide;
+    size_t extremes[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    for (size_t i = 1; i < hull.size(); ++i) {
+        Wide x = hull[i].getX(), y = hull[i].getY();
+        const BasicPoint<T>* best[8];
+        for (int e = 0; e < 8; ++e) best[e] = &hull[extremes[e]];
+        if (x < best[0]->getX()) extremes[0] = i;
+        if (x + y < (Wide)best[1]->getX() + best[1]->getY()) extremes[1] = i;
+        if (y < best[2]->getY()) extremes[2] = i;
+        if (x - y > (Wide)best[3]->getX() - best[3]->getY()) extremes[3] = i;
+        if (x > best[4]->getX()) extremes[4] = i;
+        if (x + y > (Wide)best[5]->getX() + best[5]->getY()) extremes[5] = i;
+        if (y > best[6]->getY()) extremes[6] = i;
+        if (x - y < (Wide)best[7]->getX() - best[7]->getY()) extremes[7] = i;
+    }
+
+    // Keep hull order so the polygon stays convex and counter-clockwise
+    std::sort(extremes, extremes + 8);
+    size_t count = std::unique(extremes, extremes + 8) - extremes;
+    for (size_t e = 0; e < count; ++e) polygon[e] = hull[extremes[e]];
+    polygon[count] = polygon[0];
+    return count;
+}
+
+// True if point is strictly left of every edge of the counter-clockwise polygon
+template <class T>
+static inline bool insidePolygon(const BasicPoint<T>* polygon, size_t count, const BasicPoint<T>& point) {
+    for (size_t e = 0; e < count; ++e) {
+        if (polygon[e].cross(polygon[e + 1], point) >= 0) return false;
+    }
+    return true;
+}
+
+template <class T>
+void IncrementalHull<T>::merge(const PointType* points, size_t count) {
+    if (count == 0) return;
+
+    mergeBuffer.clear();
+    mergeBuffer.insert(mergeBuffer.end(), currentHull.begin(), currentHull.end());
+
+    // Once the hull has an interior, most points of a block fall inside it and are dropped here
+    PointType polygon[9];
+    size_t polygonSize = currentHull.size() >= 3 ? extremeVertices(currentHull, polygon) : 0;
+    if (polygonSize >= 3) {
+        for (size_t i = 0; i < count; ++i)
+            if (!insidePolygon(polygon, polygonSize, points[i])) mergeBuffer.push_back(points[i]);
+    } else {
+        mergeBuffer.insert(mergeBuffer.end(), points, points + count);
+    }
+
+    currentHull = BasicConvexHull<T>::findConvexHull(mergeBuffer);
+}
+
+/**
+ * @brief Binary search over the fan of triangles (hull[0], hull[i], hull[i + 1]).
+ */
+template <class T>
+bool IncrementalHull<T>::strictlyInside(const PointType& point) const {
+    size_t count = currentHull.size();
+    if (count < 3) return false;
+
+    // Counter-clockwise: the interior is where every edge's cross product is negative
+    const PointType& origin = currentHull[0];
+    if (origin.cross(currentHull[1], point) >= 0) return false;
+    if (currentHull[count - 1].cross(origin, point) >= 0) return false;
+
+    // Last fan ray the point is left of (or on)
+    size_t low = 1, high = count - 1;
+    while (high - low > 1) {
+        size_t middle = (low + high) / 2;
+        if (origin.cross(currentHull[middle], point) <= 0) low = middle;
+        else high = middle;
+    }
+    return currentHull[low].cross(currentHull[low + 1], point) < 0;
+}
+
+// Reads up to count points at offset; returns the number read, or -errno on error (errno is per thread)
+template <class T>
+static ssize_t readBlock(int fd, off_t offset, BasicPoint<T>* block, size_t count) {
+    char* target = reinterpret_cast<char*>(block);
+    size_t wanted = count * sizeof(BasicPoint<T>), done = 0;
+    while (done < wanted) {
+        ssize_t got = pread(fd, target + done, wanted - done, offset + done);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return -errno;
+        }
+        if (got == 0) break;
+        done += got;
+    }
+    return done / sizeof(BasicPoint<T>);
+}
+
+template <class T>
+bool PointFileHull<T>::compute(const char* path, vector<BasicPoint<T>>& hull, size_t& pointCount,
+                               size_t blockPoints) {
+    // Non-blocking, so that opening a FIFO does not wait for a writer before it is rejected
+    int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool computed = compute(fd, hull, pointCount, blockPoints);
+    int error = errno;
+    close(fd);
+    errno = error;
+    return computed;
+}
+
+template <class T>
+bool PointFileHull<T>::compute(int fd, vector<BasicPoint<T>>& hull, size_t& pointCount, size_t blockPoints) {
+    struct stat info;
+    if (fstat(fd, &info) < 0) return false;
+    if (!S_ISREG(info.st_mode) || info.st_size % sizeof(BasicPoint<T>) != 0) {
+        errno = EINVAL;
+        return false;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // Only the points there were at fstat are read, even if the file grows meanwhile
+    pointCount = info.st_size / sizeof(BasicPoint<T>);
+    if (blockPoints == 0) blockPoints = STREAM_BLOCK_POINTS;
+    size_t bufferPoints = std::min(blockPoints, std::max<size_t>(pointCount, 1));
+
+    // Double buffering: the next block is read while the current one is merged
+    PointVector<T> buffers[2];
+    buffers[0].resize(bufferPoints);
+    buffers[1].resize(bufferPoints);
+
+    IncrementalHull<T> running;
+    size_t current = 0, remaining = pointCount;
+    ssize_t currentCount = readBlock(fd, 0, buffers[0].data(), std::min(bufferPoints, remaining));
+    off_t nextOffset = currentCount > 0 ? currentCount * sizeof(BasicPoint<T>) : 0;
+
+    while (currentCount > 0) {
+        remaining -= currentCount;
+        size_t next = 1 - current;
+        std::future<ssize_t> pending = std::async(std::launch::async, readBlock<T>, fd, nextOffset,
+                                                  buffers[next].data(), std::min(bufferPoints, remaining));
+        running.add(buffers[current].data(), currentCount);
+
+        currentCount = pending.get();
+        if (currentCount > 0) nextOffset += currentCount * sizeof(BasicPoint<T>);
+        current = next;
+    }
+
+    if (currentCount < 0) {
+        errno = (int)-currentCount;
+        return false;
+    }
+
+    // A file cut short meanwhile gives the hull of the points that were read
+    pointCount -= remaining;
+    hull = running.hull();
+    return true;
+}
+
+template class IncrementalHull<int32_t>;
+template class IncrementalHull<float>;
+template class IncrementalHull<double>;
+template class PointFileHull<int32_t>;
+template class PointFileHull<float>;
+template class PointFileHull<double>;
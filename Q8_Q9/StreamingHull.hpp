@@ -0,0 +1,140 @@
+#ifndef STREAMING_HULL_HPP
+#define STREAMING_HULL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "ConvexHull.hpp"
+
+using std::vector;
+
+#define STREAM_BLOCK_POINTS (1 << 20) // Points read and merged per block
+#define STREAM_MIN_PENDING 64          // Candidates buffered by insert() before a merge, at least
+
+/**
+ * @brief A convex hull that absorbs points block by block.
+ *
+ * Only the hull of everything added so far is kept between blocks. Each block
+ * is merged by recomputing the hull of (current hull + block), so memory is
+ * O(block + h) however many points pass through.
+ *
+ * Single points go through insert(), which discards them on arrival when they are
+ * strictly inside the hull and buffers the rest, so memory stays O(h).
+ */
+template <class T>
+class IncrementalHull {
+private:
+    typedef BasicPoint<T> PointType;
+
+    vector<PointType> currentHull;
+    vector<PointType> pending;  // Inserted points not yet merged; none is strictly inside currentHull
+    PointVector<T> mergeBuffer; // Reused across blocks
+    size_t pointsSeen = 0;
+
+    void merge(const PointType* points, size_t count);
+
+public:
+    /**
+     * @brief Merges @p count points into the hull.
+     */
+    void add(const PointType* points, size_t count) {
+        flush();
+        merge(points, count);
+        pointsSeen += count;
+    }
+
+    /**
+     * @brief Adds one point: discarded if strictly inside the hull, otherwise kept as a candidate.
+     *
+     * Candidates are merged once there are as many as the hull has vertices (and at least
+     * STREAM_MIN_PENDING), which keeps insertion amortized O(log h).
+     *
+     * @return False if the point was discarded.
+     */
+    bool insert(const PointType& point) {
+        pointsSeen++;
+        if (strictlyInside(point)) return false;
+        pending.push_back(point);
+        if (pending.size() >= std::max<size_t>(STREAM_MIN_PENDING, currentHull.size())) flush();
+        return true;
+    }
+
+    /**
+     * @brief Merges the candidates buffered by insert().
+     */
+    void flush() {
+        if (pending.empty()) return;
+        merge(pending.data(), pending.size());
+        pending.clear();
+    }
+
+    /**
+     * @brief True if @p point lies strictly inside the hull, in O(log h).
+     *
+     * Candidates not yet merged are not considered.
+     */
+    bool strictlyInside(const PointType& point) const;
+
+    /**
+     * @brief The hull of every point merged so far, counter-clockwise from the leftmost point.
+     *
+     * Call flush() first to include points buffered by insert().
+     */
+    const vector<PointType>& hull() const { return currentHull; }
+
+    /**
+     * @brief Points held: hull vertices plus unmerged candidates.
+     */
+    size_t retained() const { return currentHull.size() + pending.size(); }
+
+    /**
+     * @brief Number of points added so far.
+     */
+    size_t pointCount() const { return pointsSeen; }
+
+    void clear() {
+        currentHull.clear();
+        pending.clear();
+        pointsSeen = 0;
+    }
+};
+
+/**
+ * @brief Out-of-core hull over a binary point file: consecutive (x, y) pairs of T in host byte order.
+ *
+ * The file is read sequentially in blocks of @p blockPoints. A reader thread fills one
+ * buffer while the previous block is merged, so at most two blocks are in memory.
+ */
+template <class T>
+class PointFileHull {
+public:
+    /**
+     * @brief Computes the hull of every point in the file at @p path.
+     *
+     * @param path The point file.
+     * @param hull Receives the hull vertices.
+     * @param pointCount Receives the number of points in the file.
+     * @param blockPoints Points per block.
+     * @return False with errno set if the file cannot be read, or with errno = EINVAL
+     *         if it is not a regular file or its size is not a whole number of points.
+     */
+    static bool compute(const char* path, vector<BasicPoint<T>>& hull, size_t& pointCount,
+                        size_t blockPoints = STREAM_BLOCK_POINTS);
+
+    /**
+     * @brief As above, for a file the caller has opened; @p fd is left open.
+     *
+     * No more than the size fstat reports is read.
+     */
+    static bool compute(int fd, vector<BasicPoint<T>>& hull, size_t& pointCount,
+                        size_t blockPoints = STREAM_BLOCK_POINTS);
+};
+
+extern template class IncrementalHull<int32_t>;
+extern template class IncrementalHull<float>;
+extern template class IncrementalHull<double>;
+extern template class PointFileHull<int32_t>;
+extern template class PointFileHull<float>;
+extern template class PointFileHull<double>;
+
+#endif // STREAMING_HULL_HPP
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include "WindowHull.hpp"
+
+template <class T>
+void WindowHull<T>::sealOpenBlock() {
+    Block& open = blocks.back();
+    openHull.flush();
+    open.hull = openHull.hull();
+    openHull.clear();
+
+    open.order.resize(open.points.size());
+    for (size_t i = 0; i < open.order.size(); ++i) open.order[i] = (uint16_t)i;
+    const vector<PointType>& points = open.points;
+    std::sort(open.order.begin(), open.order.end(),
+              [&points](uint16_t a, uint16_t b) { return points[a] < points[b]; });
+
+    // The sealed block joins the middle unless it is also the oldest
+    if (blocks.size() == 1) {
+        oldestValid = false;
+    } else if (middleValid) {
+        mergeBuffer.assign(middleHull.begin(), middleHull.end());
+        mergeBuffer.insert(mergeBuffer.end(), open.hull.begin(), open.hull.end());
+        middleHull = BasicConvexHull<T>::findConvexHull(mergeBuffer);
+    }
+}
+
+template <class T>
+void WindowHull<T>::dropOldest() {
+    Block& oldest = blocks.front();
+    oldest.expired++;
+    livePoints--;
+    oldestValid = false;
+
+    if (oldest.expired == oldest.points.size() && (blocks.size() > 1 || oldest.points.size() == WINDOW_BLOCK_POINTS)) {
+        blocks.pop_front();
+        middleValid = false; // The next block moved out of the middle
+        if (blocks.empty()) openHull.clear();
+    }
+}
+
+template <class T>
+void WindowHull<T>::expire(uint64_t now) {
+    if (maxAge == 0 || now < maxAge) return;
+    uint64_t oldestAllowed = now - maxAge;
+    while (livePoints > 0) {
+        const Block& oldest = blocks.front();
+        if (oldest.times[oldest.expired] >= oldestAllowed) break;
+        dropOldest();
+    }
+}
+
+template <class T>
+void WindowHull<T>::insert(const PointType& point, uint64_t now) {
+    if (blocks.empty() || blocks.back().points.size() == WINDOW_BLOCK_POINTS) {
+        if (!blocks.empty()) sealOpenBlock();
+        blocks.emplace_back();
+        blocks.back().points.reserve(WINDOW_BLOCK_POINTS);
+        blocks.back().times.reserve(WINDOW_BLOCK_POINTS);
+    }
+
+    Block& open = blocks.back();
+    open.points.push_back(point);
+    open.times.push_back(now);
+    openHull.insert(point);
+    livePoints++;
+
+    expire(now);
+    while (maxPoints > 0 && livePoints > maxPoints) dropOldest();
+}
+
+template <class T>
+const vector<typename WindowHull<T>::PointType>& WindowHull<T>::hull(uint64_t now) {
+    expire(now);
+    windowHull.clear();
+    if (livePoints == 0) return windowHull;
+
+    mergeBuffer.clear();
+    const Block& oldest = blocks.front();
+    if (blocks.size() == 1) {
+        // Only the open block is left; it may have lost points from its front
+        mergeBuffer.insert(mergeBuffer.end(), oldest.points.begin() + oldest.expired, oldest.points.end());
+    } else {
+        if (!oldestValid) {
+            if (oldest.expired == 0) {
+                oldestHull = oldest.hull;
+            } else {
+                sortedLive.clear();
+                for (uint16_t index : oldest.order)
+                    if (index >= oldest.expired) sortedLive.push_back(oldest.points[index]);
+                oldestHull = BasicConvexHull<T>::findConvexHullOfSorted(sortedLive.data(), sortedLive.size());
+            }
+            oldestValid = true;
+        }
+        if (!middleValid) {
+            PointVector<T> middle;
+            for (size_t b = 1; b + 1 < blocks.size(); ++b)
+                middle.insert(middle.end(), blocks[b].hull.begin(), blocks[b].hull.end());
+            middleHull = BasicConvexHull<T>::findConvexHull(middle);
+            middleValid = true;
+        }
+
+        openHull.flush();
+        mergeBuffer.insert(mergeBuffer.end(), oldestHull.begin(), oldestHull.end());
+        mergeBuffer.insert(mergeBuffer.end(), middleHull.begin(), middleHull.end());
+        mergeBuffer.insert(mergeBuffer.end(), openHull.hull().begin(), openHull.hull().end());
+    }
+
+    windowHull = BasicConvexHull<T>::findConvexHull(mergeBuffer);
+    return windowHull;
+}
+
+template class WindowHull<int32_t>;
+template class WindowHull<float>;
+template class WindowHull<double>;
@@ -0,0 +1,92 @@
+#ifndef WINDOW_HULL_HPP
+#define WINDOW_HULL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "StreamingHull.hpp"
+
+using std::vector;
+
+#define WINDOW_BLOCK_POINTS 1024 // Points per block; each sealed block keeps its own hull (at most 65536)
+
+/**
+ * @brief The hull of the most recent points: the last maxPoints, or those younger than maxAge.
+ *
+ * Points are kept in insertion order in fixed-size blocks. Expiry only ever removes
+ * points from the oldest block, so it is amortized O(1) per point. The window's hull
+ * is the hull of three parts:
+ *   - the live tail of the oldest block, recomputed in O(block) when points have expired
+ *     from it, walking the block's points in the sorted order saved when it was sealed;
+ *   - the sealed blocks in between, whose combined hull is cached, extended when a block
+ *     is sealed and rebuilt only when one of them becomes the oldest;
+ *   - the open block, whose hull is maintained incrementally as points arrive.
+ * Since convex hulls combine (the hull of a union is the hull of the parts' hulls),
+ * a query only touches a handful of small hulls rather than the whole window.
+ */
+template <class T>
+class WindowHull {
+private:
+    typedef BasicPoint<T> PointType;
+
+    struct Block {
+        vector<PointType> points;
+        vector<uint64_t> times;      // Insertion time of each point, in ns
+        vector<PointType> hull;      // Set when the block is sealed
+        vector<uint16_t> order;      // Indices of the points in lexicographic order, set when sealed
+        size_t expired = 0;          // Leading points that have left the window
+    };
+
+    size_t maxPoints;                // 0 for no count limit
+    uint64_t maxAge;                 // 0 for no age limit, in ns
+    size_t livePoints = 0;
+
+    std::deque<Block> blocks;        // Oldest first; the last one is open
+    IncrementalHull<T> openHull;     // Hull of the open block
+
+    vector<PointType> middleHull;    // Hull of blocks[1 .. size - 2]
+    bool middleValid = false;
+    vector<PointType> oldestHull;    // Hull of the live points of blocks[0], when it is sealed
+    bool oldestValid = false;
+
+    vector<PointType> sortedLive;    // Scratch for the oldest block's live points
+    vector<PointType> windowHull;
+    PointVector<T> mergeBuffer;
+
+    void sealOpenBlock();
+    void dropOldest();
+
+public:
+    /**
+     * @param maxPoints Keep at most this many points; 0 for no limit.
+     * @param maxAgeNs Drop points older than this; 0 for no limit.
+     */
+    WindowHull(size_t maxPoints, uint64_t maxAgeNs) : maxPoints(maxPoints), maxAge(maxAgeNs) {}
+
+    /**
+     * @brief Adds a point inserted at @p now and expires whatever it pushes out of the window.
+     */
+    void insert(const PointType& point, uint64_t now);
+
+    /**
+     * @brief Removes the points older than the age limit as of @p now.
+     */
+    void expire(uint64_t now);
+
+    /**
+     * @brief The hull of the points in the window as of @p now.
+     */
+    const vector<PointType>& hull(uint64_t now);
+
+    /**
+     * @brief Number of points in the window.
+     */
+    size_t size() const { return livePoints; }
+};
+
+extern template class WindowHull<int32_t>;
+extern template class WindowHull<float>;
+extern template class WindowHull<double>;
+
+#endif // WINDOW_HULL_HPP
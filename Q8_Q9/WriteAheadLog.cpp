@@ -0,0 +1,514 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "GraphRegistry.hpp"
+#include "Replication.hpp"
+#include "WriteAheadLog.hpp"
+
+#define SNAPSHOT_MAGIC "HULLSNAP"
+#define SNAPSHOT_END "SNAPEND"
+
+/**
+ * @brief Header of one graph in the snapshot, followed by its name padded to 8 bytes and its points.
+ */
+struct SnapshotGraph {
+    uint64_t lsn;        // The last record the points include
+    uint32_t nameLength;
+    uint32_t reserved;
+    uint64_t pointCount;
+};
+
+static size_t padded(size_t length) {
+    return (length + 7) & ~(size_t)7;
+}
+
+/**
+ * @brief 64-bit multiply-xorshift over the record's words, folded to 32 bits. The checksum
+ * field (the upper half of the header's third word) counts as zero.
+ */
+static uint32_t recordChecksum(const char* record, size_t length) {
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ length;
+    for (size_t offset = 0; offset < length; offset += 8) {
+        uint64_t word;
+        memcpy(&word, record + offset, sizeof word);
+        if (offset == 16) word &= 0xFFFFFFFFull;
+        hash = (hash ^ word) * 0xBF58476D1CE4E5B9ull;
+        hash ^= hash >> 31;
+    }
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+static bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        data += written;
+        length -= written;
+    }
+    return true;
+}
+
+// Makes a new or renamed entry of the directory durable
+static bool syncDirectory(const std::string& directory) {
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) return false;
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+}
+
+uint64_t WriteAheadLog::append(WalRecordType type, const std::string& name, uint32_t count, const void* data,
+                               size_t length) {
+    WalRecordHeader header;
+    memset(&header, 0, sizeof header);
+    header.nameLength = (uint8_t)std::min<size_t>(name.size(), 255);
+    header.length = (uint32_t)(padded(header.nameLength) + padded(length));
+    header.type = (uint8_t)type;
+    header.count = count;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    header.lsn = nextLsn++;
+    if (failed) return header.lsn; // Never written; its waitDurable() reports the failure
+    size_t offset = buffer.size();
+    buffer.resize(offset + sizeof header + header.length); // Zero filled, padding included
+    char* record = buffer.data() + offset;
+    memcpy(record, &header, sizeof header);
+    memcpy(record + sizeof header, name.data(), header.nameLength);
+    if (length > 0) memcpy(record + sizeof header + padded(header.nameLength), data, length);
+    header.checksum = recordChecksum(record, sizeof header + header.length);
+    memcpy(record + offsetof(WalRecordHeader, checksum), &header.checksum, sizeof header.checksum);
+
+    if (offset == 0 || buffer.size() >= WAL_GROUP_COMMIT_BYTES) appended.notify_one();
+    return header.lsn;
+}
+
+uint64_t WriteAheadLog::appendPoints(bool remove, const std::string& name, const double* coordinates, size_t count) {
+    return append(remove ? WAL_REMOVE : WAL_ADD, name, (uint32_t)count, coordinates, count * 2 * sizeof(double));
+}
+
+uint64_t WriteAheadLog::appendGenerate(const std::string& name, size_t count, PointDistribution distribution,
+                                       uint64_t seed) {
+    uint64_t data[2] = {count, seed};
+    return append(WAL_GENERATE, name, (uint32_t)distribution, data, sizeof data);
+}
+
+uint64_t WriteAheadLog::lastLsn() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return nextLsn - 1;
+}
+
+uint64_t WriteAheadLog::durableVersion() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return durableLsn;
+}
+
+bool WriteAheadLog::captureGraph(NamedGraph& graph, std::vector<double>& coordinates, uint64_t& lsn) {
+    std::lock_guard<std::mutex> lock(graph.mutex);
+    if (!graph.engine->storedCoordinates(coordinates)) return false;
+    lsn = lastLsn();
+    return true;
+}
+
+uint64_t WriteAheadLog::subscribe(const std::shared_ptr<ReplicationFeed>& feed) {
+    std::lock_guard<std::mutex> lock(mutex);
+    feeds.push_back(feed);
+    return durableLsn;
+}
+
+void WriteAheadLog::unsubscribe(const std::shared_ptr<ReplicationFeed>& feed) {
+    std::lock_guard<std::mutex> lock(mutex);
+    feeds.erase(std::remove(feeds.begin(), feeds.end(), feed), feeds.end());
+}
+
+std::vector<std::shared_ptr<ReplicationFeed>> WriteAheadLog::followers() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return feeds;
+}
+
+bool WriteAheadLog::waitDurable() {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = nextLsn - 1;
+    durable.wait(lock, [&] { return durableLsn >= target || failed; });
+    return durableLsn >= target;
+}
+
+bool WriteAheadLog::hasFailed() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return failed;
+}
+
+bool WriteAheadLog::openLogFile(uint64_t firstLsn) {
+    char name[32];
+    snprintf(name, sizeof name, "/wal.%016llx", (unsigned long long)firstLsn);
+    // A file with this name can only be one that never received a record
+    logFd = open((directory + name).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (logFd < 0 || !syncDirectory(directory)) {
+        perror((directory + name).c_str());
+        return false;
+    }
+    return true;
+}
+
+std::vector<std::pair<uint64_t, std::string>> WriteAheadLog::logFiles() {
+    std::vector<std::pair<uint64_t, std::string>> files;
+    DIR* listing = opendir(directory.c_str());
+    if (listing == nullptr) return files;
+    while (struct dirent* entry = readdir(listing)) {
+        char* end;
+        if (strncmp(entry->d_name, "wal.", 4) != 0) continue;
+        uint64_t firstLsn = strtoull(entry->d_name + 4, &end, 16);
+        if (*end == '\0' && end != entry->d_name + 4) files.emplace_back(firstLsn, directory + "/" + entry->d_name);
+    }
+    closedir(listing);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+/**
+ * @brief A group is what accumulated while the previous one was being written, plus
+ * what arrives within the budget after its first record; a full group goes at once.
+ * Rotation happens between two groups, so every file holds whole records.
+ */
+void WriteAheadLog::flushLoop() {
+    std::vector<char> writing;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        appended.wait(lock, [&] { return !buffer.empty() || rotateRequested; });
+        if (budgetMicros > 0 && buffer.size() < WAL_GROUP_COMMIT_BYTES)
+            appended.wait_for(lock, std::chrono::microseconds(budgetMicros),
+                              [&] { return buffer.size() >= WAL_GROUP_COMMIT_BYTES; });
+        writing.swap(buffer);
+        uint64_t upTo = nextLsn - 1;
+        bool rotate = rotateRequested;
+        rotateRequested = false;
+        lock.unlock();
+
+        // A mutation that cannot be made durable must not be acknowledged. After a failed
+        // fdatasync the kernel may have dropped the dirty pages, so a retry proves nothing.
+        bool written = writeAll(logFd, writing.data(), writing.size()) && fdatasync(logFd) == 0;
+        if (!written) perror("Write-ahead log");
+        if (written && rotate) {
+            close(logFd);
+            written = openLogFile(upTo + 1);
+        }
+
+        lock.lock();
+        if (!written) {
+            failed = true;
+            buffer.clear();
+            durable.notify_all();
+            return;
+        }
+        durableLsn = upTo;
+        durable.notify_all();
+        if (!feeds.empty() && !writing.empty()) {
+            // Copied out so followers are fed without holding up appenders; a feed
+            // subscribed from here on starts after this group
+            std::vector<std::shared_ptr<ReplicationFeed>> receivers = feeds;
+            lock.unlock();
+            for (const std::shared_ptr<ReplicationFeed>& feed : receivers) feed->deliver(writing.data(), writing.size(), upTo);
+            lock.lock();
+        }
+        bytesSinceCheckpoint += writing.size();
+        writing.clear();
+        if (rotate) {
+            rotatedAt = upTo;
+            rotations++;
+            rotated.notify_all();
+        } else if (checkpointBytes > 0 && bytesSinceCheckpoint >= checkpointBytes) {
+            rotated.notify_all();
+        }
+    }
+}
+
+/**
+ * @brief Each checkpoint starts a new log file first: every record in the older files
+ * is then at or below rotatedAt, so once the snapshot holds the graphs as of at least
+ * that point, those files are no longer needed.
+ */
+void WriteAheadLog::checkpointLoop(GraphRegistry* registry) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        rotated.wait(lock, [&] { return bytesSinceCheckpoint >= checkpointBytes; });
+        bytesSinceCheckpoint = 0;
+        uint64_t rotationsBefore = rotations;
+        rotateRequested = true;
+        appended.notify_one();
+        rotated.wait(lock, [&] { return rotations != rotationsBefore; });
+        uint64_t rotationLsn = rotatedAt;
+        lock.unlock();
+
+        if (writeSnapshot(*registry, rotationLsn)) {
+            for (const auto& file : logFiles())
+                if (file.first <= rotationLsn) unlink(file.second.c_str());
+        }
+        lock.lock();
+    }
+}
+
+/**
+ * @brief Copies one graph at a time under its mutex, noting the last record it includes,
+ * so writers are held up for a copy of their own graph only. The snapshot is only
+ * completed once those records are durable.
+ */
+bool WriteAheadLog::writeSnapshot(GraphRegistry& registry, uint64_t rotationLsn) {
+    std::string temporary = directory + "/snapshot.tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (file == nullptr) {
+        perror(temporary.c_str());
+        return false;
+    }
+
+    uint64_t graphCount = 0;
+    std::vector<double> coordinates;
+    bool written = fwrite(SNAPSHOT_MAGIC, 8, 1, file) == 1 && fwrite(&rotationLsn, 8, 1, file) == 1;
+    for (const std::shared_ptr<NamedGraph>& graph : registry.snapshot()) {
+        SnapshotGraph entry;
+        memset(&entry, 0, sizeof entry);
+        if (!captureGraph(*graph, coordinates, entry.lsn)) continue;
+        entry.nameLength = (uint32_t)graph->name.size();
+        entry.pointCount = coordinates.size() / 2;
+        char name[GRAPH_NAME_MAX + 8] = {};
+        memcpy(name, graph->name.data(), entry.nameLength);
+        written = written && fwrite(&entry, sizeof entry, 1, file) == 1 &&
+                  fwrite(name, padded(entry.nameLength), 1, file) == 1 &&
+                  fwrite(coordinates.data(), sizeof(double), coordinates.size(), file) == coordinates.size();
+        graphCount++;
+    }
+    // One wait covers every graph: the snapshot must not get ahead of the log
+    written = written && waitDurable();
+    written = written && fwrite(SNAPSHOT_END, 8, 1, file) == 1 && fwrite(&graphCount, 8, 1, file) == 1 &&
+              fflush(file) == 0 && fsync(fileno(file)) == 0;
+    written = fclose(file) == 0 && written;
+
+    if (!written || rename(temporary.c_str(), (directory + "/snapshot").c_str()) != 0 || !syncDirectory(directory)) {
+        perror("Checkpoint");
+        unlink(temporary.c_str());
+        return false;
+    }
+    printf("Checkpoint: %llu graphs as of lsn %llu\n", (unsigned long long)graphCount,
+           (unsigned long long)rotationLsn);
+    fflush(stdout);
+    return true;
+}
+
+bool WriteAheadLog::loadSnapshot(GraphRegistry& registry, uint64_t& snapshotLsn,
+                                 std::unordered_map<std::string, uint64_t>& capturedAt) {
+    std::string path = directory + "/snapshot";
+    snapshotLsn = 0;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return errno == ENOENT;
+
+    struct stat status;
+    void* mapped = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && status.st_size > 0)
+        mapped = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        perror(path.c_str());
+        return false;
+    }
+
+    const char* data = static_cast<const char*>(mapped);
+    size_t size = status.st_size, offset = 16;
+    bool valid = size >= 32 && memcmp(data, SNAPSHOT_MAGIC, 8) == 0;
+    if (valid) memcpy(&snapshotLsn, data + 8, 8);
+    while (valid && offset + 8 <= size && memcmp(data + offset, SNAPSHOT_END, 8) != 0) {
+        SnapshotGraph entry;
+        valid = offset + sizeof entry <= size;
+        if (!valid) break;
+        memcpy(&entry, data + offset, sizeof entry);
+        offset += sizeof entry;
+        size_t nameBytes = padded(entry.nameLength);
+        valid = entry.nameLength <= GRAPH_NAME_MAX && entry.pointCount <= (size - offset) / 16 &&
+                offset + nameBytes + entry.pointCount * 16 <= size;
+        if (!valid) break;
+        std::string name(data + offset, entry.nameLength);
+        offset += nameBytes;
+
+        CommandEngine& engine = *registry.open(name)->engine;
+        engine.resetPoints();
+        engine.applyPoints(false, reinterpret_cast<const double*>(data + offset), entry.pointCount);
+        offset += entry.pointCount * 16;
+        capturedAt[name] = entry.lsn;
+    }
+    uint64_t graphCount = 0;
+    if (valid && offset + 16 == size) memcpy(&graphCount, data + offset + 8, 8);
+    valid = valid && offset + 16 == size && graphCount == capturedAt.size();
+    munmap(mapped, size);
+
+    // The snapshot is renamed into place only once complete, so this is damage, not a crash
+    if (!valid) fprintf(stderr, "%s is damaged\n", path.c_str());
+    return valid;
+}
+
+/**
+ * @brief Records are checked one at a time and applied in place; points go to the engine
+ * without being copied or parsed as text.
+ */
+size_t WriteAheadLog::applyRecords(const char* data, size_t size, GraphRegistry& registry, uint64_t snapshotLsn,
+                                   const std::unordered_map<std::string, uint64_t>& capturedAt, uint64_t& lastLsn,
+                                   size_t& records, bool lockGraphs) {
+    std::shared_ptr<NamedGraph> graph; // The graph of the previous record, which is usually the next one's too
+    std::string name;
+    size_t offset = 0;
+    while (offset + sizeof(WalRecordHeader) <= size) {
+        WalRecordHeader header;
+        memcpy(&header, data + offset, sizeof header);
+        const char* record = data + offset;
+        size_t nameBytes = padded(header.nameLength);
+        if (header.length > size - offset - sizeof header || header.length % 8 != 0 || header.length < nameBytes ||
+            (lastLsn != 0 && header.lsn != lastLsn + 1) ||
+            recordChecksum(record, sizeof header + header.length) != header.checksum)
+            break;
+        offset += sizeof header + header.length;
+        lastLsn = header.lsn;
+        records++;
+
+        name.assign(record + sizeof header, header.nameLength);
+        const char* payload = record + sizeof header + nameBytes;
+        size_t payloadBytes = header.length - nameBytes;
+        if (header.lsn <= snapshotLsn) continue;
+        if (!capturedAt.empty()) {
+            auto captured = capturedAt.find(name);
+            if (captured != capturedAt.end() && header.lsn <= captured->second) continue;
+        }
+
+        if (header.type == WAL_DROP) {
+            registry.drop(name);
+            graph.reset();
+            continue;
+        }
+        if (!graph || graph->name != name) graph = registry.open(name);
+        CommandEngine& engine = *graph->engine;
+        if (header.type == WAL_GENERATE && payloadBytes >= 16) {
+            uint64_t arguments[2];
+            memcpy(arguments, payload, sizeof arguments);
+            const char* failure;
+            engine.loadRandomPoints(arguments[0], (PointDistribution)header.count, arguments[1], graph->mutex, failure);
+            continue;
+        }
+        if (lockGraphs) graph->mutex.lock();
+        if (header.type == WAL_CLEAR)
+            engine.resetPoints();
+        else if ((header.type == WAL_ADD || header.type == WAL_REMOVE) && payloadBytes >= (size_t)header.count * 16)
+            engine.applyPoints(header.type == WAL_REMOVE, reinterpret_cast<const double*>(payload), header.count);
+        if (lockGraphs) graph->mutex.unlock();
+    }
+    return offset;
+}
+
+/**
+ * @brief The file is mapped and its records applied straight from the mapping.
+ */
+bool WriteAheadLog::replayFile(const std::string& path, bool last, GraphRegistry& registry, uint64_t snapshotLsn,
+                               const std::unordered_map<std::string, uint64_t>& capturedAt, uint64_t& lastLsn,
+                               size_t& records) {
+    int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+    struct stat status;
+    if (fd < 0 || fstat(fd, &status) != 0) {
+        perror(path.c_str());
+        if (fd >= 0) close(fd);
+        return false;
+    }
+    size_t size = status.st_size, offset;
+    if (size == 0) {
+        close(fd);
+        return true;
+    }
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        perror(path.c_str());
+        close(fd);
+        return false;
+    }
+    const char* data = static_cast<const char*>(mapped);
+
+    // Graphs would otherwise grow by doubling, copying their points each time
+    std::unordered_map<std::string, size_t> added;
+    std::string name;
+    size_t* addedToName = nullptr;
+    for (size_t scan = 0; scan + sizeof(WalRecordHeader) <= size;) {
+        WalRecordHeader header;
+        memcpy(&header, data + scan, sizeof header);
+        if (header.length > size - scan - sizeof header) break;
+        if (header.type == WAL_ADD && header.lsn > snapshotLsn) {
+            if (addedToName == nullptr || name.compare(0, name.size(), data + scan + sizeof header, header.nameLength) != 0) {
+                name.assign(data + scan + sizeof header, header.nameLength);
+                addedToName = &added[name];
+            }
+            *addedToName += header.count;
+        }
+        scan += sizeof header + header.length;
+    }
+    for (const auto& entry : added) registry.open(entry.first)->engine->reservePoints(entry.second);
+
+    offset = applyRecords(data, size, registry, snapshotLsn, capturedAt, lastLsn, records, false);
+    munmap(mapped, size);
+
+    if (offset != size) {
+        if (!last) {
+            fprintf(stderr, "%s: damaged record at byte %zu\n", path.c_str(), offset);
+            close(fd);
+            return false;
+        }
+        // Only the group being written when the server stopped can be torn, and none of it was acknowledged
+        fprintf(stderr, "%s: cutting off %zu bytes of torn records\n", path.c_str(), size - offset);
+        if (ftruncate(fd, offset) != 0 || fsync(fd) != 0) {
+            perror(path.c_str());
+            close(fd);
+            return false;
+        }
+    }
+    close(fd);
+    return true;
+}
+
+bool WriteAheadLog::recover(GraphRegistry& registry) {
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        perror(directory.c_str());
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t snapshotLsn;
+    std::unordered_map<std::string, uint64_t> capturedAt;
+    if (!loadSnapshot(registry, snapshotLsn, capturedAt)) return false;
+
+    std::vector<std::pair<uint64_t, std::string>> files = logFiles();
+    uint64_t replayedLsn = 0, bytes = 0;
+    size_t records = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        struct stat status;
+        if (stat(files[i].second.c_str(), &status) == 0) bytes += status.st_size;
+        if (!replayFile(files[i].second, i + 1 == files.size(), registry, snapshotLsn, capturedAt, replayedLsn,
+                        records))
+            return false;
+    }
+
+    nextLsn = std::max(snapshotLsn, replayedLsn) + 1;
+    durableLsn = nextLsn - 1;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("Recovered %zu graphs from the snapshot and %zu log records (%.1f MB) in %.3f s\n", capturedAt.size(),
+           records, bytes / 1e6, seconds);
+    fflush(stdout);
+    return openLogFile(nextLsn);
+}
+
+void WriteAheadLog::start(GraphRegistry& registry) {
+    flusher = std::thread(&WriteAheadLog::flushLoop, this);
+    flusher.detach();
+    if (checkpointBytes > 0) {
+        checkpointer = std::thread(&WriteAheadLog::checkpointLoop, this, &registry);
+        checkpointer.detach();
+    }
+}
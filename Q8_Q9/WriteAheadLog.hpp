@@ -0,0 +1,187 @@
+#ifndef WRITE_AHEAD_LOG_HPP
+#define WRITE_AHEAD_LOG_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "RandomPoints.hpp"
+
+class GraphRegistry;
+struct NamedGraph;
+class ReplicationFeed;
+
+#define WAL_GROUP_COMMIT_BYTES (1 << 20)  // A group is written early once it holds this much
+#define WAL_DEFAULT_BUDGET_US 0           // Groups form on their own while the previous one syncs
+#define WAL_DEFAULT_CHECKPOINT_MB 64      // Log written between checkpoints
+
+/**
+ * @brief Kinds of log records. Points are stored as (x, y) doubles, exact for every coordinate type.
+ */
+enum WalRecordType {
+    WAL_CLEAR = 1, // The graph was emptied (CreateGraph, GenerateRandom, or it left the stored mode)
+    WAL_ADD,       // count points were added
+    WAL_REMOVE,    // count points were removed, one match each
+    WAL_GENERATE,  // GenerateRandom: count is the distribution, followed by the point count and the seed
+    WAL_DROP       // DropGraph
+};
+
+/**
+ * @brief Header of a log record, followed by the graph name padded to 8 bytes and the record's data.
+ *
+ * Records are a multiple of 8 bytes long. The checksum covers the whole record,
+ * computed with this field set to zero; recovery stops at the first record that
+ * does not match, which is where a crash tore the log.
+ */
+struct WalRecordHeader {
+    uint64_t lsn;        // Log sequence number, increasing by one per record
+    uint32_t length;     // Bytes after the header
+    uint8_t type;
+    uint8_t nameLength;
+    uint16_t reserved;
+    uint32_t count;
+    uint32_t checksum;
+};
+static_assert(sizeof(WalRecordHeader) == 24, "WalRecordHeader must not be padded");
+
+/**
+ * @brief Append-only binary log of the mutations of stored graphs, with group commit and checkpoints.
+ *
+ * Engines append records while holding their graph's mutex, which only copies them
+ * into a buffer. A flusher thread writes the buffer with one write() and one
+ * fdatasync() per group; a group waits at most the latency budget for more records
+ * to arrive. A command's reply is sent once waitDurable() returns. If a write or
+ * fdatasync fails, the log stops: waiting commands are told their change is not
+ * durable, and the server refuses changes from then on.
+ *
+ * Once enough log has been written, a checkpoint starts a new log file, writes the
+ * points of every stored graph to a snapshot, and deletes the older log files.
+ * Streaming, windowed and sharded graphs are not logged and come back empty.
+ *
+ * The directory holds "snapshot" and log files named "wal.<first lsn in hex>".
+ */
+class WriteAheadLog {
+private:
+    std::string directory;
+    uint64_t budgetMicros;
+    uint64_t checkpointBytes;            // 0 disables checkpoints
+
+    std::mutex mutex;
+    std::condition_variable appended;    // Wakes the flusher
+    std::condition_variable durable;     // Wakes threads in waitDurable()
+    std::condition_variable rotated;     // Wakes the checkpoint thread
+    std::vector<char> buffer;            // Records not yet handed to the flusher
+    uint64_t nextLsn = 1;
+    uint64_t durableLsn = 0;
+    uint64_t bytesSinceCheckpoint = 0;
+    bool rotateRequested = false;
+    uint64_t rotations = 0;
+    uint64_t rotatedAt = 0;              // Last lsn of the file closed by the latest rotation
+    bool failed = false;                 // A write or sync failed; nothing is made durable after it
+    int logFd = -1;                      // Used by the flusher only, once started
+    std::vector<std::shared_ptr<ReplicationFeed>> feeds; // Followers, each handed every group once durable
+
+    std::thread flusher;
+    std::thread checkpointer;
+
+    uint64_t append(WalRecordType type, const std::string& name, uint32_t count, const void* data, size_t length);
+    bool openLogFile(uint64_t firstLsn);
+    void flushLoop();
+    void checkpointLoop(GraphRegistry* registry);
+    bool writeSnapshot(GraphRegistry& registry, uint64_t rotationLsn);
+    bool loadSnapshot(GraphRegistry& registry, uint64_t& snapshotLsn, std::unordered_map<std::string, uint64_t>& capturedAt);
+    bool replayFile(const std::string& path, bool last, GraphRegistry& registry, uint64_t snapshotLsn,
+                    const std::unordered_map<std::string, uint64_t>& capturedAt, uint64_t& lastLsn, size_t& records);
+    std::vector<std::pair<uint64_t, std::string>> logFiles();
+
+public:
+    /**
+     * @param directory Where the snapshot and log files live; created if missing.
+     * @param budgetMicros Longest a record waits for others to join its group commit.
+     * @param checkpointBytes Log written between checkpoints; 0 for none.
+     */
+    WriteAheadLog(const char* directory, uint64_t budgetMicros, uint64_t checkpointBytes)
+        : directory(directory), budgetMicros(budgetMicros), checkpointBytes(checkpointBytes) {}
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    /**
+     * @brief Loads the snapshot, replays the log into @p registry, and opens a fresh log file.
+     *
+     * Call before anything is logged, with the registry's log still detached. A torn
+     * record at the end of the last file is cut off.
+     *
+     * @return False, after printing why, if the directory or a file cannot be used.
+     */
+    bool recover(GraphRegistry& registry);
+
+    /**
+     * @brief Starts the flusher and checkpoint threads.
+     */
+    void start(GraphRegistry& registry);
+
+    uint64_t appendClear(const std::string& name) { return append(WAL_CLEAR, name, 0, nullptr, 0); }
+    uint64_t appendDrop(const std::string& name) { return append(WAL_DROP, name, 0, nullptr, 0); }
+    uint64_t appendPoints(bool remove, const std::string& name, const double* coordinates, size_t count);
+    uint64_t appendGenerate(const std::string& name, size_t count, PointDistribution distribution, uint64_t seed);
+
+    /**
+     * @brief The lsn of the latest record appended.
+     */
+    uint64_t lastLsn();
+
+    /**
+     * @brief The lsn of the latest record on disk: the version a client's acknowledged writes are in.
+     */
+    uint64_t durableVersion();
+
+    /**
+     * @brief Blocks until every record appended so far is on disk.
+     * @return False if the log failed first, so some of them never will be.
+     */
+    bool waitDurable();
+
+    /**
+     * @brief Whether a write or sync of the log has failed; changes must then be refused.
+     */
+    bool hasFailed();
+
+    /**
+     * @brief Copies a logged, stored graph's points and the lsn of the last record they include.
+     *
+     * That record may not be on disk yet: call waitDurable() before the copy is passed on,
+     * so that it never holds a change the log could still lose.
+     * @return False for other graphs.
+     */
+    bool captureGraph(NamedGraph& graph, std::vector<double>& coordinates, uint64_t& lsn);
+
+    /**
+     * @brief Hands every group that becomes durable from now on to @p feed.
+     * @return The lsn the groups follow on from.
+     */
+    uint64_t subscribe(const std::shared_ptr<ReplicationFeed>& feed);
+    void unsubscribe(const std::shared_ptr<ReplicationFeed>& feed);
+    std::vector<std::shared_ptr<ReplicationFeed>> followers();
+
+    /**
+     * @brief Applies records to @p registry, in order, from the start of @p data.
+     *
+     * Records at or below @p snapshotLsn, or below a graph's lsn in @p capturedAt, are
+     * skipped; they are already in the graphs. With @p lockGraphs each record is applied
+     * under its graph's mutex, for graphs that are serving clients meanwhile.
+     *
+     * @param lastLsn The lsn of the record before @p data, or 0 if unknown; advanced past each record.
+     * @return The bytes of intact records applied; a torn or damaged record stops the replay.
+     */
+    static size_t applyRecords(const char* data, size_t size, GraphRegistry& registry, uint64_t snapshotLsn,
+                               const std::unordered_map<std::string, uint64_t>& capturedAt, uint64_t& lastLsn,
+                               size_t& records, bool lockGraphs);
+};
+
+#endif // WRITE_AHEAD_LOG_HPP